@@ -456,6 +456,11 @@
  void DelayMicros(uint32_t microsec)
  {
      uint32_t curr_us = TIMERS_GetMicroSeconds();
+     // Sleep until the 1 ms timer tick while more than a tick is left, spin the rest.
+     while (((TIMERS_GetMicroSeconds() - curr_us) + 1000) < microsec)
+     {
+         __WFI();
+     }
      while ((TIMERS_GetMicroSeconds() - curr_us) < microsec);
  }
  
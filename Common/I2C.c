@@ -139,6 +139,47 @@ unsigned char I2C_WriteReg(
     return SUCCESS;   
 }
 
+/** I2C_WriteBlock(I2CAddress, deviceRegisterAddress, data, length)
+ *
+ * Writes a run of bytes after one register address in a single transaction,
+ * for devices that auto-increment or stream (SSD1306 display data).
+ *
+ * @param   I2CAddress              (unsigned char) 7-bit address of I2C device
+ *                                                  wished to interact with.
+ * @param   deviceRegisterAddress   (unsigned char) 8-bit address of register on
+ *                                                  device.
+ * @param   data                    (const uint8_t *) Bytes to write.
+ * @param   length                  (uint16_t)      Number of bytes.
+ * @return                          (unsigned char) [SUCCESS, ERROR]
+ */
+unsigned char I2C_WriteBlock(
+    unsigned char I2CAddress,
+    unsigned char deviceRegisterAddress,
+    const uint8_t *data,
+    uint16_t length
+)
+{
+    HAL_StatusTypeDef ret;
+    I2CAddress = I2CAddress << 1; // Use 8-bit address.
+
+    ret = HAL_I2C_Mem_Write(
+        &hi2c2,
+        I2CAddress,
+        deviceRegisterAddress,
+        I2C_MEMADD_SIZE_8BIT,
+        (uint8_t *)data,
+        length,
+        HAL_MAX_DELAY
+    );
+    if (ret != HAL_OK)
+    {
+        printf("I2C Tx Error on write block\r\n");
+        return ERROR;
+    }
+
+    return SUCCESS;
+}
+
 /** I2C_ReadInt(I2CAddress, deviceRegisterAddress, isBigEndian)
  *
  * Reads two sequential registers to build a 16-bit value. isBigEndian dictates
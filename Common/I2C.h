@@ -43,6 +43,21 @@ unsigned char I2C_ReadRegister(unsigned char I2CAddress,unsigned char deviceRegi
  */
 unsigned char I2C_WriteReg(unsigned char I2CAddress, unsigned char deviceRegisterAddress, uint8_t data);
 
+/** I2C_WriteBlock(I2CAddress, deviceRegisterAddress, data, length)
+ *
+ * Writes a run of bytes after one register address in a single transaction,
+ * for devices that auto-increment or stream (SSD1306 display data).
+ *
+ * @param   I2CAddress              (unsigned char) 7-bit address of I2C device
+ *                                                  wished to interact with.
+ * @param   deviceRegisterAddress   (unsigned char) 8-bit address of register on
+ *                                                  device.
+ * @param   data                    (const uint8_t *) Bytes to write.
+ * @param   length                  (uint16_t)      Number of bytes.
+ * @return                          (unsigned char) [SUCCESS, ERROR]
+ */
+unsigned char I2C_WriteBlock(unsigned char I2CAddress, unsigned char deviceRegisterAddress, const uint8_t *data, uint16_t length);
+
 /** I2C_ReadInt(I2CAddress, deviceRegisterAddress, isBigEndian)
  *
  * Reads two sequential registers to build a 16-bit value. isBigEndian dictates
@@ -11,6 +11,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 #include <Board.h>
 #include <I2C.h>
 #include <OledDriver.h>
@@ -33,6 +34,7 @@ typedef enum {
     OLED_COMMAND_SET_DISPLAY_LOWER_COLUMN_0 = 0x00,
     OLED_COMMAND_SET_DISPLAY_UPPER_COLUMN_0 = 0x10,
     OLED_COMMAND_SET_PAGE = 0x22,
+    OLED_COMMAND_SET_PAGE_START = 0xB0, // Page addressing mode, OR in the page
     OLED_COMMAND_SET_CHARGE_PUMP = 0x8D,
     OLED_COMMAND_SET_SEGMENT_REMAP = 0xA1,
     OLED_COMMAND_DISPLAY_NORMAL = 0xA6,
@@ -64,6 +66,13 @@ typedef enum {
  */
 uint8_t rgbOledBmp[OLED_DRIVER_BUFFER_SIZE];
 
+/**
+ * What the display was last sent, so an update only resends the pages (and
+ * within them the columns) that differ from it.
+ */
+static uint8_t shownOledBmp[OLED_DRIVER_BUFFER_SIZE];
+static uint8_t shownValid = 0;  // Pages whose shownOledBmp matches the glass, bit per page
+
 // Function prototypes for private functions.
 void DelayMs(uint32_t ms);
 
@@ -102,6 +111,17 @@ void OledDriverInitDisplay(void)
 
     // And turn on the display.
     I2C_WriteReg(OLED_ADDRESS, COMMAND, OLED_COMMAND_DISPLAY_ON);
+
+    // Whatever is in display RAM now, the next update sends everything.
+    OledDriverInvalidate();
+}
+
+/**
+ * Forget what is on the display, so the next update resends every page.
+ */
+void OledDriverInvalidate(void)
+{
+    shownValid = 0;
 }
 
 /**
@@ -133,35 +153,62 @@ void OledDriverDisableDisplay(void)
 }
 
 /**
- * Update the display with the contents of rgb0ledBmp.
+ * Update the display with the contents of rgb0ledBmp. Pages that match what
+ * was last sent are skipped; a changed page costs one command transaction
+ * (page and start column) and one data transaction covering the columns from
+ * the first to the last changed one, instead of a transaction per byte.
  */
 void OledDriverUpdateDisplay(void)
 {
-    uint8_t *pb = rgbOledBmp;
     int page;
     for (page = 0; page < OLED_DRIVER_PAGES; page++) {
+        const uint8_t *pb = &rgbOledBmp[page * OLED_DRIVER_PIXEL_COLUMNS];
+        uint8_t *shown = &shownOledBmp[page * OLED_DRIVER_PIXEL_COLUMNS];
+
+        // Find the changed columns of this page.
+        int first = 0;
+        int last = OLED_DRIVER_PIXEL_COLUMNS - 1;
+        if (shownValid & (1 << page)) {
+            while ((first <= last) && (pb[first] == shown[first])) {
+                first++;
+            }
+            if (first > last) {
+                continue;
+            }
+            while (pb[last] == shown[last]) {
+                last--;
+            }
+        }
 
-        // Set the desired page.
-        I2C_WriteReg(OLED_ADDRESS, COMMAND, OLED_COMMAND_SET_PAGE);
-        I2C_WriteReg(OLED_ADDRESS, COMMAND, page);
-
-        // Set the starting column back to the origin.
-        I2C_WriteReg(OLED_ADDRESS, COMMAND, OLED_COMMAND_SET_DISPLAY_LOWER_COLUMN_0);
-        I2C_WriteReg(OLED_ADDRESS, COMMAND, OLED_COMMAND_SET_DISPLAY_UPPER_COLUMN_0);
+        // Set the page and the starting column.
+        uint8_t commands[3] = {
+            OLED_COMMAND_SET_PAGE_START | page,
+            OLED_COMMAND_SET_DISPLAY_LOWER_COLUMN_0 | (first & 0x0F),
+            OLED_COMMAND_SET_DISPLAY_UPPER_COLUMN_0 | (first >> 4)
+        };
+        if (I2C_WriteBlock(OLED_ADDRESS, COMMAND_STREAM, commands, sizeof(commands)) != SUCCESS) {
+            shownValid &= ~(1 << page);
+            continue;
+        }
 
-        // Write this entire column to the OLED.
-        for (int i = 0; i < OLED_DRIVER_PIXEL_COLUMNS; i++) {
-            I2C_WriteReg(OLED_ADDRESS, DATA, *pb);
-            pb++;
+        // Write the changed columns as one data stream.
+        if (I2C_WriteBlock(OLED_ADDRESS, DATA_STREAM, &pb[first], last - first + 1) != SUCCESS) {
+            shownValid &= ~(1 << page);
+            continue;
         }
+        memcpy(&shown[first], &pb[first], last - first + 1);
+        shownValid |= (1 << page);
     }
 }
 
 /**
- * Block the processor for the desired number of milliseconds.
+ * Block the caller for the desired number of milliseconds, sleeping between
+ * timer interrupts.
  * @param ms The number of milliseconds to block for.
  */
 void DelayMs(uint32_t ms) {
     uint32_t curr_ms = TIMERS_GetMilliSeconds();
-    while ((TIMERS_GetMilliSeconds() - curr_ms) < ms);
+    while ((TIMERS_GetMilliSeconds() - curr_ms) < ms) {
+        __WFI();
+    }
 }
\ No newline at end of file
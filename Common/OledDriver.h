@@ -51,10 +51,17 @@ void OledDriverInitDisplay(void);
 void OledDriverDisableDisplay(void);
 
 /**
- * Update the display with the contents of rgb0ledBmp.
+ * Update the display with the contents of rgb0ledBmp. Only pages that changed since the last
+ * update are sent, each as a single I2C data transaction.
  */
 void OledDriverUpdateDisplay(void);
 
+/**
+ * Forget what is on the display, so the next `OledDriverUpdateDisplay()` resends every page. Called
+ * by `OledDriverInitDisplay()`; call it after anything else that may have changed display RAM.
+ */
+void OledDriverInvalidate(void);
+
 /**
  * Set the LCD to display pixel values as the opposite of how they are actually stored in NVRAM. So
  * pixels set to black (0) will display as white, and pixels set to white (1) will display as black.
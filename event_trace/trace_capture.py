@@ -0,0 +1,34 @@
+import sys
+import time
+import serial  # pip install pyserial
+
+# Records the console of a TRACE_ENABLED build (see professorpiano/include/Trace.h),
+# log lines and trace record lines interleaved, into a file for trace_decode.
+# The console is plain text, so a log saved from pio device monitor decodes
+# just as well; this only saves the typing.
+#
+#   python trace_capture.py COM5 console.txt 30     (port, output, seconds)
+
+CONSOLE_BAUDRATE = 115200          # SERIAL_BAUDRATE in Board_2.c
+RECORD_PREFIX = b"~T"              # TRACE_LINE_PREFIX
+RECORD_HEX = 32                    # 2 * sizeof(TraceRecord_t)
+
+port = sys.argv[1]
+out_name = sys.argv[2] if len(sys.argv) > 2 else "console.txt"
+seconds = float(sys.argv[3]) if len(sys.argv) > 3 else 10.0
+
+with serial.Serial(port, CONSOLE_BAUDRATE, timeout=0.1) as ser, open(out_name, "wb") as out:
+    ser.reset_input_buffer()
+    total = 0
+    end = time.time() + seconds
+    while time.time() < end:
+        chunk = ser.read(4096)
+        if chunk:
+            out.write(chunk)
+            total += len(chunk)
+
+# Rough count only, trace_decode checks every record
+with open(out_name, "rb") as f:
+    lines = f.read().split(b"\n")
+records = sum(1 for line in lines if line.startswith(RECORD_PREFIX) and len(line.rstrip(b"\r")) == len(RECORD_PREFIX) + RECORD_HEX)
+print(f"Captured {total} bytes ({records} record lines) to {out_name}")
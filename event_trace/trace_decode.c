@@ -0,0 +1,269 @@
+/**
+ * @file    trace_decode.c
+ *
+ * Decoder for captured console streams of firmware with the event trace
+ * (Trace.h). Text lines pass through; the TRACE_LINE_PREFIX hex lines
+ * between them are decoded:
+ *
+ *   gcc -O2 -I../professorpiano/include -o trace_decode trace_decode.c
+ *
+ * Record the console with trace_capture.py, or save what pio device monitor
+ * shows, then:
+ *
+ *   ./trace_decode console.txt [--csv] [--events-only]
+ *
+ *   --csv          records only, as t_us,seq,event,arg0,arg1,text
+ *   --events-only  readable log of the records without the console text
+ *
+ * Records are accepted when the hex is complete and the sync byte, a known
+ * event id and the check byte agree; anything else is taken as text, and a
+ * prefixed line that fails counts as a bad record. Sequence gaps are
+ * reported as dropped records. A summary with per-event counts goes to
+ * stderr, and the exit status is 2 if any record failed its check.
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    11 Mar 2025
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <Trace.h>
+
+typedef struct
+{
+    const char *name;
+    const char *arg0;
+    const char *arg1;
+} EventInfo_t;
+
+// Same order as TraceEvent_t
+static const EventInfo_t EVENTS[] = {
+    {"boot", "ring_records", "record_bytes"},
+    {"key_press", "key", "peak"},
+    {"voice_start", "voice", "note_octave"},
+    {"voice_stop", "voice", "played_ms"},
+    {"octave", "hand", "octave"},
+    {"gesture", "hand", "gesture"},
+    {"i2c_failure", "address", "failures"},
+    {"deadline_miss", "task", "latency_us"},
+    {"mark", "arg0", "arg1"},
+    {"lesson_step", "step", "reaction_ms"},
+};
+_Static_assert(sizeof(EVENTS) / sizeof(EVENTS[0]) == TRACE_NUM_EVENTS, "EVENTS out of step with TraceEvent_t");
+_Static_assert(sizeof(TraceRecord_t) == 16, "TraceRecord_t layout changed");
+
+// Note_t and Gesture_t names, for the events that carry them
+static const char *NOTE_NAMES[] = {"B", "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#"};
+static const char *GESTURE_NAMES[] = {"none", "octave_up", "octave_down", "sustain", "mode_toggle"};
+
+static int csv = 0;
+static int eventsOnly = 0;
+
+// Readable form of a record's arguments
+static void Describe(const TraceRecord_t *r, char *out, size_t size)
+{
+    int32_t a0 = r->arg[0], a1 = r->arg[1];
+    switch (r->event)
+    {
+    case TRACE_KEY_PRESS:
+    {
+        int note = (a0 >> 16) & 0xFF;
+        snprintf(out, size, "finger %d %s key, note %s, peak %d", a0 & 0xFF, ((a0 >> 8) & 0xFF) ? "black" : "white",
+                 (note < 12) ? NOTE_NAMES[note] : "?", a1);
+        break;
+    }
+    case TRACE_VOICE_START:
+    {
+        int note = a1 & 0xFF;
+        snprintf(out, size, "voice %d note %s octave %d", a0, (note < 12) ? NOTE_NAMES[note] : "?", (a1 >> 8) & 0xFF);
+        break;
+    }
+    case TRACE_OCTAVE:
+        snprintf(out, size, "hand %c octave %d", 'A' + a0, a1);
+        break;
+    case TRACE_GESTURE:
+        snprintf(out, size, "hand %c %s", 'A' + a0, (a1 >= 0 && a1 < 5) ? GESTURE_NAMES[a1] : "?");
+        break;
+    case TRACE_I2C_FAILURE:
+        snprintf(out, size, "device 0x%02X, %d in a row", a0, a1);
+        break;
+    default:
+        snprintf(out, size, "%s %d, %s %d", EVENTS[r->event].arg0, a0, EVENTS[r->event].arg1, a1);
+        break;
+    }
+}
+
+static int HexDigit(uint8_t c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    if (c >= 'A' && c <= 'F')
+    {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+// A record line at p: the prefix, the record as hex and a line end. Returns
+// the bytes it spans (the newline included), 0 if p does not start one.
+static size_t RecordLine(const uint8_t *p, size_t left, TraceRecord_t *r)
+{
+    const size_t prefix = sizeof(TRACE_LINE_PREFIX) - 1;
+    const size_t hex = 2 * sizeof(TraceRecord_t);
+    if (left < prefix + hex + 1 || memcmp(p, TRACE_LINE_PREFIX, prefix) != 0)
+    {
+        return 0;
+    }
+    uint8_t bytes[sizeof(TraceRecord_t)];
+    for (size_t i = 0; i < sizeof(bytes); i++)
+    {
+        int high = HexDigit(p[prefix + 2 * i]);
+        int low = HexDigit(p[prefix + 2 * i + 1]);
+        if (high < 0 || low < 0)
+        {
+            return 0;
+        }
+        bytes[i] = (uint8_t)((high << 4) | low);
+    }
+    size_t end = prefix + hex;
+    if (p[end] == '\r' && end + 1 < left)
+    {
+        end++; // Saved from a terminal with CRLF line ends
+    }
+    if (p[end] != '\n')
+    {
+        return 0;
+    }
+    memcpy(r, bytes, sizeof(*r));
+    return end + 1;
+}
+
+static int ValidRecord(const TraceRecord_t *r)
+{
+    return (r->sync == TRACE_SYNC) && (r->event < TRACE_NUM_EVENTS) &&
+           (r->check == TraceRecord_Check(r->event, r->sequence, r->timestamp_us, r->arg[0], r->arg[1]));
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = NULL;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--csv") == 0)
+        {
+            csv = 1;
+        }
+        else if (strcmp(argv[i], "--events-only") == 0)
+        {
+            eventsOnly = 1;
+        }
+        else
+        {
+            path = argv[i];
+        }
+    }
+    if (path == NULL)
+    {
+        fprintf(stderr, "usage: %s console.txt [--csv] [--events-only]\n", argv[0]);
+        return 1;
+    }
+
+    FILE *f = fopen(path, "rb");
+    if (f == NULL)
+    {
+        perror(path);
+        return 1;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *data = malloc(size > 0 ? size : 1);
+    size_t length = fread(data, 1, size, f);
+    fclose(f);
+
+    if (csv)
+    {
+        printf("t_us,seq,event,arg0,arg1,text\n");
+    }
+
+    uint32_t counts[TRACE_NUM_EVENTS] = {0};
+    uint32_t records = 0, bad = 0, lost = 0, textBytes = 0;
+    int lastSequence = -1;
+    int atLineStart = 1;
+    char text[160];
+
+    for (size_t i = 0; i < length;)
+    {
+        TraceRecord_t r;
+        size_t span = RecordLine(&data[i], length - i, &r);
+        if (span != 0 && !ValidRecord(&r))
+        {
+            // Well formed but damaged
+            bad++;
+            i += span;
+            continue;
+        }
+        if (span != 0)
+        {
+            if (lastSequence >= 0)
+            {
+                uint8_t gap = (uint8_t)(r.sequence - lastSequence - 1);
+                if (gap != 0)
+                {
+                    lost += gap;
+                    if (!csv)
+                    {
+                        printf("%s[trace] %u records dropped\n", atLineStart ? "" : "\n", gap);
+                        atLineStart = 1;
+                    }
+                }
+            }
+            lastSequence = r.sequence;
+            records++;
+            counts[r.event]++;
+
+            Describe(&r, text, sizeof(text));
+            if (csv)
+            {
+                printf("%lu,%u,%s,%ld,%ld,\"%s\"\n", (unsigned long)r.timestamp_us, r.sequence, EVENTS[r.event].name,
+                       (long)r.arg[0], (long)r.arg[1], text);
+            }
+            else
+            {
+                // A record can land in the middle of a text line that was
+                // still being printed in pieces
+                printf("%s[%10.6f] %-13s %s\n", atLineStart ? "" : "\n", r.timestamp_us * 1e-6, EVENTS[r.event].name,
+                       text);
+                atLineStart = 1;
+            }
+            i += span;
+            continue;
+        }
+
+        textBytes++;
+        // Control characters are not worth printing
+        if (!csv && !eventsOnly && ((data[i] >= ' ' && data[i] < 0x7F) || data[i] == '\n' || data[i] == '\t'))
+        {
+            putchar(data[i]);
+            atLineStart = (data[i] == '\n');
+        }
+        i++;
+    }
+
+    fprintf(stderr, "%u records, %u dropped on the board, %u failed the check, %u text bytes\n", records, lost, bad,
+            textBytes);
+    for (int e = 0; e < TRACE_NUM_EVENTS; e++)
+    {
+        if (counts[e] != 0)
+        {
+            fprintf(stderr, "  %-13s %u\n", EVENTS[e].name, counts[e]);
+        }
+    }
+    free(data);
+    return (bad == 0) ? 0 : 2;
+}
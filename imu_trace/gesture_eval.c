@@ -0,0 +1,254 @@
+/**
+ * @file    gesture_eval.c
+ *
+ * Runs labelled traces through the firmware gesture classifier
+ * (GestureClassifier.c with the compiled-in GestureTree.c) and scores the
+ * gestures it fires:
+ *
+ *   gcc -O2 -I../professorpiano/include -o gesture_eval gesture_eval.c gesture_file.c \
+ *       ../professorpiano/src/GestureClassifier.c ../professorpiano/src/GestureTree.c
+ *
+ * Usage:
+ *   ./gesture_eval traces/test_*.csv [--min-recall P] [--max-false N] [--repeat N] [--events]
+ *
+ *   --min-recall P  fail if any gesture is found less often than P (default 0.9)
+ *   --max-false N   fail on more than N false gestures in total (default 0)
+ *   --repeat N      classify the traces N times for a stable timing figure
+ *   --events        print every fired gesture as file,t_us,gesture,matched
+ *
+ * A labelled gesture is a run of samples with the same label. It is found
+ * when the classifier fires that gesture (for sustain: starts a hold) between
+ * the first sample of the run and GESTURE_WINDOW samples after its last, the
+ * time the window needs to take the motion in. Anything else fired is false.
+ * A sustain hold also has to be released by the time the hand rests (a gap
+ * longer than GESTURE_MAX_DT_US) or the next gesture starts; one still held
+ * then is stuck and fails the run.
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    11 Mar 2025
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <GestureClassifier.h>
+#include "gesture_file.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_RDTSC 1
+#endif
+
+#define MAX_TRACES 64
+
+typedef struct
+{
+    size_t labelled;
+    size_t found;
+    size_t fired;
+    size_t falseFired;
+    size_t stuck;
+} Score_t;
+
+// Scores one trace; fired gestures are matched against the labelled runs
+static void Evaluate(const char *path, const GestureSample_t *samples, size_t count, Score_t *score, int events)
+{
+    Gesture_t *fired = malloc(count * sizeof(Gesture_t));
+    uint8_t *matched = calloc(count, 1);
+    uint8_t *held = malloc(count);
+    GestureClassifier_t classifier;
+    GestureClassifier_Init(&classifier);
+    for (size_t n = 0; n < count; n++)
+    {
+        fired[n] = GestureClassifier_Update(&classifier, samples[n].gyro, samples[n].accel, samples[n].timestamp_us);
+        held[n] = GestureClassifier_Sustained(&classifier);
+    }
+
+    for (size_t start = 0; start < count;)
+    {
+        uint8_t label = samples[start].label;
+        size_t end = start;
+        while (end + 1 < count && samples[end + 1].label == label)
+        {
+            end++;
+        }
+        if (label != GESTURE_NONE)
+        {
+            score[label].labelled++;
+            size_t last = (end + GESTURE_WINDOW < count) ? end + GESTURE_WINDOW : count - 1;
+            for (size_t n = start; n <= last; n++)
+            {
+                if (fired[n] == label && !matched[n])
+                {
+                    matched[n] = 1;
+                    score[label].found++;
+                    break;
+                }
+            }
+        }
+        if (label == GESTURE_SUSTAIN)
+        {
+            // The last sample before the hand rests or the next gesture
+            size_t last = end + 1;
+            while (last + 1 < count && samples[last + 1].label == GESTURE_NONE &&
+                   (samples[last + 1].timestamp_us - samples[last].timestamp_us) <= GESTURE_MAX_DT_US)
+            {
+                last++;
+            }
+            if (last < count && held[last])
+            {
+                score[label].stuck++;
+                if (events)
+                {
+                    printf("%s,%lu,stuck\n", path, (unsigned long)samples[last].timestamp_us);
+                }
+            }
+        }
+        start = end + 1;
+    }
+
+    for (size_t n = 0; n < count; n++)
+    {
+        if (fired[n] == GESTURE_NONE)
+        {
+            continue;
+        }
+        score[fired[n]].fired++;
+        if (!matched[n])
+        {
+            score[fired[n]].falseFired++;
+        }
+        if (events)
+        {
+            printf("%s,%lu,%c,%d\n", path, (unsigned long)samples[n].timestamp_us, GESTURE_LABELS[fired[n]],
+                   matched[n]);
+        }
+    }
+    free(held);
+    free(matched);
+    free(fired);
+}
+
+int main(int argc, char **argv)
+{
+    const char *paths[MAX_TRACES];
+    int numPaths = 0;
+    double minRecall = 0.9;
+    int maxFalse = 0;
+    int repeat = 1;
+    int events = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--min-recall") == 0 && i + 1 < argc)
+        {
+            minRecall = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--max-false") == 0 && i + 1 < argc)
+        {
+            maxFalse = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+        {
+            repeat = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--events") == 0)
+        {
+            events = 1;
+        }
+        else if (numPaths < MAX_TRACES)
+        {
+            paths[numPaths++] = argv[i];
+        }
+    }
+    if (numPaths == 0 || repeat < 1)
+    {
+        fprintf(stderr, "usage: %s trace.csv... [--min-recall P] [--max-false N] [--repeat N] [--events]\n", argv[0]);
+        return 1;
+    }
+
+    GestureSample_t *traces[MAX_TRACES];
+    size_t lengths[MAX_TRACES];
+    size_t totalSamples = 0;
+    Score_t score[GESTURE_NUM_CLASSES] = {0};
+    for (int p = 0; p < numPaths; p++)
+    {
+        uint32_t badLines;
+        lengths[p] = GestureFile_Load(paths[p], &traces[p], &badLines);
+        if (badLines)
+        {
+            fprintf(stderr, "%s: %u unreadable lines\n", paths[p], badLines);
+        }
+        totalSamples += lengths[p];
+        Evaluate(paths[p], traces[p], lengths[p], score, events);
+    }
+    if (totalSamples == 0)
+    {
+        fprintf(stderr, "no labelled samples\n");
+        return 1;
+    }
+
+    // Per-sample cost over all traces
+    struct timespec start, end;
+    volatile Gesture_t sink = GESTURE_NONE;
+#ifdef HAVE_RDTSC
+    uint64_t tscStart = __rdtsc();
+#endif
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int r = 0; r < repeat; r++)
+    {
+        for (int p = 0; p < numPaths; p++)
+        {
+            GestureClassifier_t classifier;
+            GestureClassifier_Init(&classifier);
+            for (size_t n = 0; n < lengths[p]; n++)
+            {
+                const GestureSample_t *s = &traces[p][n];
+                sink = GestureClassifier_Update(&classifier, s->gyro, s->accel, s->timestamp_us);
+            }
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+#ifdef HAVE_RDTSC
+    uint64_t tscEnd = __rdtsc();
+#endif
+    (void)sink;
+    double updates = (double)totalSamples * repeat;
+    double elapsed_ns = (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+
+    int failed = 0;
+    size_t falseTotal = 0;
+    printf("gesture,labelled,found,recall,fired,false\n");
+    for (int g = GESTURE_NONE + 1; g < GESTURE_NUM_CLASSES; g++)
+    {
+        double recall = score[g].labelled ? (double)score[g].found / score[g].labelled : 1.0;
+        printf("%c,%zu,%zu,%.3f,%zu,%zu\n", GESTURE_LABELS[g], score[g].labelled, score[g].found, recall,
+               score[g].fired, score[g].falseFired);
+        falseTotal += score[g].falseFired;
+        failed |= (recall < minRecall);
+    }
+    failed |= (falseTotal > (size_t)maxFalse);
+    failed |= (score[GESTURE_SUSTAIN].stuck != 0);
+
+    fprintf(stderr, "samples:     %zu in %d trace(s), tree of %u nodes\n", totalSamples, numPaths,
+            GESTURE_TREE_NODES);
+#ifdef HAVE_RDTSC
+    fprintf(stderr, "host:        %.1f ns/sample, %.1f TSC cycles/sample over %d pass(es)\n",
+            elapsed_ns / updates, (tscEnd - tscStart) / updates, repeat);
+#else
+    fprintf(stderr, "host:        %.1f ns/sample over %d pass(es)\n", elapsed_ns / updates, repeat);
+#endif
+    fprintf(stderr, "sustain:     %zu hold(s) still on when the hand rested or moved on\n",
+            score[GESTURE_SUSTAIN].stuck);
+    fprintf(stderr, "result:      %s (min recall %.2f, %zu false of %d allowed)\n", failed ? "FAIL" : "pass",
+            minRecall, falseTotal, maxFalse);
+
+    for (int p = 0; p < numPaths; p++)
+    {
+        free(traces[p]);
+    }
+    return failed ? 2 : 0;
+}
@@ -0,0 +1,83 @@
+/**
+ * @file    gesture_file.c
+ *
+ * Loader for labelled IMU gesture traces shared by the imu_trace host tools.
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    11 Mar 2025
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gesture_file.h"
+
+#define LINE_LENGTH 256
+
+static int LabelToGesture(char label)
+{
+    for (int g = 0; g < GESTURE_NUM_CLASSES; g++)
+    {
+        if (GESTURE_LABELS[g] == label)
+        {
+            return g;
+        }
+    }
+    return -1;
+}
+
+size_t GestureFile_Load(const char *path, GestureSample_t **samplesOut, uint32_t *badLines)
+{
+    *samplesOut = NULL;
+    *badLines = 0;
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        perror(path);
+        return 0;
+    }
+
+    size_t count = 0, capacity = 1024;
+    GestureSample_t *samples = malloc(capacity * sizeof(GestureSample_t));
+    char line[LINE_LENGTH];
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        if (strncmp(line, "G,", 2) != 0)
+        {
+            continue;
+        }
+
+        unsigned long t;
+        int v[6];
+        char label;
+        if (sscanf(line + 2, "%lu,%d,%d,%d,%d,%d,%d,%c", &t, &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &label) != 8)
+        {
+            (*badLines)++;
+            continue;
+        }
+        int gesture = LabelToGesture(label);
+        if (gesture < 0)
+        {
+            (*badLines)++;
+            continue;
+        }
+
+        if (count == capacity)
+        {
+            capacity *= 2;
+            samples = realloc(samples, capacity * sizeof(GestureSample_t));
+        }
+        GestureSample_t *s = &samples[count++];
+        s->timestamp_us = (uint32_t)t;
+        for (int i = 0; i < 3; i++)
+        {
+            s->gyro[i] = (int16_t)v[i];
+            s->accel[i] = (int16_t)v[i + 3];
+        }
+        s->label = (uint8_t)gesture;
+    }
+    fclose(file);
+    *samplesOut = samples;
+    return count;
+}
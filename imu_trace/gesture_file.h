@@ -0,0 +1,34 @@
+/**
+ * @file    gesture_file.h
+ *
+ * Loader for labelled IMU gesture traces shared by the imu_trace host tools.
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    11 Mar 2025
+ */
+
+#ifndef GESTURE_FILE_H
+#define GESTURE_FILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <GestureClassifier.h>
+
+typedef struct
+{
+    uint32_t timestamp_us;
+    int16_t gyro[3];
+    int16_t accel[3];
+    uint8_t label;          // Gesture_t
+} GestureSample_t;
+
+/**
+ * Reads every G,<t_us>,<gx>,<gy>,<gz>,<ax>,<ay>,<az>,<label> line of a trace,
+ * skipping anything else. The label is a GESTURE_LABELS character; lines
+ * with an unknown one are skipped and counted in badLines. The caller frees
+ * *samplesOut. Returns the number of samples.
+ */
+size_t GestureFile_Load(const char *path, GestureSample_t **samplesOut, uint32_t *badLines);
+
+#endif // GESTURE_FILE_H
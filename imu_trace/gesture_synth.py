@@ -0,0 +1,132 @@
+import sys
+import math
+import random
+
+# Writes synthetic labelled gesture traces in the IMU_TRACE "G" format for
+# gesture_train and gesture_eval, until enough recorded ones exist:
+#
+#   python gesture_synth.py traces/synth_01.csv 60 1 [event|sustain-rest]     (output, seconds of motion, seed)
+#
+# Samples come every SAMPLE_US, as when polled. With "event" they come the way
+# the IMU_MOTION_INTERRUPT build reads hand A: the hand also rests between
+# gestures, and while it rests there are no samples at all, so the next
+# gesture often starts right after a long gap. "sustain-rest" is "event" with
+# the fingers snapping back from a sustain and the hand going still at once,
+# so no full window follows the hold.
+#
+# Each line is G,<t_us>,<gx>,<gy>,<gz>,<ax>,<ay>,<az>,<label> in raw BNO055
+# units (gyro 16 LSB/dps with the board's X bias, accel in mg with gravity).
+# Labels are the GESTURE_LABELS characters: - none, U octave up, D octave down,
+# S sustain, M mode toggle. Only the gesture itself is labelled; the wind-up
+# and the way back to neutral are "-". Between gestures the hand plays, which
+# is small random motion and the odd sideways slide.
+
+GYRO_LSB_PER_DPS = 16                # OCTAVE_GYRO_LSB_PER_DPS
+GYRO_BIAS_X = 18                     # OCTAVE_GYRO_BIAS_RAW
+SAMPLE_US = 20000                    # IMU_PERIOD_US
+JITTER_US = 1500
+GYRO_NOISE_DPS = 0.8
+ACCEL_NOISE_MG = 12
+
+out_name = sys.argv[1]
+seconds = float(sys.argv[2]) if len(sys.argv) > 2 else 60.0
+random.seed(int(sys.argv[3]) if len(sys.argv) > 3 else 1)
+mode = sys.argv[4] if len(sys.argv) > 4 else ""
+event = mode in ("event", "sustain-rest")
+
+state = {"t_us": random.randint(0, 10000000), "roll": 0.0, "pitch": 0.0, "lines": []}
+
+
+def emit(roll_rate, pitch_rate, yaw_rate, lin_y, label):
+    """One sample; rates in dps, angles integrate in degrees."""
+    dt = (SAMPLE_US + random.randint(-JITTER_US, JITTER_US)) / 1e6
+    state["t_us"] = (state["t_us"] + int(dt * 1e6)) & 0xFFFFFFFF
+    state["roll"] += roll_rate * dt
+    state["pitch"] += pitch_rate * dt
+    roll = math.radians(state["roll"])
+    pitch = math.radians(state["pitch"])
+
+    gyro = [roll_rate, pitch_rate, yaw_rate]
+    gyro = [int(round((g + random.gauss(0, GYRO_NOISE_DPS)) * GYRO_LSB_PER_DPS)) for g in gyro]
+    gyro[0] += GYRO_BIAS_X
+    accel = [-1000 * math.sin(pitch),
+             1000 * math.sin(roll) * math.cos(pitch) + lin_y,
+             1000 * math.cos(roll) * math.cos(pitch)]
+    accel = [int(round(a + random.gauss(0, ACCEL_NOISE_MG))) for a in accel]
+    state["lines"].append("G,%d,%d,%d,%d,%d,%d,%d,%s" % (state["t_us"], *gyro, *accel, label))
+
+
+def move(axis, degrees, duration, label):
+    """Raised-cosine rotation about one axis."""
+    steps = max(1, int(duration * 1e6 / SAMPLE_US))
+    peak = degrees / duration * 2   # Mean of the raised cosine is half its peak
+    for i in range(steps):
+        rate = peak * 0.5 * (1 - math.cos(2 * math.pi * (i + 0.5) / steps))
+        emit(rate if axis == "roll" else 0, rate if axis == "pitch" else 0, 0, 0, label)
+
+
+def play(duration, label="-"):
+    """Fingers on the keys: small wobble and occasional sideways slides."""
+    steps = int(duration * 1e6 / SAMPLE_US)
+    i = 0
+    while i < steps:
+        if random.random() < 0.03 and steps - i > 15:
+            slide = random.choice([-1, 1]) * random.uniform(150, 400)
+            for k in range(15):
+                emit(random.gauss(0, 6), random.gauss(0, 6), random.gauss(0, 10),
+                     slide * math.sin(2 * math.pi * k / 15), label)
+            i += 15
+            continue
+        # Drift back towards the pose the gesture left the hand in
+        emit(random.gauss(0, 8) - state["roll"] * 0.05, random.gauss(0, 8), random.gauss(0, 12), 0, label)
+        i += 1
+
+
+def rest(duration):
+    """Hand still: no motion interrupt, so time passes without samples."""
+    state["t_us"] = (state["t_us"] + int(duration * 1e6)) & 0xFFFFFFFF
+
+
+def twist(direction):
+    label = "U" if direction < 0 else "D"
+    angle = direction * random.uniform(40, 65)
+    start = state["roll"]
+    move("roll", angle, random.uniform(0.2, 0.35), label)
+    play(random.uniform(0.1, 0.4))
+    move("roll", start - state["roll"], random.uniform(0.9, 1.5), "-")
+
+
+def sustain():
+    angle = random.uniform(30, 50)
+    move("pitch", angle, random.uniform(0.3, 0.5), "-")
+    play(random.uniform(1.0, 3.0), "S")
+    if mode == "sustain-rest":
+        # Fingers snap back in a few samples and the hand goes still
+        move("pitch", -state["pitch"], random.randint(2, 4) * SAMPLE_US / 1e6, "-")
+        rest(random.uniform(0.5, 3.0))
+    else:
+        move("pitch", -angle, random.uniform(0.3, 0.5), "-")
+
+
+def shake():
+    amplitude = random.uniform(180, 300)
+    frequency = random.uniform(3, 5)
+    steps = int(random.uniform(0.6, 1.0) * 1e6 / SAMPLE_US)
+    for i in range(steps):
+        t = i * SAMPLE_US / 1e6
+        emit(random.gauss(0, 6), random.gauss(0, 6), amplitude * math.sin(2 * math.pi * frequency * t), 0, "M")
+
+
+play(1.0)
+while len(state["lines"]) * SAMPLE_US / 1e6 < seconds:
+    random.choice([lambda: twist(-1), lambda: twist(1), sustain, shake])()
+    if event and random.random() < 0.6:
+        # The next gesture starts from the still hand
+        play(random.uniform(0.3, 1.0))
+        rest(random.uniform(0.5, 3.0))
+    else:
+        play(random.uniform(0.8, 2.5))
+
+with open(out_name, "w") as out:
+    out.write("\n".join(state["lines"]) + "\n")
+print(f"Wrote {len(state['lines'])} samples to {out_name}")
@@ -0,0 +1,317 @@
+/**
+ * @file    gesture_train.c
+ *
+ * Fits the decision tree of the firmware gesture classifier
+ * (GestureClassifier.c) to labelled traces and writes it out as the const
+ * table in GestureTree.c:
+ *
+ *   gcc -O2 -I../professorpiano/include -o gesture_train gesture_train.c gesture_file.c \
+ *       ../professorpiano/src/GestureClassifier.c ../professorpiano/src/GestureTree.c
+ *
+ * Usage:
+ *   ./gesture_train traces/train_*.csv [--depth N] [--min-leaf N] > ../professorpiano/src/GestureTree.c
+ *
+ *   --depth N     deepest split (default 6, at most GESTURE_TREE_MAX_DEPTH)
+ *   --min-leaf N  fewest windows on either side of a split (default 12)
+ *
+ * Features come from the firmware code itself, sample by sample, so the tree
+ * sees exactly what the board computes. A window is labelled with the
+ * trace label at its middle sample. Classes are weighted by inverse frequency,
+ * otherwise the tree would happily answer "none" to everything; splits
+ * minimise the weighted Gini impurity. The tree linked into this tool is only
+ * used for the classifier's own decisions, which training ignores.
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    11 Mar 2025
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <GestureClassifier.h>
+#include "gesture_file.h"
+
+#define MAX_NODES 255
+
+typedef struct
+{
+    int32_t features[GESTURE_NUM_FEATURES];
+    uint8_t label;
+} Window_t;
+
+static const char *FEATURE_NAMES[GESTURE_NUM_FEATURES] = {
+    "GF_TWIST_DEG", "GF_PITCH_DEG", "GF_SHAKE_DPS", "GF_REVERSALS",
+    "GF_ACCEL_X_MG", "GF_ACCEL_Y_MG", "GF_ACCEL_Z_MG", "GF_JERK_MG",
+};
+
+static const char *GESTURE_NAMES[GESTURE_NUM_CLASSES] = {
+    "GESTURE_NONE", "GESTURE_OCTAVE_UP", "GESTURE_OCTAVE_DOWN", "GESTURE_SUSTAIN", "GESTURE_MODE_TOGGLE",
+};
+
+static Window_t *windows;
+static double classWeight[GESTURE_NUM_CLASSES];
+static GestureNode_t tree[MAX_NODES];
+static int numNodes = 0;
+static int maxDepth = 6;
+static int minLeaf = 12;
+static int sortFeature;
+
+static int CompareWindows(const void *a, const void *b)
+{
+    int32_t fa = windows[*(const size_t *)a].features[sortFeature];
+    int32_t fb = windows[*(const size_t *)b].features[sortFeature];
+    return (fa > fb) - (fa < fb);
+}
+
+static double Gini(const double *weights, double total)
+{
+    if (total <= 0)
+    {
+        return 0;
+    }
+    double sum = 0;
+    for (int c = 0; c < GESTURE_NUM_CLASSES; c++)
+    {
+        sum += (weights[c] / total) * (weights[c] / total);
+    }
+    return 1.0 - sum;
+}
+
+static int Majority(const size_t *index, size_t count)
+{
+    double weights[GESTURE_NUM_CLASSES] = {0};
+    for (size_t i = 0; i < count; i++)
+    {
+        weights[windows[index[i]].label] += classWeight[windows[index[i]].label];
+    }
+    int best = 0;
+    for (int c = 1; c < GESTURE_NUM_CLASSES; c++)
+    {
+        best = (weights[c] > weights[best]) ? c : best;
+    }
+    return best;
+}
+
+static int AddLeaf(int gesture)
+{
+    tree[numNodes] = (GestureNode_t){.feature = GESTURE_LEAF, .left = (uint8_t)gesture};
+    return numNodes++;
+}
+
+// Grows the subtree for index[0..count) and returns its node, children are
+// stored after their parent
+static int Grow(size_t *index, size_t count, int depth)
+{
+    double weights[GESTURE_NUM_CLASSES] = {0};
+    double total = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        weights[windows[index[i]].label] += classWeight[windows[index[i]].label];
+        total += classWeight[windows[index[i]].label];
+    }
+
+    // Room for this node and two leaves
+    double parentGini = Gini(weights, total);
+    if (depth >= maxDepth || count < 2 * (size_t)minLeaf || parentGini == 0 || numNodes + 3 > MAX_NODES)
+    {
+        return AddLeaf(Majority(index, count));
+    }
+
+    int bestFeature = -1;
+    int32_t bestThreshold = 0;
+    double bestGini = parentGini;
+    for (int f = 0; f < GESTURE_NUM_FEATURES; f++)
+    {
+        sortFeature = f;
+        qsort(index, count, sizeof(size_t), CompareWindows);
+
+        double left[GESTURE_NUM_CLASSES] = {0};
+        double leftTotal = 0;
+        for (size_t i = 0; i + 1 < count; i++)
+        {
+            const Window_t *w = &windows[index[i]];
+            left[w->label] += classWeight[w->label];
+            leftTotal += classWeight[w->label];
+
+            int32_t value = w->features[f];
+            int32_t next = windows[index[i + 1]].features[f];
+            if (value == next || i + 1 < (size_t)minLeaf || count - i - 1 < (size_t)minLeaf)
+            {
+                continue;
+            }
+
+            double right[GESTURE_NUM_CLASSES];
+            for (int c = 0; c < GESTURE_NUM_CLASSES; c++)
+            {
+                right[c] = weights[c] - left[c];
+            }
+            double gini = (leftTotal * Gini(left, leftTotal) + (total - leftTotal) * Gini(right, total - leftTotal)) / total;
+            if (gini < bestGini - 1e-12)
+            {
+                bestGini = gini;
+                bestFeature = f;
+                // Floor of the midpoint, so value goes left and next goes right
+                int64_t sum = (int64_t)value + next;
+                bestThreshold = (int32_t)((sum >= 0) ? sum / 2 : -((-sum + 1) / 2));
+            }
+        }
+    }
+    if (bestFeature < 0)
+    {
+        return AddLeaf(Majority(index, count));
+    }
+
+    // Partition on the chosen split
+    size_t split = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (windows[index[i]].features[bestFeature] <= bestThreshold)
+        {
+            size_t swap = index[split];
+            index[split++] = index[i];
+            index[i] = swap;
+        }
+    }
+
+    int node = numNodes++;
+    tree[node].feature = (uint8_t)bestFeature;
+    tree[node].threshold = bestThreshold;
+    int left = Grow(index, split, depth + 1);
+    int right = Grow(index + split, count - split, depth + 1);
+
+    // Both sides agree: the split is useless
+    if (tree[left].feature == GESTURE_LEAF && tree[right].feature == GESTURE_LEAF && tree[left].left == tree[right].left)
+    {
+        int gesture = tree[left].left;
+        numNodes = node;
+        return AddLeaf(gesture);
+    }
+    tree[node].left = (uint8_t)left;
+    tree[node].right = (uint8_t)right;
+    return node;
+}
+
+int main(int argc, char **argv)
+{
+    const char *paths[64];
+    int numPaths = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--depth") == 0 && i + 1 < argc)
+        {
+            maxDepth = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--min-leaf") == 0 && i + 1 < argc)
+        {
+            minLeaf = atoi(argv[++i]);
+        }
+        else if (numPaths < 64)
+        {
+            paths[numPaths++] = argv[i];
+        }
+    }
+    if (numPaths == 0 || maxDepth < 1 || maxDepth > GESTURE_TREE_MAX_DEPTH || minLeaf < 1)
+    {
+        fprintf(stderr, "usage: %s trace.csv... [--depth N] [--min-leaf N]\n", argv[0]);
+        return 1;
+    }
+
+    // Feature vector of every full window
+    size_t numWindows = 0, capacity = 4096;
+    windows = malloc(capacity * sizeof(Window_t));
+    size_t perClass[GESTURE_NUM_CLASSES] = {0};
+    for (int p = 0; p < numPaths; p++)
+    {
+        GestureSample_t *samples;
+        uint32_t badLines;
+        size_t numSamples = GestureFile_Load(paths[p], &samples, &badLines);
+        if (badLines)
+        {
+            fprintf(stderr, "%s: %u unreadable lines\n", paths[p], badLines);
+        }
+
+        GestureClassifier_t classifier;
+        GestureClassifier_Init(&classifier);
+        for (size_t n = 0; n < numSamples; n++)
+        {
+            GestureClassifier_Update(&classifier, samples[n].gyro, samples[n].accel, samples[n].timestamp_us);
+            Window_t w;
+            if (!GestureClassifier_Features(&classifier, w.features))
+            {
+                continue;
+            }
+            w.label = samples[n - GESTURE_WINDOW / 2].label;
+            if (numWindows == capacity)
+            {
+                capacity *= 2;
+                windows = realloc(windows, capacity * sizeof(Window_t));
+            }
+            windows[numWindows++] = w;
+            perClass[w.label]++;
+        }
+        free(samples);
+    }
+    if (numWindows == 0)
+    {
+        fprintf(stderr, "no labelled windows\n");
+        return 1;
+    }
+    for (int c = 0; c < GESTURE_NUM_CLASSES; c++)
+    {
+        classWeight[c] = perClass[c] ? (double)numWindows / (GESTURE_NUM_CLASSES * perClass[c]) : 0;
+    }
+
+    size_t *index = malloc(numWindows * sizeof(size_t));
+    for (size_t i = 0; i < numWindows; i++)
+    {
+        index[i] = i;
+    }
+    Grow(index, numWindows, 0);
+
+    // Per-window accuracy of the new tree on its own training set
+    size_t correct[GESTURE_NUM_CLASSES] = {0};
+    for (size_t i = 0; i < numWindows; i++)
+    {
+        if (GestureClassifier_Classify(tree, (uint8_t)numNodes, windows[i].features) == windows[i].label)
+        {
+            correct[windows[i].label]++;
+        }
+    }
+
+    printf("/**\n * @file    GestureTree.c\n *\n");
+    printf(" * Decision tree for GestureClassifier.c, generated by imu_trace/gesture_train\n");
+    printf(" * (--depth %d --min-leaf %d) from:\n *\n", maxDepth, minLeaf);
+    for (int p = 0; p < numPaths; p++)
+    {
+        printf(" *   %s\n", paths[p]);
+    }
+    printf(" *\n * Do not edit; record and label more traces and retrain instead.\n *\n");
+    printf(" * Training windows, correct / total:\n");
+    for (int c = 0; c < GESTURE_NUM_CLASSES; c++)
+    {
+        printf(" *   %-20s %6zu / %zu\n", GESTURE_NAMES[c], correct[c], perClass[c]);
+    }
+    printf(" */\n\n#include <GestureClassifier.h>\n\n");
+    printf("const GestureNode_t GESTURE_TREE[] = {\n");
+    for (int n = 0; n < numNodes; n++)
+    {
+        if (tree[n].feature == GESTURE_LEAF)
+        {
+            printf("    {GESTURE_LEAF, %s, 0, 0}, // %d\n", GESTURE_NAMES[tree[n].left], n);
+        }
+        else
+        {
+            printf("    {%s, %d, %d, %ld}, // %d\n", FEATURE_NAMES[tree[n].feature], tree[n].left, tree[n].right,
+                   (long)tree[n].threshold, n);
+        }
+    }
+    printf("};\n\nconst uint8_t GESTURE_TREE_NODES = sizeof(GESTURE_TREE) / sizeof(GESTURE_TREE[0]);\n");
+
+    fprintf(stderr, "%zu windows, %d nodes\n", numWindows, numNodes);
+    free(index);
+    free(windows);
+    return 0;
+}
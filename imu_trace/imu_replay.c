@@ -0,0 +1,427 @@
+/**
+ * @file    imu_replay.c
+ *
+ * Host replay of IMU traces through the firmware octave gesture detector
+ * (ImuGesture.c). Traces are the serial output of a build with IMU_TRACE:
+ *
+ *   gcc -O2 -I../professorpiano/include -o imu_replay \
+ *       imu_replay.c ../professorpiano/src/ImuGesture.c -lm
+ *
+ * Usage:
+ *   ./imu_replay trace.csv [--repeat N] [--decisions] [--write out.csv]
+ *
+ *   --repeat N    replay the trace N times for a stable timing figure
+ *   --decisions   print every octave change as t_us,octave,reference_octave
+ *   --write F     write the trace to F as R/F lines with the float model's
+ *                 octave, to make a reference trace from a synthetic or G
+ *                 capture
+ *
+ * Trace lines, anything else on the console is skipped:
+ *
+ *   R,<t_us>,<gyroX>,<accelX>[,<octave>[,<cycles>]]                   raw AMG
+ *   F,<t_us>,<qw>,<qx>,<qy>,<qz>,<linAccelX>[,<octave>[,<cycles>]]    NDOF fusion
+ *   G,<t_us>,<gx>,<gy>,<gz>,<ax>,<ay>,<az>,<class>[,<cycles>]         GESTURE_CLASSIFIER
+ *
+ * G lines are what IMU_TRACE prints with the gesture classifier on. They are
+ * replayed through the raw path as gyro X and accel X; the classifier decided
+ * the octave on the board, so they carry no octave or cycles to check.
+ *
+ * The pass/fail reference is a floating point model of the same detector
+ * (the old Octave.c arithmetic without the fixed DT): any sample decided
+ * differently from it makes the exit status 3. Every sample's octave is also
+ * checked against the one in the trace; any mismatch makes it 2. Only a board
+ * capture makes that second check independent, since --write takes the
+ * column from the float model. Timing is reported on the host per update
+ * and, when the trace has them, as the firmware DWT cycle counts.
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    10 Mar 2025
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <ImuGesture.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_RDTSC 1
+#endif
+
+#define LINE_LENGTH 256
+#define NO_OCTAVE (-1)
+
+typedef struct
+{
+    char kind;              // 'R' or 'F', G lines load as 'R'
+    uint32_t timestamp_us;
+    int16_t values[5];      // R: gyroX, accelX. F: qw, qx, qy, qz, linAccelX
+    int8_t octave;          // Logged by the board, NO_OCTAVE if missing
+    uint32_t cycles;        // Logged by the board, 0 if missing
+} TraceSample_t;
+
+typedef struct
+{
+    int octave;
+    int started;
+    int changed;
+    double lastSample_s;
+    double lastChange_s;
+    double prevRate;
+    double twist_deg;
+    double ref[4];
+} ReferenceModel_t;
+
+static size_t LoadTrace(const char *path, TraceSample_t **samples)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        perror(path);
+        return 0;
+    }
+
+    size_t count = 0, capacity = 1024;
+    *samples = malloc(capacity * sizeof(TraceSample_t));
+    char line[LINE_LENGTH];
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        TraceSample_t s = {.kind = line[0], .octave = NO_OCTAVE};
+        unsigned long t, cycles = 0;
+        int v[5] = {0}, octave = NO_OCTAVE;
+        int fields;
+
+        if (strncmp(line, "R,", 2) == 0)
+        {
+            fields = sscanf(line + 2, "%lu,%d,%d,%d,%lu", &t, &v[0], &v[1], &octave, &cycles);
+            if (fields < 3)
+            {
+                continue;
+            }
+        }
+        else if (strncmp(line, "G,", 2) == 0)
+        {
+            int gyroY, gyroZ;
+            fields = sscanf(line + 2, "%lu,%d,%d,%d,%d", &t, &v[0], &gyroY, &gyroZ, &v[1]);
+            if (fields < 5)
+            {
+                continue;
+            }
+            s.kind = 'R';
+        }
+        else if (strncmp(line, "F,", 2) == 0)
+        {
+            fields = sscanf(line + 2, "%lu,%d,%d,%d,%d,%d,%d,%lu", &t, &v[0], &v[1], &v[2], &v[3], &v[4],
+                            &octave, &cycles);
+            if (fields < 6)
+            {
+                continue;
+            }
+        }
+        else
+        {
+            continue;
+        }
+
+        s.timestamp_us = (uint32_t)t;
+        for (int i = 0; i < 5; i++)
+        {
+            s.values[i] = (int16_t)v[i];
+        }
+        s.octave = (int8_t)octave;
+        s.cycles = (uint32_t)cycles;
+
+        if (count == capacity)
+        {
+            capacity *= 2;
+            *samples = realloc(*samples, capacity * sizeof(TraceSample_t));
+        }
+        (*samples)[count++] = s;
+    }
+    fclose(file);
+    return count;
+}
+
+static int WriteTrace(const char *path, const TraceSample_t *samples, const int8_t *octaves, size_t count)
+{
+    FILE *file = fopen(path, "w");
+    if (file == NULL)
+    {
+        perror(path);
+        return 0;
+    }
+
+    for (size_t n = 0; n < count; n++)
+    {
+        const TraceSample_t *s = &samples[n];
+        if (s->kind == 'R')
+        {
+            fprintf(file, "R,%lu,%d,%d,%d", (unsigned long)s->timestamp_us, s->values[0], s->values[1],
+                    octaves[n]);
+        }
+        else
+        {
+            fprintf(file, "F,%lu,%d,%d,%d,%d,%d,%d", (unsigned long)s->timestamp_us, s->values[0],
+                    s->values[1], s->values[2], s->values[3], s->values[4], octaves[n]);
+        }
+        if (s->cycles != 0)
+        {
+            fprintf(file, ",%lu", (unsigned long)s->cycles);
+        }
+        fputc('\n', file);
+    }
+    fclose(file);
+    return 1;
+}
+
+static int8_t Replay(ImuGesture_t *gesture, const TraceSample_t *s)
+{
+    if (s->kind == 'R')
+    {
+        return ImuGesture_UpdateRaw(gesture, s->values[0], s->values[1], s->timestamp_us);
+    }
+    return ImuGesture_UpdateFusion(gesture, s->values, s->values[4], s->timestamp_us);
+}
+
+// Floating point model of the same detector ******************************************************
+static int Reference_Apply(ReferenceModel_t *model, int moveRight, int moveLeft, double t)
+{
+    if (model->changed && (t - model->lastChange_s) <= OCTAVE_CHANGE_COOLDOWN_US * 1e-6)
+    {
+        return model->octave;
+    }
+    if (moveRight && !moveLeft && model->octave > OCTAVE_MIN)
+    {
+        model->octave--;
+    }
+    else if (moveLeft && !moveRight && model->octave < OCTAVE_MAX)
+    {
+        model->octave++;
+    }
+    else
+    {
+        return model->octave;
+    }
+    model->changed = 1;
+    model->lastChange_s = t;
+    return model->octave;
+}
+
+static int Reference_Update(ReferenceModel_t *model, const TraceSample_t *s, double t)
+{
+    if (s->kind == 'R')
+    {
+        double rate = fmax(-OCTAVE_GYRO_MAX_RAW, fmin(OCTAVE_GYRO_MAX_RAW, s->values[0] - OCTAVE_GYRO_BIAS_RAW));
+        rate /= OCTAVE_GYRO_LSB_PER_DPS;
+        if (!model->started)
+        {
+            model->started = 1;
+            model->prevRate = rate;
+            model->lastSample_s = t;
+            return model->octave;
+        }
+        double dt = fmin(t - model->lastSample_s, OCTAVE_MAX_DT_US * 1e-6);
+        model->lastSample_s = t;
+        model->twist_deg += (model->prevRate + rate) * 0.5 * dt;
+        model->prevRate = rate;
+        model->twist_deg *= 1.0 - dt / (OCTAVE_LEAK_TAU_US * 1e-6);
+        model->twist_deg = fmax(-180.0, fmin(180.0, model->twist_deg));
+
+        double limit = OCTAVE_TWIST_MDEG / 1000.0;
+        return Reference_Apply(model, model->twist_deg > limit || s->values[1] > OCTAVE_THRESHOLD_ACCEL,
+                               model->twist_deg < -limit || s->values[1] < -OCTAVE_THRESHOLD_ACCEL, t);
+    }
+
+    double q[4];
+    double norm = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        q[i] = s->values[i] / (double)OCTAVE_QUAT_ONE;
+        norm += q[i] * q[i];
+    }
+    if (norm < 0.5 || norm > 2.0)
+    {
+        return model->octave;
+    }
+    if (!model->started)
+    {
+        memcpy(model->ref, q, sizeof(q));
+        model->started = 1;
+        return model->octave;
+    }
+    const double *r = model->ref;
+    double relW = r[0] * q[0] + r[1] * q[1] + r[2] * q[2] + r[3] * q[3];
+    double relX = r[0] * q[1] - r[1] * q[0] - r[2] * q[3] + r[3] * q[2];
+    if (relW < 0)
+    {
+        relX = -relX;
+    }
+    double limit = sin(OCTAVE_TWIST_MDEG / 2000.0 * M_PI / 180.0);
+    return Reference_Apply(model, relX > limit || s->values[4] > OCTAVE_THRESHOLD_ACCEL,
+                           relX < -limit || s->values[4] < -OCTAVE_THRESHOLD_ACCEL, t);
+}
+
+int main(int argc, char **argv)
+{
+    const char *tracePath = NULL;
+    int repeat = 1;
+    int decisions = 0;
+    const char *writePath = NULL;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+        {
+            repeat = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--decisions") == 0)
+        {
+            decisions = 1;
+        }
+        else if (strcmp(argv[i], "--write") == 0 && i + 1 < argc)
+        {
+            writePath = argv[++i];
+        }
+        else
+        {
+            tracePath = argv[i];
+        }
+    }
+    if (tracePath == NULL || repeat < 1)
+    {
+        fprintf(stderr, "usage: %s trace.csv [--repeat N] [--decisions] [--write out.csv]\n", argv[0]);
+        return 1;
+    }
+
+    TraceSample_t *samples = NULL;
+    size_t numSamples = LoadTrace(tracePath, &samples);
+    if (numSamples == 0)
+    {
+        fprintf(stderr, "no IMU samples in %s\n", tracePath);
+        free(samples);
+        return 1;
+    }
+
+    // Decisions against the board and the floating point model
+    int8_t *references = malloc(numSamples * sizeof(int8_t));
+    ImuGesture_t gesture;
+    ImuGesture_Init(&gesture, STARTING_OCTAVE);
+    ReferenceModel_t model = {.octave = STARTING_OCTAVE};
+    size_t logged = 0, mismatches = 0, modelDiffs = 0, changes = 0;
+    uint64_t cycleSum = 0;
+    uint32_t cycleMax = 0;
+    size_t cycleCount = 0;
+    int8_t lastOctave = STARTING_OCTAVE;
+    double t0 = samples[0].timestamp_us * 1e-6, wrap = 0;
+
+    for (size_t n = 0; n < numSamples; n++)
+    {
+        const TraceSample_t *s = &samples[n];
+        if (n > 0 && s->timestamp_us < samples[n - 1].timestamp_us)
+        {
+            wrap += 4294.967296; // 32-bit microsecond counter rolled over
+        }
+        int8_t octave = Replay(&gesture, s);
+        int reference = Reference_Update(&model, s, s->timestamp_us * 1e-6 + wrap - t0);
+        references[n] = (int8_t)reference;
+
+        if (s->octave != NO_OCTAVE)
+        {
+            logged++;
+            if (octave != s->octave)
+            {
+                if (mismatches < 10)
+                {
+                    fprintf(stderr, "mismatch at %lu us: replay %d, logged %d\n",
+                            (unsigned long)s->timestamp_us, octave, s->octave);
+                }
+                mismatches++;
+            }
+        }
+        if (octave != reference)
+        {
+            if (modelDiffs < 10)
+            {
+                fprintf(stderr, "differs at %lu us: replay %d, float model %d\n",
+                        (unsigned long)s->timestamp_us, octave, reference);
+            }
+            modelDiffs++;
+        }
+        if (octave != lastOctave)
+        {
+            changes++;
+            lastOctave = octave;
+            if (decisions)
+            {
+                printf("%lu,%d,%d\n", (unsigned long)s->timestamp_us, octave, reference);
+            }
+        }
+        if (s->cycles != 0)
+        {
+            cycleSum += s->cycles;
+            cycleMax = (s->cycles > cycleMax) ? s->cycles : cycleMax;
+            cycleCount++;
+        }
+    }
+
+    // Host timing over the whole trace
+    struct timespec start, end;
+    volatile int8_t sink = 0;
+#ifdef HAVE_RDTSC
+    uint64_t tscStart = __rdtsc();
+#endif
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int r = 0; r < repeat; r++)
+    {
+        ImuGesture_Init(&gesture, STARTING_OCTAVE);
+        for (size_t n = 0; n < numSamples; n++)
+        {
+            sink = Replay(&gesture, &samples[n]);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+#ifdef HAVE_RDTSC
+    uint64_t tscEnd = __rdtsc();
+#endif
+    (void)sink;
+    double updates = (double)numSamples * repeat;
+    double elapsed_ns = (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+
+    fprintf(stderr, "samples:     %zu (%zu with a logged octave), %zu octave changes\n",
+            numSamples, logged, changes);
+    fprintf(stderr, "logged:      %zu mismatches\n", mismatches);
+    fprintf(stderr, "float model: %zu samples decided differently\n", modelDiffs);
+#ifdef HAVE_RDTSC
+    fprintf(stderr, "host:        %.1f ns/update, %.1f TSC cycles/update over %d pass(es)\n",
+            elapsed_ns / updates, (tscEnd - tscStart) / updates, repeat);
+#else
+    fprintf(stderr, "host:        %.1f ns/update over %d pass(es)\n", elapsed_ns / updates, repeat);
+#endif
+    if (cycleCount > 0)
+    {
+        fprintf(stderr, "firmware:    %.1f cycles/update mean, %lu worst (%zu samples)\n",
+                (double)cycleSum / cycleCount, (unsigned long)cycleMax, cycleCount);
+    }
+
+    int written = 1;
+    if (writePath != NULL)
+    {
+        written = WriteTrace(writePath, samples, references, numSamples);
+    }
+
+    free(references);
+    free(samples);
+    if (!written)
+    {
+        return 1;
+    }
+    if (modelDiffs != 0)
+    {
+        return 3;
+    }
+    return (mismatches == 0) ? 0 : 2;
+}
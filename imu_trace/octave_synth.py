@@ -0,0 +1,107 @@
+import sys
+import math
+import random
+
+# Writes synthetic octave gesture traces in the IMU_TRACE "R" or "F" format
+# for imu_replay, until enough recorded ones exist:
+#
+#   python octave_synth.py traces/octave_raw_01.csv R 40 1     (output, format, seconds, seed)
+#   ./imu_replay traces/octave_raw_01.csv --write traces/octave_raw_01.csv
+#   python octave_synth.py traces/octave_fusion_01.csv F 40 2
+#
+# The second step fills in the octave column from the firmware detector, so
+# the trace pins down its current decisions. There is no cycles column; only
+# a board capture has real DWT counts.
+#
+# R lines are R,<t_us>,<gyroX>,<accelX> in raw BNO055 units (gyro 16 LSB/dps
+# with the board's X bias, accel in mg with gravity). F lines are
+# F,<t_us>,<qw>,<qx>,<qy>,<qz>,<linAccelX> with the NDOF quaternion in Q14.
+# Both are timed like IMU_MOTION_INTERRUPT: samples every SAMPLE_US while the
+# hand moves, nothing while it rests, so the detector sees the long gaps the
+# default build gives it.
+#
+# The hand plays with small wobble, twists about X to step the octave, pushes
+# along X now and then, and rests.
+
+GYRO_LSB_PER_DPS = 16                # OCTAVE_GYRO_LSB_PER_DPS
+GYRO_BIAS_X = 18                     # OCTAVE_GYRO_BIAS_RAW
+QUAT_ONE = 16384                     # OCTAVE_QUAT_ONE
+SAMPLE_US = 20000                    # IMU_PERIOD_US
+JITTER_US = 1500
+GYRO_NOISE_DPS = 0.8
+ACCEL_NOISE_MG = 12
+QUAT_NOISE_DEG = 0.3
+
+out_name = sys.argv[1]
+kind = sys.argv[2] if len(sys.argv) > 2 else "R"
+seconds = float(sys.argv[3]) if len(sys.argv) > 3 else 40.0
+random.seed(int(sys.argv[4]) if len(sys.argv) > 4 else 1)
+
+state = {"t_us": random.randint(0, 10000000), "roll": 0.0, "elapsed": 0.0, "lines": []}
+
+
+def emit(roll_rate, lin_x):
+    """One sample; roll rate in dps, the angle integrates in degrees."""
+    dt = (SAMPLE_US + random.randint(-JITTER_US, JITTER_US)) / 1e6
+    state["t_us"] = (state["t_us"] + int(dt * 1e6)) & 0xFFFFFFFF
+    state["elapsed"] += dt
+    state["roll"] += roll_rate * dt
+    accel_x = int(round(lin_x + random.gauss(0, ACCEL_NOISE_MG)))
+
+    if kind == "R":
+        gyro_x = int(round((roll_rate + random.gauss(0, GYRO_NOISE_DPS)) * GYRO_LSB_PER_DPS)) + GYRO_BIAS_X
+        state["lines"].append("R,%d,%d,%d" % (state["t_us"], gyro_x, accel_x))
+    else:
+        half = math.radians(state["roll"] + random.gauss(0, QUAT_NOISE_DEG)) / 2
+        tilt = math.radians(random.gauss(0, QUAT_NOISE_DEG)) / 2
+        quat = [math.cos(half) * math.cos(tilt), math.sin(half) * math.cos(tilt),
+                math.cos(half) * math.sin(tilt), 0.0]
+        quat = [int(round(q * QUAT_ONE)) for q in quat]
+        state["lines"].append("F,%d,%d,%d,%d,%d,%d" % (state["t_us"], *quat, accel_x))
+
+
+def move(degrees, duration):
+    """Raised-cosine twist about X."""
+    steps = max(1, int(duration * 1e6 / SAMPLE_US))
+    peak = degrees / duration * 2   # Mean of the raised cosine is half its peak
+    for i in range(steps):
+        emit(peak * 0.5 * (1 - math.cos(2 * math.pi * (i + 0.5) / steps)), 0)
+
+
+def play(duration):
+    """Fingers on the keys: small wobble, drifting back to neutral."""
+    for _ in range(int(duration * 1e6 / SAMPLE_US)):
+        emit(random.gauss(0, 6) - state["roll"] * 0.5, 0)
+
+
+def rest(duration):
+    """Hand still: the motion interrupt stays quiet."""
+    state["t_us"] = (state["t_us"] + int(duration * 1e6)) & 0xFFFFFFFF
+    state["elapsed"] += duration
+
+
+def twist(direction):
+    angle = direction * random.uniform(40, 65)
+    move(angle, random.uniform(0.2, 0.35))
+    play(random.uniform(0.1, 0.3))
+    move(-state["roll"], random.uniform(1.5, 2.5))
+
+
+def push(direction):
+    steps = random.randint(4, 7)
+    peak = direction * random.uniform(900, 1400)
+    for i in range(steps):
+        emit(random.gauss(0, 6), peak * math.sin(math.pi * (i + 0.5) / steps))
+
+
+play(1.0)
+while state["elapsed"] < seconds:
+    random.choice([lambda: twist(-1), lambda: twist(1), lambda: push(-1), lambda: push(1)])()
+    play(random.uniform(0.5, 1.5))
+    if random.random() < 0.5:
+        rest(random.uniform(0.5, 3.0))
+        play(random.uniform(0.3, 1.0))
+
+with open(out_name, "w") as out:
+    out.write("\n".join(state["lines"]) + "\n")
+print(f"Wrote {len(state['lines'])} samples to {out_name}")
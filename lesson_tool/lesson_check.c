@@ -0,0 +1,93 @@
+/**
+ * @file    lesson_check.c
+ *
+ * Loads lesson blobs through the firmware parser (Lesson.c), the same checks
+ * the board makes, and lists their steps:
+ *
+ *   gcc -O2 -I../professorpiano/include -o lesson_check lesson_check.c ../professorpiano/src/Lesson.c
+ *
+ * Usage:
+ *   ./lesson_check lesson.bin... [--quiet]
+ *
+ * The exit status is nonzero if any blob is rejected.
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    11 Mar 2025
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <Lesson.h>
+
+static const char *NOTE_NAMES[LESSON_NUM_NOTES] = {"B", "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#"};
+static const char *FINGER_NAMES[] = {"Unknown", "B_Thumb", "Thumb", "Index", "Middle", "Ring", "Pinky", "A_Pinky"};
+
+static int Check(const char *path, int quiet)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == NULL)
+    {
+        perror(path);
+        return 0;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    // uint16_t storage keeps the header fields aligned, as in flash
+    uint16_t *blob = malloc((size > 0) ? size + 1 : 2);
+    size_t length = fread(blob, 1, size, f);
+    fclose(f);
+
+    Lesson_t lesson;
+    if (Lesson_FromBlob((const uint8_t *)blob, (uint32_t)length, &lesson) != 1)
+    {
+        fprintf(stderr, "%s: rejected\n", path);
+        free(blob);
+        return 0;
+    }
+
+    uint32_t total_ms = 0;
+    for (uint16_t i = 0; i < lesson.numSteps; i++)
+    {
+        const LessonStep_t *step = &lesson.steps[i];
+        total_ms += Lesson_StepMs(&lesson, step);
+        if (!quiet)
+        {
+            printf("%4u  %-2s%u  %-7s %3u ticks %5lu ms\n", i, NOTE_NAMES[step->note], step->octave,
+                   FINGER_NAMES[step->finger], step->ticks, (unsigned long)Lesson_StepMs(&lesson, step));
+        }
+    }
+    printf("%s: \"%s\", %u bpm, %u steps, %lu.%03lu s\n", path, lesson.name, lesson.tempo_bpm, lesson.numSteps,
+           (unsigned long)(total_ms / 1000), (unsigned long)(total_ms % 1000));
+    free(blob);
+    return 1;
+}
+
+int main(int argc, char **argv)
+{
+    int quiet = 0, files = 0, bad = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--quiet") == 0)
+        {
+            quiet = 1;
+        }
+    }
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--quiet") != 0)
+        {
+            files++;
+            bad += !Check(argv[i], quiet);
+        }
+    }
+    if (files == 0)
+    {
+        fprintf(stderr, "usage: %s lesson.bin... [--quiet]\n", argv[0]);
+        return 1;
+    }
+    return (bad == 0) ? 0 : 2;
+}
@@ -0,0 +1,206 @@
+import sys
+import struct
+import argparse
+
+# Converts a Standard MIDI File into the firmware lesson format (see
+# professorpiano/include/Lesson.h), as a step table for Lessons.c or as a
+# binary blob for Lesson_FromBlob():
+#
+#   python midi2lesson.py song.mid --name "Ode to Joy" > ode.c
+#   python midi2lesson.py song.mid --name "Ode to Joy" --blob ode.bin
+#
+# The melody is the top voice of one track (by default the one with the
+# most notes): chords keep their highest note. Each step lasts until the next
+# note starts, so rests lengthen the note before them. Fingers come from the
+# NOTE_MAP hand layout, where every note of the B..A# window has one finger;
+# leaving the window is an octave shift, made with the IMU twist. The song is
+# moved by whole octaves so its most common octave is STARTING_OCTAVE, or
+# with --fold every note is put into that one octave and no shifts are left.
+
+LESSON_MAGIC = b"PPL1"
+LESSON_NAME_LENGTH = 16
+LESSON_TICKS_PER_BEAT = 4
+LESSON_MAX_OCTAVE = 7
+LESSON_MIN_OCTAVE = 1              # Lowest row of NOTE_FREQUENCIES in Piezo_File.c
+STARTING_OCTAVE = 4                # ImuGesture.h
+HEADER_FORMAT = "<4sHH%ds" % LESSON_NAME_LENGTH
+STEP_FORMAT = "<BBBB"              # note, octave, finger, ticks
+
+# Note_t order: an octave row starts at the B below its C
+NOTE_NAMES = ["Note_B", "Note_C", "Note_Cs", "Note_D", "Note_Ds", "Note_E",
+              "Note_F", "Note_Fs", "Note_G", "Note_Gs", "Note_A", "Note_As"]
+
+# NOTE_MAP in Piezo_File.c: Finger_t -> (white key, black key)
+FINGER_NAMES = {1: "B_Thumb", 2: "Thumb", 3: "Index", 4: "Middle", 5: "Ring", 6: "Pinky", 7: "A_Pinky"}
+NOTE_MAP = {
+    1: ("Note_B", "Note_B"),
+    2: ("Note_C", "Note_Cs"),
+    3: ("Note_D", "Note_Ds"),
+    4: ("Note_E", "Note_E"),
+    5: ("Note_F", "Note_Fs"),
+    6: ("Note_G", "Note_Gs"),
+    7: ("Note_A", "Note_As"),
+}
+FINGER_FOR_NOTE = {NOTE_NAMES.index(n): f for f, keys in NOTE_MAP.items() for n in keys}
+
+
+def read_var(data, pos):
+    value = 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        value = (value << 7) | (byte & 0x7F)
+        if not byte & 0x80:
+            return value, pos
+
+
+def read_midi(path):
+    """Returns (ticks per quarter, [track]); a track is a dict of name, notes [(tick, key)],
+    tempos [(tick, us)] and end (tick of the last event)."""
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:4] != b"MThd":
+        sys.exit(f"{path}: not a Standard MIDI File")
+    length, fmt, num_tracks, division = struct.unpack_from(">IHHH", data, 4)
+    if division & 0x8000:
+        sys.exit(f"{path}: SMPTE time division is not supported")
+    if fmt == 2:
+        sys.exit(f"{path}: format 2 (independent sequences) is not supported")
+
+    tracks = []
+    pos = 8 + length
+    while len(tracks) < num_tracks and pos + 8 <= len(data):
+        chunk, length = struct.unpack_from(">4sI", data, pos)
+        pos += 8
+        end = pos + length
+        if chunk != b"MTrk":
+            pos = end
+            continue
+        track = {"name": "", "notes": [], "tempos": [], "end": 0}
+        tick = 0
+        status = 0
+        while pos < end:
+            delta, pos = read_var(data, pos)
+            tick += delta
+            if data[pos] & 0x80:
+                status = data[pos]
+                pos += 1
+            if status == 0xFF:
+                kind = data[pos]
+                length, pos = read_var(data, pos + 1)
+                if kind == 0x51 and length == 3:
+                    track["tempos"].append((tick, int.from_bytes(data[pos:pos + 3], "big")))
+                elif kind == 0x03:
+                    track["name"] = data[pos:pos + length].decode("latin-1")
+                elif kind == 0x2F:
+                    pos += length
+                    break
+                pos += length
+                status = 0              # Meta and sysex cancel running status
+            elif status in (0xF0, 0xF7):
+                length, pos = read_var(data, pos)
+                pos += length
+                status = 0
+            else:
+                kind = status & 0xF0
+                size = 1 if kind in (0xC0, 0xD0) else 2
+                if kind == 0x90 and data[pos + 1] > 0 and (status & 0x0F) != 9:     # Channel 10 is drums
+                    track["notes"].append((tick, data[pos]))
+                pos += size
+        track["end"] = tick
+        tracks.append(track)
+        pos = end
+    return division, tracks
+
+
+def melody(notes):
+    """Top voice: one note per onset tick, the highest."""
+    top = {}
+    for tick, key in notes:
+        top[tick] = max(top.get(tick, 0), key)
+    return sorted(top.items())
+
+
+def to_lesson(key, shift):
+    """MIDI key -> (Note_t, octave) in the firmware's B-first octave rows."""
+    key += 1 + 12 * shift
+    return key % 12, key // 12 - 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Standard MIDI File to lesson steps")
+    parser.add_argument("midi")
+    parser.add_argument("--name", help="lesson name, at most %d characters" % (LESSON_NAME_LENGTH - 1))
+    parser.add_argument("--track", type=int, help="track index (default: the one with the most notes)")
+    parser.add_argument("--transpose", type=int, default=0, help="semitones, before fingering")
+    parser.add_argument("--fold", action="store_true", help="play everything in one octave, no shifts")
+    parser.add_argument("--blob", help="write a binary blob here instead of C")
+    parser.add_argument("--symbol", help="C array name (default from --name)")
+    args = parser.parse_args()
+
+    division, tracks = read_midi(args.midi)
+    if args.track is None:
+        args.track = max(range(len(tracks)), key=lambda t: len(tracks[t]["notes"]))
+    if not 0 <= args.track < len(tracks) or not tracks[args.track]["notes"]:
+        sys.exit(f"{args.midi}: no notes in track {args.track}")
+    track = tracks[args.track]
+    name = args.name or track["name"] or "Untitled"
+    if len(name) >= LESSON_NAME_LENGTH:
+        sys.exit(f"name '{name}' is longer than {LESSON_NAME_LENGTH - 1} characters")
+
+    # Format 1 keeps the tempo map in track 0; the first tempo counts
+    tempos = sorted(t for tr in tracks for t in tr["tempos"])
+    tempo_us = tempos[0][1] if tempos else 500000
+    if len(set(us for _, us in tempos)) > 1:
+        print(f"warning: tempo changes ignored, using {60e6 / tempo_us:.0f} bpm", file=sys.stderr)
+    tempo_bpm = max(1, round(60e6 / tempo_us))
+
+    onsets = [(tick, key + args.transpose) for tick, key in melody(track["notes"])]
+
+    # Whole-octave shift that puts the most common octave at STARTING_OCTAVE
+    octaves = [to_lesson(key, 0)[1] for _, key in onsets]
+    shift = STARTING_OCTAVE - max(set(octaves), key=octaves.count)
+
+    steps = []
+    clamped = 0
+    for i, (tick, key) in enumerate(onsets):
+        # The last note runs to the end of the track
+        end = onsets[i + 1][0] if i + 1 < len(onsets) else max(track["end"], tick + division // LESSON_TICKS_PER_BEAT)
+        length = end - tick
+        ticks = round(length * LESSON_TICKS_PER_BEAT / division)
+        if not 1 <= ticks <= 255:
+            clamped += 1
+            ticks = min(255, max(1, ticks))
+        note, octave = to_lesson(key, shift)
+        if args.fold:
+            octave = STARTING_OCTAVE
+        if not LESSON_MIN_OCTAVE <= octave <= LESSON_MAX_OCTAVE:
+            clamped += 1
+            octave = min(LESSON_MAX_OCTAVE, max(LESSON_MIN_OCTAVE, octave))
+        steps.append((note, octave, FINGER_FOR_NOTE[note], ticks))
+
+    if len(steps) > 0xFFFF:
+        sys.exit(f"{len(steps)} steps do not fit a lesson")
+    shifts = sum(1 for a, b in zip(steps, steps[1:]) if a[1] != b[1])
+    print(f"{name}: {len(steps)} steps from track {args.track}, {tempo_bpm} bpm, octave shift {shift:+d}, "
+          f"{shifts} octave changes while playing, {clamped} values clamped", file=sys.stderr)
+
+    if args.blob:
+        with open(args.blob, "wb") as out:
+            out.write(struct.pack(HEADER_FORMAT, LESSON_MAGIC, tempo_bpm, len(steps), name.encode("latin-1")))
+            for step in steps:
+                out.write(struct.pack(STEP_FORMAT, *step))
+        return
+
+    symbol = args.symbol or "".join(c if c.isalnum() else "_" for c in name.upper())
+    print(f"// {name}: generated by lesson_tool/midi2lesson.py from {args.midi.split('/')[-1]}")
+    print(f"static const LessonStep_t {symbol}[] = {{")
+    for note, octave, finger, ticks in steps:
+        print(f"    {{{NOTE_NAMES[note]}, {octave}, {FINGER_NAMES[finger]}, {ticks}}},")
+    print("};")
+    print()
+    print("// LESSONS[] entry:")
+    print(f'//  {{"{name}", {tempo_bpm}, sizeof({symbol}) / sizeof(LessonStep_t), {symbol}}},')
+
+
+main()
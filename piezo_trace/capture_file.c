@@ -0,0 +1,82 @@
+/**
+ * @file    capture_file.c
+ *
+ * Loader for binary piezo captures shared by the piezo_trace host tools.
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    7 Mar 2025
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "capture_file.h"
+
+static uint16_t FrameChecksum(const PiezoCaptureFrame_t *frame)
+{
+    const uint8_t *bytes = (const uint8_t *)frame;
+    uint16_t sum = 0;
+    for (size_t i = 0; i < sizeof(PiezoCaptureFrame_t) - sizeof(frame->checksum); i++)
+    {
+        sum += bytes[i];
+    }
+    return sum;
+}
+
+/**
+ * Scan a raw byte stream for valid frames, resyncing on the sync word.
+ */
+size_t CaptureFile_Load(const char *path, PiezoCaptureFrame_t **framesOut, uint32_t *badFrames, uint32_t *lostFrames)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == NULL)
+    {
+        perror(path);
+        return 0;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *raw = malloc(size > 0 ? size : 1);
+    if (fread(raw, 1, size, f) != (size_t)size)
+    {
+        fclose(f);
+        free(raw);
+        return 0;
+    }
+    fclose(f);
+
+    PiezoCaptureFrame_t *frames = malloc((size / sizeof(PiezoCaptureFrame_t) + 1) * sizeof(PiezoCaptureFrame_t));
+    size_t count = 0;
+    long offset = 0;
+    *badFrames = 0;
+    *lostFrames = 0;
+
+    while (offset + (long)sizeof(PiezoCaptureFrame_t) <= size)
+    {
+        PiezoCaptureFrame_t frame;
+        memcpy(&frame, raw + offset, sizeof(frame));
+        if (frame.sync != PIEZO_CAPTURE_SYNC)
+        {
+            offset++;
+            continue;
+        }
+        if (frame.checksum != FrameChecksum(&frame))
+        {
+            (*badFrames)++;
+            offset++;
+            continue;
+        }
+        if (count > 0)
+        {
+            uint16_t gap = (uint16_t)(frame.sequence - frames[count - 1].sequence);
+            *lostFrames += gap - 1;
+        }
+        frames[count++] = frame;
+        offset += sizeof(frame);
+    }
+    free(raw);
+    *framesOut = frames;
+    return count;
+}
@@ -0,0 +1,26 @@
+/**
+ * @file    capture_file.h
+ *
+ * Loader for binary piezo captures shared by the piezo_trace host tools.
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    7 Mar 2025
+ */
+
+#ifndef CAPTURE_FILE_H
+#define CAPTURE_FILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <PiezoCapture.h>
+
+/**
+ * Reads every valid frame of a capture, resyncing on PIEZO_CAPTURE_SYNC.
+ * Frames with a bad checksum are counted in badFrames; sequence gaps between
+ * valid frames are counted in lostFrames. The caller frees *framesOut.
+ * Returns the number of valid frames.
+ */
+size_t CaptureFile_Load(const char *path, PiezoCaptureFrame_t **framesOut, uint32_t *badFrames, uint32_t *lostFrames);
+
+#endif // CAPTURE_FILE_H
@@ -0,0 +1,284 @@
+/**
+ * @file    decimate_bench.c
+ *
+ * Host benchmark of the firmware decimator (Decimator.c) on raw captures
+ * recorded with PIEZO_CAPTURE + PIEZO_CAPTURE_RAW:
+ *
+ *   gcc -O2 -I../professorpiano/include -o decimate_bench \
+ *       decimate_bench.c capture_file.c ../professorpiano/src/Decimator.c -lm
+ *
+ * Usage:
+ *   ./decimate_bench raw.bin [--shift N] [--order N] [--repeat N] [--quiet N]
+ *
+ *   --shift N   log2 of the decimation factor (default ADC_OVERSAMPLE_SHIFT, 3)
+ *   --order N   1 = boxcar, 2..3 = CIC (default 2)
+ *   --repeat N  filter the trace N times for a stable throughput figure
+ *   --quiet N   a burst counts as idle on a channel when its raw range is at
+ *               most N LSB (default 40); noise is only measured on idle bursts
+ *
+ * The raw stream arrives in bursts (the UART is slower than the scan rate),
+ * so the trace is split on timestamp gaps and every burst is filtered from a
+ * cleared decimator. Noise is the standard deviation about the burst mean, in
+ * 12-bit LSB; effective bits = 12 - log2(sigma * sqrt(12)).
+ *
+ * The gains quoted so far (~1.6 bits boxcar, ~2 bits order 2 at 8x) come from
+ * synthetic white noise, which is the filter's best case; piezo pickup and
+ * mains hum are not white, so a board capture will show less.
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    7 Mar 2025
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <Decimator.h>
+#include "capture_file.h"
+
+#define ADC_BITS 12
+
+typedef struct
+{
+    size_t first;
+    size_t count;
+} Burst_t;
+
+typedef struct
+{
+    double rawSquares;
+    size_t rawSamples;
+    double decSquares;
+    size_t decSamples;
+} Noise_t;
+
+/**
+ * Split the trace wherever consecutive timestamps are further apart than
+ * 1.5 scan periods. The scan period is the smallest positive step seen.
+ */
+static size_t FindBursts(const PiezoCaptureFrame_t *frames, size_t count, Burst_t *bursts)
+{
+    uint32_t period = UINT32_MAX;
+    for (size_t n = 1; n < count; n++)
+    {
+        uint32_t step = frames[n].timestamp_us - frames[n - 1].timestamp_us;
+        if (step > 0 && step < period)
+        {
+            period = step;
+        }
+    }
+
+    size_t numBursts = 0;
+    bursts[0].first = 0;
+    for (size_t n = 1; n <= count; n++)
+    {
+        if (n == count || (frames[n].timestamp_us - frames[n - 1].timestamp_us) * 2 > period * 3)
+        {
+            bursts[numBursts].count = n - bursts[numBursts].first;
+            numBursts++;
+            if (n < count)
+            {
+                bursts[numBursts].first = n;
+            }
+        }
+    }
+    return numBursts;
+}
+
+static void Deinterleave(const PiezoCaptureFrame_t *frames, size_t count, uint16_t *samples)
+{
+    for (size_t n = 0; n < count; n++)
+    {
+        memcpy(&samples[n * PIEZO_CAPTURE_CHANNELS], frames[n].adc, sizeof(frames[n].adc));
+    }
+}
+
+// Decimator_Process() takes a 16-bit frame count, feed long bursts in pieces
+static size_t Decimate(Decimator_t *dec, const uint16_t *in, size_t inFrames, uint16_t *out)
+{
+    size_t produced = 0;
+    while (inFrames > 0)
+    {
+        uint16_t chunk = (inFrames > 0x8000) ? 0x8000 : (uint16_t)inFrames;
+        produced += Decimator_Process(dec, in, chunk, &out[produced * PIEZO_CAPTURE_CHANNELS]);
+        in += (size_t)chunk * PIEZO_CAPTURE_CHANNELS;
+        inFrames -= chunk;
+    }
+    return produced;
+}
+
+static double SumSquares(const double *values, size_t count)
+{
+    double mean = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        mean += values[i];
+    }
+    mean /= count;
+    double squares = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        squares += (values[i] - mean) * (values[i] - mean);
+    }
+    return squares;
+}
+
+static double EffectiveBits(double sigma)
+{
+    return ADC_BITS - log2(sigma * sqrt(12.0));
+}
+
+int main(int argc, char **argv)
+{
+    const char *capturePath = NULL;
+    int shift = 3;
+    int order = 2;
+    int repeat = 1;
+    int quiet = 40;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--shift") == 0 && i + 1 < argc)
+        {
+            shift = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--order") == 0 && i + 1 < argc)
+        {
+            order = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+        {
+            repeat = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--quiet") == 0 && i + 1 < argc)
+        {
+            quiet = atoi(argv[++i]);
+        }
+        else
+        {
+            capturePath = argv[i];
+        }
+    }
+    if (capturePath == NULL || repeat < 1 || shift < 0 || shift > 6 || order < 1 || order > DECIMATOR_MAX_ORDER)
+    {
+        fprintf(stderr, "usage: %s raw.bin [--shift N] [--order N] [--repeat N] [--quiet N]\n", argv[0]);
+        return 1;
+    }
+
+    PiezoCaptureFrame_t *frames = NULL;
+    uint32_t badFrames, lostFrames;
+    size_t numFrames = CaptureFile_Load(capturePath, &frames, &badFrames, &lostFrames);
+    if (numFrames == 0)
+    {
+        fprintf(stderr, "no valid frames in %s\n", capturePath);
+        return 1;
+    }
+
+    Burst_t *bursts = malloc(numFrames * sizeof(Burst_t));
+    size_t numBursts = FindBursts(frames, numFrames, bursts);
+    uint16_t *samples = malloc(numFrames * PIEZO_CAPTURE_CHANNELS * sizeof(uint16_t));
+    uint16_t *decimated = malloc(numFrames * PIEZO_CAPTURE_CHANNELS * sizeof(uint16_t));
+    Deinterleave(frames, numFrames, samples);
+
+    // Throughput at firmware settings (no fractional bits kept)
+    Decimator_t dec;
+    size_t outFrames = 0;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int r = 0; r < repeat; r++)
+    {
+        outFrames = 0;
+        for (size_t b = 0; b < numBursts; b++)
+        {
+            Decimator_Init(&dec, PIEZO_CAPTURE_CHANNELS, (uint8_t)shift, (uint8_t)order, 0);
+            outFrames += Decimate(&dec, &samples[bursts[b].first * PIEZO_CAPTURE_CHANNELS],
+                                  bursts[b].count, &decimated[outFrames * PIEZO_CAPTURE_CHANNELS]);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double elapsed_ns = (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+
+    // Noise on idle bursts, with fractional bits kept so the gain is visible
+    Noise_t noise[PIEZO_CAPTURE_CHANNELS] = {0};
+    double *values = malloc(numFrames * sizeof(double));
+    uint8_t extraBits = (order * shift < DECIMATOR_MAX_EXTRA) ? order * shift : DECIMATOR_MAX_EXTRA;
+    for (size_t b = 0; b < numBursts; b++)
+    {
+        const uint16_t *in = &samples[bursts[b].first * PIEZO_CAPTURE_CHANNELS];
+        Decimator_Init(&dec, PIEZO_CAPTURE_CHANNELS, (uint8_t)shift, (uint8_t)order, extraBits);
+        size_t produced = Decimate(&dec, in, bursts[b].count, decimated);
+        if (produced <= (size_t)order + 1)
+        {
+            continue; // Too short once the CIC has settled
+        }
+
+        for (int c = 0; c < PIEZO_CAPTURE_CHANNELS; c++)
+        {
+            uint16_t lo = UINT16_MAX, hi = 0;
+            for (size_t n = 0; n < bursts[b].count; n++)
+            {
+                uint16_t v = in[n * PIEZO_CAPTURE_CHANNELS + c];
+                lo = (v < lo) ? v : lo;
+                hi = (v > hi) ? v : hi;
+            }
+            if (hi - lo > quiet)
+            {
+                continue;
+            }
+
+            for (size_t n = 0; n < bursts[b].count; n++)
+            {
+                values[n] = in[n * PIEZO_CAPTURE_CHANNELS + c];
+            }
+            noise[c].rawSquares += SumSquares(values, bursts[b].count);
+            noise[c].rawSamples += bursts[b].count;
+
+            // The first order outputs still contain the cleared state
+            size_t settled = produced - order;
+            for (size_t n = 0; n < settled; n++)
+            {
+                values[n] = decimated[(n + order) * PIEZO_CAPTURE_CHANNELS + c] / (double)(1 << extraBits);
+            }
+            noise[c].decSquares += SumSquares(values, settled);
+            noise[c].decSamples += settled;
+        }
+    }
+
+    double duration_s = (frames[numFrames - 1].timestamp_us - frames[0].timestamp_us) / 1e6;
+    fprintf(stderr, "frames:      %zu in %zu bursts (%u corrupt, %u lost, %.3f s)\n",
+            numFrames, numBursts, badFrames, lostFrames, duration_s);
+    fprintf(stderr, "decimator:   %dx, order %d -> %zu frames\n", 1 << shift, order, outFrames);
+    fprintf(stderr, "throughput:  %.2f ns/raw frame, %.2f ns/sample over %d pass(es)\n",
+            elapsed_ns / ((double)numFrames * repeat),
+            elapsed_ns / ((double)numFrames * PIEZO_CAPTURE_CHANNELS * repeat), repeat);
+
+    printf("channel,idle_samples,sigma_raw,sigma_dec,enob_raw,enob_dec,gain_bits\n");
+    for (int c = 0; c < PIEZO_CAPTURE_CHANNELS; c++)
+    {
+        if (noise[c].rawSamples < 2 || noise[c].decSamples < 2)
+        {
+            printf("%d,%zu,,,,,\n", c, noise[c].rawSamples);
+            continue;
+        }
+        double sigmaRaw = sqrt(noise[c].rawSquares / (noise[c].rawSamples - 1));
+        double sigmaDec = sqrt(noise[c].decSquares / (noise[c].decSamples - 1));
+        if (sigmaRaw == 0 || sigmaDec == 0)
+        {
+            // Pinned at a rail, nothing to measure
+            printf("%d,%zu,%.3f,%.3f,,,\n", c, noise[c].rawSamples, sigmaRaw, sigmaDec);
+            continue;
+        }
+        printf("%d,%zu,%.3f,%.3f,%.2f,%.2f,%.2f\n", c, noise[c].rawSamples, sigmaRaw, sigmaDec,
+               EffectiveBits(sigmaRaw), EffectiveBits(sigmaDec), log2(sigmaRaw / sigmaDec));
+    }
+
+    free(values);
+    free(decimated);
+    free(samples);
+    free(bursts);
+    free(frames);
+    return 0;
+}
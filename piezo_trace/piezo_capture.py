@@ -0,0 +1,43 @@
+import sys
+import time
+import struct
+import serial  # pip install pyserial
+
+# Records the binary stream produced by the PIEZO_CAPTURE build of the firmware
+# (see professorpiano/include/PiezoCapture.h) into a file for piezo_replay.
+#
+#   python piezo_capture.py COM5 capture.bin 30     (port, output, seconds)
+
+CAPTURE_BAUDRATE = 921600          # PIEZO_CAPTURE_BAUDRATE
+FRAME_FORMAT = "<HHI7HH"            # sync, sequence, timestamp_us, adc[7], checksum
+FRAME_SIZE = struct.calcsize(FRAME_FORMAT)
+SYNC = 0xA55A
+
+port = sys.argv[1]
+out_name = sys.argv[2] if len(sys.argv) > 2 else "capture.bin"
+seconds = float(sys.argv[3]) if len(sys.argv) > 3 else 10.0
+
+with serial.Serial(port, CAPTURE_BAUDRATE, timeout=0.1) as ser, open(out_name, "wb") as out:
+    ser.reset_input_buffer()
+    total = 0
+    end = time.time() + seconds
+    while time.time() < end:
+        chunk = ser.read(4096)
+        if chunk:
+            out.write(chunk)
+            total += len(chunk)
+
+# Quick sanity check of what was written
+with open(out_name, "rb") as f:
+    data = f.read()
+frames = 0
+offset = 0
+while offset + FRAME_SIZE <= len(data):
+    fields = struct.unpack_from(FRAME_FORMAT, data, offset)
+    if fields[0] == SYNC and (sum(data[offset:offset + FRAME_SIZE - 2]) & 0xFFFF) == fields[-1]:
+        frames += 1
+        offset += FRAME_SIZE
+    else:
+        offset += 1
+
+print(f"Captured {total} bytes ({frames} valid frames) to {out_name}")
@@ -0,0 +1,216 @@
+/**
+ * @file    piezo_replay.c
+ *
+ * Host-side replay of binary piezo captures (see piezo_capture.py) through the
+ * firmware's own detection core (PiezoDetect.c), compiled natively:
+ *
+ *   gcc -O2 -I../professorpiano/include -o piezo_replay \
+ *       piezo_replay.c capture_file.c ../professorpiano/src/PiezoDetect.c
+ *
+ * Usage:
+ *   ./piezo_replay capture.bin [--events] [--repeat N]
+ *                              [--expect labels.csv] [--tolerance-ms N]
+ *
+ *   --events        print every detected key press as CSV
+ *                   (timestamp_us,channel,peak,key)
+ *   --repeat N      run the detector over the trace N times for a stable
+ *                   throughput figure
+ *   --expect FILE   labelled presses, one "timestamp_ms,channel,key" per line
+ *                   (key = W or B); prints precision / recall of the detector
+ *   --tolerance-ms  matching window for --expect (default 30 ms)
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    6 Mar 2025
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <PiezoCapture.h>
+#include <PiezoDetect.h>
+#include "capture_file.h"
+
+#define MAX_EXPECTED 4096
+
+typedef struct
+{
+    uint32_t timestamp_us;
+    uint8_t channel;
+    uint16_t peak;
+    KeyType_t key;
+} KeyEvent_t;
+
+typedef struct
+{
+    uint32_t timestamp_us;
+    uint8_t channel;
+    KeyType_t key;
+    uint8_t matched;
+} ExpectedPress_t;
+
+static size_t LoadExpected(const char *path, ExpectedPress_t *expected)
+{
+    FILE *f = fopen(path, "r");
+    if (f == NULL)
+    {
+        perror(path);
+        return 0;
+    }
+    char line[128];
+    size_t count = 0;
+    while (fgets(line, sizeof(line), f) != NULL && count < MAX_EXPECTED)
+    {
+        unsigned long ms;
+        unsigned channel;
+        char key;
+        if (sscanf(line, "%lu,%u,%c", &ms, &channel, &key) != 3)
+        {
+            continue; // header or comment
+        }
+        expected[count].timestamp_us = (uint32_t)(ms * 1000);
+        expected[count].channel = (uint8_t)channel;
+        expected[count].key = (key == 'B' || key == 'b') ? BLACK_KEY : WHITE_KEY;
+        expected[count].matched = 0;
+        count++;
+    }
+    fclose(f);
+    return count;
+}
+
+/**
+ * Run the detector over every frame exactly like the freeplay main loop does
+ * (channel i is passed as (Finger_t)i). Returns the number of events found.
+ */
+static size_t Replay(const PiezoCaptureFrame_t *frames, size_t count, KeyEvent_t *events, size_t maxEvents)
+{
+    size_t numEvents = 0;
+    PiezoDetect_Reset();
+    for (size_t n = 0; n < count; n++)
+    {
+        for (int i = 0; i < PIEZO_CAPTURE_CHANNELS; i++)
+        {
+            uint16_t peak = PiezoDetect_Update(frames[n].adc[i], (Finger_t)i, frames[n].timestamp_us);
+            if (peak == 0)
+            {
+                continue;
+            }
+            KeyType_t key = PiezoDetect_Classify(peak, (Finger_t)i);
+            if ((key != INVALID_KEY) && (numEvents < maxEvents))
+            {
+                events[numEvents].timestamp_us = frames[n].timestamp_us;
+                events[numEvents].channel = (uint8_t)i;
+                events[numEvents].peak = peak;
+                events[numEvents].key = key;
+                numEvents++;
+            }
+        }
+    }
+    return numEvents;
+}
+
+int main(int argc, char **argv)
+{
+    const char *capturePath = NULL;
+    const char *expectPath = NULL;
+    int printEvents = 0;
+    int repeat = 1;
+    uint32_t tolerance_us = 30000;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--events") == 0)
+        {
+            printEvents = 1;
+        }
+        else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+        {
+            repeat = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--expect") == 0 && i + 1 < argc)
+        {
+            expectPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--tolerance-ms") == 0 && i + 1 < argc)
+        {
+            tolerance_us = (uint32_t)atoi(argv[++i]) * 1000;
+        }
+        else
+        {
+            capturePath = argv[i];
+        }
+    }
+    if (capturePath == NULL || repeat < 1)
+    {
+        fprintf(stderr, "usage: %s capture.bin [--events] [--repeat N] [--expect labels.csv] [--tolerance-ms N]\n", argv[0]);
+        return 1;
+    }
+
+    PiezoCaptureFrame_t *frames = NULL;
+    uint32_t badFrames, lostFrames;
+    size_t numFrames = CaptureFile_Load(capturePath, &frames, &badFrames, &lostFrames);
+    if (numFrames == 0)
+    {
+        fprintf(stderr, "no valid frames in %s\n", capturePath);
+        return 1;
+    }
+
+    KeyEvent_t *events = malloc(numFrames * PIEZO_CAPTURE_CHANNELS * sizeof(KeyEvent_t));
+    size_t numEvents = 0;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int r = 0; r < repeat; r++)
+    {
+        numEvents = Replay(frames, numFrames, events, numFrames * PIEZO_CAPTURE_CHANNELS);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double elapsed_ns = (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+
+    if (printEvents)
+    {
+        printf("timestamp_us,channel,peak,key\n");
+        for (size_t e = 0; e < numEvents; e++)
+        {
+            printf("%u,%u,%u,%c\n", events[e].timestamp_us, events[e].channel, events[e].peak,
+                   events[e].key == WHITE_KEY ? 'W' : 'B');
+        }
+    }
+
+    double duration_s = (frames[numFrames - 1].timestamp_us - frames[0].timestamp_us) / 1e6;
+    fprintf(stderr, "frames:      %zu (%u corrupt, %u lost)\n", numFrames, badFrames, lostFrames);
+    fprintf(stderr, "duration:    %.3f s (%.0f frames/s)\n", duration_s, duration_s > 0 ? numFrames / duration_s : 0.0);
+    fprintf(stderr, "key presses: %zu\n", numEvents);
+    fprintf(stderr, "throughput:  %.1f ns/frame over %d pass(es)\n", elapsed_ns / ((double)numFrames * repeat), repeat);
+
+    if (expectPath != NULL)
+    {
+        static ExpectedPress_t expected[MAX_EXPECTED];
+        size_t numExpected = LoadExpected(expectPath, expected);
+        size_t truePositives = 0;
+        for (size_t e = 0; e < numEvents; e++)
+        {
+            for (size_t x = 0; x < numExpected; x++)
+            {
+                uint32_t delta = (events[e].timestamp_us > expected[x].timestamp_us)
+                                     ? events[e].timestamp_us - expected[x].timestamp_us
+                                     : expected[x].timestamp_us - events[e].timestamp_us;
+                if (!expected[x].matched && expected[x].channel == events[e].channel &&
+                    expected[x].key == events[e].key && delta <= tolerance_us)
+                {
+                    expected[x].matched = 1;
+                    truePositives++;
+                    break;
+                }
+            }
+        }
+        fprintf(stderr, "expected:    %zu\n", numExpected);
+        fprintf(stderr, "precision:   %.3f\n", numEvents ? (double)truePositives / numEvents : 0.0);
+        fprintf(stderr, "recall:      %.3f\n", numExpected ? (double)truePositives / numExpected : 0.0);
+    }
+
+    free(events);
+    free(frames);
+    return 0;
+}
@@ -0,0 +1,92 @@
+import sys
+import math
+import random
+import struct
+
+# Writes a synthetic labelled capture in the PIEZO_CAPTURE stream format (see
+# professorpiano/include/PiezoCapture.h) plus its labels for piezo_replay,
+# until a labelled board capture exists:
+#
+#   python piezo_synth.py traces/synth_01 5 1      (output prefix, seconds, seed)
+#   ./piezo_replay traces/synth_01.bin --expect traces/synth_01.csv
+#
+# Frames are decimated ADC_FRAME_RATE_HZ frames, like the default capture. A
+# press is a fast rise into a damped ring, so the detector's peak tracking,
+# holdoff and repeat presses get exercised. The press heights are drawn inside
+# the PiezoDetect.c threshold bands, so the trace cannot say anything about
+# whether those thresholds fit real presses; only a board capture can.
+#
+# Labels are "timestamp_ms,channel,key" with channel as piezo_replay numbers
+# it (capture channel i is fed as Finger_t i, so channel 0 never classifies).
+
+FRAME_FORMAT = "<HHI7HH"            # sync, sequence, timestamp_us, adc[7], checksum
+SYNC = 0xA55A
+FRAME_US = 500                      # PIEZO_CAPTURE_PERIOD_US
+CHANNELS = 7
+BASELINE = 8                        # Idle reading in LSB
+NOISE_LSB = 3
+RISE_US = 3000
+DECAY_US = 6000
+RING_HZ = 180
+REPEAT_GAP_US = 60000               # Closest repeat on one finger, twice PIEZO_HOLDOFF_US
+
+# PiezoThresholds in PiezoDetect.c, indexed like the replay (channel = Finger_t)
+THRESHOLDS = [None, (50, 110), (60, 130), (50, 60), (70, 300), (50, 170), (55, 80)]
+
+out_prefix = sys.argv[1]
+seconds = float(sys.argv[2]) if len(sys.argv) > 2 else 5.0
+random.seed(int(sys.argv[3]) if len(sys.argv) > 3 else 1)
+
+num_frames = int(seconds * 1e6 / FRAME_US)
+start_us = random.randint(0, 1000000) * FRAME_US
+signal = [[0.0] * num_frames for _ in range(CHANNELS)]
+labels = []
+
+
+def press(channel, at_us, height):
+    """Rise by height over RISE_US, then a decaying ring."""
+    first = at_us // FRAME_US
+    for n in range(first, num_frames):
+        t = (n - first) * FRAME_US
+        if t < RISE_US:
+            value = height * math.sin(math.pi / 2 * t / RISE_US)
+        else:
+            td = t - RISE_US
+            value = height * math.exp(-td / DECAY_US) * math.cos(2 * math.pi * RING_HZ * td / 1e6)
+            if td > 8 * DECAY_US:
+                break
+        signal[channel][n] += value
+
+
+t_us = 200000
+last_press = [-REPEAT_GAP_US] * CHANNELS
+while t_us < seconds * 1e6 - 200000:
+    channel = random.randint(1, CHANNELS - 1)
+    if t_us - last_press[channel] < REPEAT_GAP_US:
+        t_us += REPEAT_GAP_US
+        continue
+    black, white = THRESHOLDS[channel]
+    if random.random() < 0.5:
+        key, height = "W", white + random.uniform(10, 120)
+    else:
+        # Keep clear of both edges by about the noise
+        key, height = "B", random.uniform(black + 3, white - 3)
+        if height <= black + 3:
+            continue
+    press(channel, t_us, height - BASELINE)
+    labels.append((start_us + t_us + RISE_US, channel, key))
+    last_press[channel] = t_us
+    t_us += random.choice([REPEAT_GAP_US, random.randint(100000, 400000)])
+
+with open(out_prefix + ".bin", "wb") as out:
+    for n in range(num_frames):
+        adc = [max(0, min(4095, int(round(BASELINE + signal[c][n] + random.gauss(0, NOISE_LSB)))))
+               for c in range(CHANNELS)]
+        body = struct.pack(FRAME_FORMAT[:-1], SYNC, n & 0xFFFF, (start_us + n * FRAME_US) & 0xFFFFFFFF, *adc)
+        out.write(body + struct.pack("<H", sum(body) & 0xFFFF))
+
+with open(out_prefix + ".csv", "w") as out:
+    out.write("timestamp_ms,channel,key\n")
+    for stamp, channel, key in labels:
+        out.write("%d,%d,%s\n" % (stamp // 1000, channel, key))
+print(f"Wrote {num_frames} frames and {len(labels)} presses to {out_prefix}.bin/.csv")
@@ -9,11 +9,11 @@
  *
  * @date    16 Sep 2023
  *
- * @TODO    Switch to an interrupt-driven ADC framework that uses DMA to read/
- *          store data from each of the 7 channels when triggered. This special
- *          approach is required since the ADC SFRs are not labeled by channel,
- *          i.e. otherwise we cannot tell which ADC value was read by which
- *          ADC channel (values are mixed up).
+ * The 7 piezo channels are converted as one scan sequence triggered by TIM3
+ * at ADC_OVERSAMPLE times ADC_FRAME_RATE_HZ. DMA2 Stream0 writes every
+ * sequence into a circular raw buffer; each completed half is decimated
+ * (see Decimator.h) into a history of frames at ADC_FRAME_RATE_HZ, so each
+ * slot is labelled by its rank and reads never block.
  */
 
  //Changed ADC file to include ADC_CHANNEL_6 which is set at the switch, can cheese the system to get another ADC if we put the switch floating instead of on or off
@@ -52,6 +52,21 @@
 #define ADC_MIN             0
 #define ADC_MAX             4095
 
+// Scan sequence, rank order = finger order used by the piezo code.
+#define ADC_SCAN_SEQUENCE   {ADC_6, ADC_0, ADC_1, ADC_2, ADC_3, ADC_4, ADC_5}
+
+#define ADC_FRAME_RATE_HZ       2000    // Decimated frames per second (detector rate)
+#define ADC_OVERSAMPLE_SHIFT    3       // 8x hardware oversampling, 0 disables it
+#define ADC_OVERSAMPLE          (1 << ADC_OVERSAMPLE_SHIFT)
+#define ADC_DECIMATOR_ORDER     2       // 1 = boxcar, 2 = sinc^2 CIC
+#define ADC_SCAN_RATE_HZ        (ADC_FRAME_RATE_HZ * ADC_OVERSAMPLE)    // TIM3 TRGO
+#define ADC_FRAME_PERIOD_US     (1000000UL / ADC_FRAME_RATE_HZ)
+
+#define ADC_BLOCK_FRAMES        8       // Decimated frames per half of the DMA buffer
+#define ADC_BLOCK_SCANS         (ADC_BLOCK_FRAMES * ADC_OVERSAMPLE)
+#define ADC_BUFFER_FRAMES       64      // Decimated history, multiple of ADC_BLOCK_FRAMES
+#define ADC_BUFFER_BLOCKS       (ADC_BUFFER_FRAMES / ADC_BLOCK_FRAMES)
+
 #ifndef FALSE
 #define FALSE ((int8_t) 0)
 #endif  /*  FALSE   */
@@ -87,17 +102,83 @@ int8_t ADC_End_2(void);
 
 /** ADC_Read(channel)
  *
- * Selects ADC channel and returns 12-bit reading.
+ * Returns the newest decimated 12-bit reading of a scanned channel.
+ * Constant time, never waits for a conversion.
  *
  * @param   channel (uint32_t)  Select ADC channel
- *                                  (ADC_0, ADC_1, ..., ADC_5, POT)
- * @return          (uint16_t)  12-bit ADC reading.
+ *                                  (ADC_0, ADC_1, ..., ADC_6)
+ * @return          (uint16_t)  12-bit ADC reading, 0 if the channel is not
+ *                              part of ADC_SCAN_SEQUENCE.
  */
 uint16_t ADC_Read_2(uint32_t channel);
 
+/** ADC_ReadBlock_2(channel, dest, count)
+ *
+ * Copies the newest count decimated readings of a scanned channel, oldest
+ * first.
+ *
+ * @param   channel (uint32_t)      Select ADC channel (ADC_0, ..., ADC_6)
+ * @param   dest    (uint16_t *)    Destination for count readings.
+ * @param   count   (uint16_t)      Number of readings, at most ADC_BUFFER_FRAMES.
+ * @return          (uint16_t)      Number of readings copied.
+ */
+uint16_t ADC_ReadBlock_2(uint32_t channel, uint16_t *dest, uint16_t count);
+
+/** ADC_GetBlock_2(block, firstFrame)
+ *
+ * Hands out every decimated block once, oldest first. A block holds
+ * ADC_BLOCK_FRAMES frames of ADC_NUM_CHANNELS readings in scan order. A
+ * consumer that falls behind gets the pending blocks still in the history,
+ * up to ADC_BUFFER_BLOCKS - 1 (28 ms); older ones are skipped and counted,
+ * see ADC_GetDroppedBlocks_2(). The block handed out stays valid for at least
+ * one more block period.
+ *
+ * @param   block       (const uint16_t **) Set to the first frame of the block.
+ * @param   firstFrame  (uint32_t *)        Set to the number of that frame
+ *                                          since ADC_Init_2().
+ * @return              (int8_t)            TRUE if a block was pending.
+ */
+int8_t ADC_GetBlock_2(const uint16_t **block, uint32_t *firstFrame);
+
+/** ADC_GetRawBlock_2(block, firstScan)
+ *
+ * Hands out the newest completed half of the raw DMA buffer once, before
+ * decimation: ADC_BLOCK_SCANS frames at ADC_SCAN_RATE_HZ. The DMA overwrites
+ * it again after ADC_BLOCK_SCANS / ADC_SCAN_RATE_HZ seconds.
+ *
+ * @param   block       (const uint16_t **) Set to the first scan of the block.
+ * @param   firstScan   (uint32_t *)        Set to the number of that scan
+ *                                          since ADC_Init_2().
+ * @return              (int8_t)            TRUE if a new block was available.
+ */
+int8_t ADC_GetRawBlock_2(const uint16_t **block, uint32_t *firstScan);
+
+/** ADC_GetDroppedBlocks_2()
+ *
+ * @return  (uint32_t)  Decimated blocks overwritten before ADC_GetBlock_2()
+ *                      handed them out.
+ */
+uint32_t ADC_GetDroppedBlocks_2(void);
+
+/** ADC_SetBlockCallback_2(callback)
+ *
+ * Registers a function called from the DMA interrupt every time a new
+ * decimated block is ready, e.g. to release a scheduler task. NULL disables it.
+ *
+ * @param   callback    (void (*)(void))    Interrupt-context notification.
+ */
+void ADC_SetBlockCallback_2(void (*callback)(void));
+
+/** ADC_GetFrameCount_2()
+ *
+ * @return  (uint32_t)  Number of decimated frames produced since ADC_Init_2().
+ */
+uint32_t ADC_GetFrameCount_2(void);
+
 /** ADC_Init()
  *
- * Initializes the ADC subsystem with an interrupt; selects ADC Pin4 by default.
+ * Initializes the ADC scan sequence, its DMA stream and the TIM3 trigger, and
+ * starts continuous background acquisition.
  * 
  * @return  (int8_t)    [SUCCESS, ERROR]
  */
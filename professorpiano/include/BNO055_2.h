@@ -16,6 +16,7 @@
  #define BNO055_H_2
  
  #include <stdint.h>
+ #include <I2C_2.h>
  
  
  /*  MODULE-LEVEL DEFINITIONS, MACROS    */
@@ -35,6 +36,58 @@
  #define ACC_CONFIG_PARAMS (0x18) // +/-2g, 62.5 Hz BW
  #define GYRO_CONFIG_PARAMS_0 (0x33)
  #define UNITS_PARAM (0x01)
+
+ /** Interrupt pin. The BNO055 has no data-ready interrupt, only motion
+  *  interrupts, so the INT pin (wired to PB4 / EXTI4) is configured for
+  *  accel and gyro any-motion: it rises whenever the hand moves and stays
+  *  high until cleared, so samples are only read while there is motion. **/
+ #define BNO055_INT_PORT GPIOB
+ #define BNO055_INT_PIN GPIO_PIN_4
+ #define BNO055_INT_IRQn EXTI4_IRQn
+ /** Any-motion thresholds in register units (accel: 3.91 mg/LSB at 2g). **/
+ #define BNO055_ACC_AM_THRESHOLD (10)
+ #define BNO055_GYR_AM_THRESHOLD (4)
+
+ /** First register of the accel/mag/gyro data block (ACCEL_DATA_X_LSB). **/
+ #define BNO055_SAMPLE_START_ADDR (0x08)
+
+ /** Raw accel, mag and gyro axes as laid out in registers 0x08-0x19.
+  *  The BNO055 and the STM32 are both little endian, so a burst read can
+  *  land directly in this struct. **/
+ typedef struct __attribute__((packed))
+ {
+     int16_t accelX;
+     int16_t accelY;
+     int16_t accelZ;
+     int16_t magX;
+     int16_t magY;
+     int16_t magZ;
+     int16_t gyroX;
+     int16_t gyroY;
+     int16_t gyroZ;
+ } BNO055_Sample_t;
+
+ _Static_assert(sizeof(BNO055_Sample_t) == 18, "BNO055_Sample_t must match registers 0x08-0x19");
+
+ /** First register of the fusion output block (QUATERNION_DATA_W_LSB). **/
+ #define BNO055_FUSION_START_ADDR (0x20)
+ /** Quaternion scale: 1.0 = 2^14 LSB. **/
+ #define BNO055_QUAT_ONE (16384)
+
+ /** NDOF quaternion and linear (gravity-free) acceleration, registers
+  *  0x20-0x2D. Linear acceleration uses the accel unit from UNITS_PARAM (mg). **/
+ typedef struct __attribute__((packed))
+ {
+     int16_t quatW;
+     int16_t quatX;
+     int16_t quatY;
+     int16_t quatZ;
+     int16_t linAccelX;
+     int16_t linAccelY;
+     int16_t linAccelZ;
+ } BNO055_Fusion_t;
+
+ _Static_assert(sizeof(BNO055_Fusion_t) == 14, "BNO055_Fusion_t must match registers 0x20-0x2D");
  
  
  /*  PROTOTYPES  */
@@ -48,6 +101,99 @@
   * @return  (int8_t)    [SUCCESS, ERROR]
   */
  int8_t BNO055_Init_2(uint8_t address);
+
+ /** BNO055_ReadSample_2(address, sample)
+  *
+  * Reads all nine raw accel, mag and gyro axes in a single 18-byte I2C
+  * transaction, so the axes belong to the same sensor update.
+  *
+  * @param   address (uint8_t)           BNO055_ADDRESS_A or BNO055_ADDRESS_B.
+  * @param   sample  (BNO055_Sample_t *) Filled with raw readings.
+  * @return          (int8_t)            [SUCCESS, ERROR]
+  */
+ int8_t BNO055_ReadSample_2(uint8_t address, BNO055_Sample_t *sample);
+
+ /** BNO055_ReadSampleAsync_2(transaction, address, sample, callback)
+  *
+  * Queues the same 18-byte read on the I2C engine and returns at once. The
+  * sample is valid once transaction->status is I2C_DONE; callback runs from
+  * the I2C interrupt when the read finished or failed.
+  *
+  * @param   transaction (I2C_Transaction_t *)   Caller-owned, must not be in
+  *                                              flight.
+  * @return              (int8_t)                [SUCCESS, ERROR]
+  */
+ int8_t BNO055_ReadSampleAsync_2(I2C_Transaction_t *transaction, uint8_t address,
+                                 BNO055_Sample_t *sample, I2C_Callback_t callback);
+
+ /** BNO055_EnableFusion_2(address)
+  *
+  * Switches from the raw AMG mode set by BNO055_Init_2() to NDOF, where the
+  * chip runs its own 9-axis fusion. In NDOF the chip picks the accel and gyro
+  * ranges itself. Blocking.
+  *
+  * @return  (int8_t)    [SUCCESS, ERROR]
+  */
+ int8_t BNO055_EnableFusion_2(uint8_t address);
+
+ /** BNO055_ReadFusion_2(address, fusion)
+  *
+  * Reads quaternion and linear acceleration in a single 14-byte transaction.
+  *
+  * @return  (int8_t)    [SUCCESS, ERROR]
+  */
+ int8_t BNO055_ReadFusion_2(uint8_t address, BNO055_Fusion_t *fusion);
+
+ /** BNO055_ReadFusionAsync_2(transaction, address, fusion, callback)
+  *
+  * Queues the fusion read on the I2C engine, see BNO055_ReadSampleAsync_2().
+  *
+  * @return  (int8_t)    [SUCCESS, ERROR]
+  */
+ int8_t BNO055_ReadFusionAsync_2(I2C_Transaction_t *transaction, uint8_t address,
+                                 BNO055_Fusion_t *fusion, I2C_Callback_t callback);
+
+ /** BNO055_EnableMotionInterrupt_2(address, accelThreshold, gyroThreshold)
+  *
+  * Routes accel and gyro any-motion interrupts to the INT pin. Drops to
+  * CONFIG mode for the threshold registers and returns to the previous
+  * operation mode. Blocking; call after BNO055_Init_2().
+  *
+  * @return  (int8_t)    [SUCCESS, ERROR]
+  */
+ int8_t BNO055_EnableMotionInterrupt_2(uint8_t address, uint8_t accelThreshold, uint8_t gyroThreshold);
+
+ /** BNO055_InitInterruptPin_2(callback)
+  *
+  * Configures BNO055_INT_PIN as a rising-edge EXTI input. callback runs from
+  * the EXTI interrupt on every edge, typically to queue a sample read and
+  * BNO055_ClearInterruptAsync_2().
+  */
+ void BNO055_InitInterruptPin_2(void (*callback)(void));
+
+ /** BNO055_InterruptPending_2()
+  *
+  * @return  (int8_t)    TRUE while the INT pin is high (latched, not cleared).
+  */
+ int8_t BNO055_InterruptPending_2(void);
+
+ /** BNO055_ClearInterruptAsync_2(transaction, address)
+  *
+  * Queues the RST_INT write that releases the INT pin so the next motion
+  * raises a new edge.
+  *
+  * @return  (int8_t)    [SUCCESS, ERROR]
+  */
+ int8_t BNO055_ClearInterruptAsync_2(I2C_Transaction_t *transaction, uint8_t address);
+
+ /** BNO055_ReadRegisters_2(address, startRegister, data, length)
+  *
+  * Reads any contiguous register range in a single I2C transaction, e.g. the
+  * fusion outputs starting at the Euler/quaternion registers.
+  *
+  * @return  (int8_t)    [SUCCESS, ERROR]
+  */
+ int8_t BNO055_ReadRegisters_2(uint8_t address, uint8_t startRegister, uint8_t *data, uint16_t length);
  
  /** BNO055_ReadAccelX()
   *
@@ -71,6 +71,33 @@ int8_t BOARD_Init_2(void);
  */
 int8_t BOARD_End_2(void);
 
+/** BOARD_SetBaudrate_2(baudrate)
+ *
+ * Re-opens UART2 at a different baud rate, e.g. for binary capture streams
+ * that do not fit into 115200 baud.
+ *
+ * @param   baudrate    (uint32_t)  New baud rate.
+ * @return              (int8_t)    [SUCCESS, ERROR]
+ */
+int8_t BOARD_SetBaudrate_2(uint32_t baudrate);
+
+/** BOARD_SerialWriteDMA_2(data, size)
+ *
+ * Starts a UART2 transmission through DMA1 Stream6 and returns immediately.
+ * The buffer must stay untouched until BOARD_SerialBusy_2() returns FALSE.
+ *
+ * @param   data    (const uint8_t *)   Bytes to send.
+ * @param   size    (uint16_t)          Number of bytes to send.
+ * @return          (int8_t)            [SUCCESS, ERROR] (ERROR if busy)
+ */
+int8_t BOARD_SerialWriteDMA_2(const uint8_t *data, uint16_t size);
+
+/** BOARD_SerialBusy_2()
+ *
+ * @return  (int8_t)    TRUE while a UART2 transmission is in flight.
+ */
+int8_t BOARD_SerialBusy_2(void);
+
 /** Error_Handler()
  * 
  * Enter a state of blinking the status LED on-board the Nucleo, indefinitely.
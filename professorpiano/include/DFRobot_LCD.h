@@ -4,12 +4,31 @@
 #define DFROBOT_RGBLCD_H
 
 #include <stdint.h>
+#include "I2C_2.h"
 
 /*  Define to match the DFRobot defaults for your display. */
 #define LCD_ADDRESS     (0x7c>>1)
 #define RGB_ADDRESS     (0x5A>>1)
 
 
+/*  Shadow framebuffer size: a 16x2 panel. */
+#define LCD_MAX_COLS    16
+#define LCD_MAX_ROWS    2
+
+/*  A clean gap this short inside a row is resent rather than paying for
+ *  another cursor command and transaction. */
+#define LCD_MERGE_GAP   3
+
+/*  Most runs one flush can produce: with LCD_MERGE_GAP 3 a row splits into
+ *  at most four (cells 0, 5, 10, 15). */
+#define LCD_MAX_RUNS    8
+
+/*  HD44780 custom characters: eight 5x8 glyphs, shown by character codes
+ *  0-7 or their aliases 8-15 (which, unlike 0, fit in a C string). */
+#define LCD_CGRAM_SLOTS 8
+#define LCD_GLYPH_ROWS  8
+#define LCD_CGRAM_CHAR(slot)    (8 + (slot))
+
 /*  Colors. */
 #define WHITE  0
 #define RED    1
@@ -67,6 +86,23 @@
 extern "C" {
 #endif
 
+/*!
+ * @brief One changed run queued by DFRobot_RGBLCD_FlushAsync(): the DDRAM
+ *        address command and the characters, with their own copies so the
+ *        framebuffer can change while they are on the bus.
+ */
+typedef struct
+{
+    I2C_Transaction_t command;
+    I2C_Transaction_t data;
+    uint8_t commandBytes[2];
+    uint8_t dataBytes[LCD_MAX_COLS];
+    uint8_t row;
+    uint8_t first;
+    uint8_t length;
+    uint8_t queued;        ///< Upload: both writes accepted and counted in cgramUploads
+} DFRobot_RGBLCD_Run_t;
+
 /*!
  * @brief This structure keeps all the “state” that was in the C++ class.
  */
@@ -82,6 +118,30 @@ typedef struct
     uint8_t displayMode;      ///< (LCD_ENTRYLEFT | LCD_ENTRYSHIFTDECREMENT)
     uint8_t currline;
     uint8_t numlines;
+    uint32_t i2cErrors;       ///< Failed LCD/RGB transfers since init
+
+    /*  Shadow framebuffer: frame is what the callers want on the glass,
+     *  shown is what was last sent, dirty has one bit per column where
+     *  they differ. Nothing reaches the bus until DFRobot_RGBLCD_Flush(). */
+    uint8_t frame[LCD_MAX_ROWS][LCD_MAX_COLS];
+    uint8_t shown[LCD_MAX_ROWS][LCD_MAX_COLS];
+    uint16_t dirty[LCD_MAX_ROWS];
+    uint16_t stale[LCD_MAX_ROWS];    ///< Cells whose glass content is unknown after a failed write
+    uint8_t cursorCol;        ///< Where Print/WriteChar put the next character
+    uint8_t cursorRow;
+    uint32_t flushedBytes;    ///< Character bytes sent by Flush since init
+
+    DFRobot_RGBLCD_Run_t runs[LCD_MAX_RUNS];
+    uint8_t numRuns;          ///< Runs of the last FlushAsync()
+    uint32_t flushCount;      ///< Flush and FlushAsync calls that sent or queued anything
+
+    /*  CGRAM queued by LoadSymbol: glyph per slot and the slots still to be
+     *  uploaded, which the next flush sends ahead of the characters. */
+    uint8_t cgram[LCD_CGRAM_SLOTS][LCD_GLYPH_ROWS];
+    uint8_t cgramDirty;
+    DFRobot_RGBLCD_Run_t uploads[LCD_CGRAM_SLOTS];   ///< first holds the slot
+    uint8_t numUploads;       ///< Uploads of the last FlushAsync()
+    uint32_t cgramUploads;    ///< Glyphs sent since init
 } DFRobot_RGBLCD_t;
 
 DFRobot_RGBLCD_t myLCD;
@@ -139,25 +199,57 @@ void DFRobot_RGBLCD_AutoScrollOn(DFRobot_RGBLCD_t *p);
 void DFRobot_RGBLCD_AutoScrollOff(DFRobot_RGBLCD_t *p);
 
 /*!
- * @brief Set the cursor
+ * @brief Set where the next character goes in the shadow framebuffer (no bus traffic)
  */
 void DFRobot_RGBLCD_SetCursor(DFRobot_RGBLCD_t *p, uint8_t col, uint8_t row);
 
 /*!
- * @brief Print a single character
+ * @brief Print a single character, then flush
  */
 void DFRobot_RGBLCD_WriteChar(DFRobot_RGBLCD_t *p, uint8_t ch);
 
 /*!
- * @brief Print a C-string
+ * @brief Print a C-string, then flush; only cells that changed are sent
  */
 void DFRobot_RGBLCD_Print(DFRobot_RGBLCD_t *p, const char *str);
 
+/*!
+ * @brief Write a C-string into the shadow framebuffer at the cursor without
+ *        flushing. Characters past the last column are dropped.
+ */
+void DFRobot_RGBLCD_BufferPrint(DFRobot_RGBLCD_t *p, const char *str);
+
+/*!
+ * @brief Send every changed run of cells, one cursor command plus one
+ *        multi-byte data write per run
+ * @return SUCCESS, or ERROR if a run failed (it stays dirty for the next flush)
+ */
+int8_t DFRobot_RGBLCD_Flush(DFRobot_RGBLCD_t *p);
+
+/*!
+ * @brief Like Flush, but only queues the runs on the I2C driver and returns.
+ *        Runs that failed are marked dirty again on the next call.
+ * @return SUCCESS if the changes were queued (or there were none), ERROR
+ *         while the previous flush is still on the bus
+ */
+int8_t DFRobot_RGBLCD_FlushAsync(DFRobot_RGBLCD_t *p);
+
+/*!
+ * @brief 1 while runs of the last FlushAsync() are still queued or on the bus
+ */
+uint8_t DFRobot_RGBLCD_FlushBusy(const DFRobot_RGBLCD_t *p);
+
 /*!
  * @brief Create a custom symbol in CGRAM
  */
 void DFRobot_RGBLCD_CreateSymbol(DFRobot_RGBLCD_t *p, uint8_t location, const uint8_t charmap[]);
 
+/*!
+ * @brief Queue a custom symbol for CGRAM; it is sent by the next Flush or
+ *        FlushAsync, ahead of the characters, so no bus traffic here
+ */
+void DFRobot_RGBLCD_LoadSymbol(DFRobot_RGBLCD_t *p, uint8_t location, const uint8_t charmap[LCD_GLYPH_ROWS]);
+
 /*!
  * @brief Set the backlight color using direct RGB
  */
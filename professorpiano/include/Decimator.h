@@ -0,0 +1,58 @@
+/**
+ * @file    Decimator.h
+ *
+ * HAL-free CIC decimator for interleaved multi-channel ADC frames. Order 1 is
+ * a plain boxcar average; order 2 and 3 trade a little more work for better
+ * alias rejection. Integrators and combs run in wrapping 32-bit arithmetic, so
+ * each output costs a few adds per channel and no multiplies.
+ *
+ * Used by ADC_2.c on every DMA block and natively by the host benchmark in
+ * piezo_trace/decimate_bench.c.
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    7 Mar 2025
+ */
+
+#ifndef DECIMATOR_H
+#define DECIMATOR_H
+
+#include <stdint.h>
+
+// DEFINES ****************************************************************************************
+#define DECIMATOR_MAX_CHANNELS  8
+#define DECIMATOR_MAX_ORDER     3
+#define DECIMATOR_MAX_EXTRA     4   // Fractional bits kept on top of 12-bit input
+
+// TYPEDEFS ***************************************************************************************
+typedef struct
+{
+    uint8_t channels;       // Readings per frame
+    uint8_t order;          // 1 = boxcar, 2..DECIMATOR_MAX_ORDER = CIC
+    uint8_t factorShift;    // Decimation factor is 1 << factorShift
+    uint8_t outputShift;    // Gain removed from every output
+    uint16_t phase;         // Input frames into the current output
+    uint32_t integrator[DECIMATOR_MAX_ORDER][DECIMATOR_MAX_CHANNELS];
+    uint32_t comb[DECIMATOR_MAX_ORDER][DECIMATOR_MAX_CHANNELS];
+} Decimator_t;
+
+// FUNCTION PROTOTYPES ****************************************************************************
+/**
+ * @brief Configures and clears a decimator. Out-of-range arguments are clamped.
+ * @param channels Readings per interleaved frame (<= DECIMATOR_MAX_CHANNELS).
+ * @param factorShift log2 of the decimation factor.
+ * @param order Number of integrator/comb stages (1..DECIMATOR_MAX_ORDER).
+ * @param extraBits Fractional bits kept in the output; 0 keeps the input scale
+ *                  so the piezo thresholds stay valid.
+ */
+void Decimator_Init(Decimator_t *dec, uint8_t channels, uint8_t factorShift, uint8_t order, uint8_t extraBits);
+
+/**
+ * @brief Feeds interleaved frames through the filter.
+ * @param in inFrames * channels readings.
+ * @param out Receives one frame per (1 << factorShift) input frames.
+ * @return Number of frames written to out.
+ */
+uint16_t Decimator_Process(Decimator_t *dec, const uint16_t *in, uint16_t inFrames, uint16_t *out);
+
+#endif // DECIMATOR_H
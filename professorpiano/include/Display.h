@@ -0,0 +1,45 @@
+/**
+ * @file    Display.h
+ *
+ * Display model for the RGB LCD. Code that wants something on screen only
+ * writes text into the LCD framebuffer (no I2C); Display_Service(), run from
+ * the display task, queues the changed cells on the I2C driver at most once
+ * per DISPLAY_REFRESH_US and returns. Detection and audio never wait on the
+ * LCD, and a burst of notes between two refreshes costs a single update with
+ * only the last text in it.
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    11 Mar 2025
+ */
+
+#ifndef DISPLAY_H
+#define DISPLAY_H
+
+#include <stdint.h>
+
+// DEFINES ****************************************************************************************
+#define DISPLAY_REFRESH_US 50000    // 20 Hz, faster than the eye follows the text anyway
+
+// FUNCTION PROTOTYPES ****************************************************************************
+/**
+ * @brief Replaces one line of the display model. The text is cut or padded
+ *        with spaces to the LCD width, so shorter text clears what was there.
+ * @param row 0 or 1.
+ * @param format printf style format.
+ */
+void Display_PrintLine(uint8_t row, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+/**
+ * @brief Queues the changes since the last refresh if DISPLAY_REFRESH_US has
+ *        passed and the previous refresh is off the bus. Never blocks.
+ */
+void Display_Service(void);
+
+/**
+ * @brief Model writes and refreshes since boot. The difference is how many
+ *        updates were collapsed.
+ */
+void Display_GetStats(uint32_t *writes, uint32_t *refreshes);
+
+#endif // DISPLAY_H
@@ -0,0 +1,163 @@
+/**
+ * @file    GestureClassifier.h
+ *
+ * Streaming hand gesture classifier on raw BNO055 gyro and accel samples.
+ * Every sample updates running sums over the last GESTURE_WINDOW samples, so
+ * the window features cost the same whatever the window length:
+ *
+ *  - twist and pitch angle swept over the window (gyro X / Y times dt),
+ *  - mean yaw rate and yaw direction reversals (a shake),
+ *  - mean acceleration per axis (with gravity, so hand pose) and jerk.
+ *
+ * A decision tree, trained on the host from labelled traces and compiled in
+ * as a const table (GestureTree.c, generated by imu_trace/gesture_train),
+ * maps the features to a class. Evaluation walks at most
+ * GESTURE_TREE_MAX_DEPTH nodes. A class has to win GESTURE_CONFIRM_SAMPLES
+ * samples in a row before it counts; octave and mode gestures then fire once
+ * per GESTURE_COOLDOWN_US, sustain holds until the hand is back to neutral.
+ * Being back is read from the pitch of the latest sample rather than the
+ * window, so sustain lets go even when the hand comes to rest at once.
+ *
+ * Samples may come polled or only while the hand moves (IMU_MOTION_INTERRUPT).
+ * A gap longer than GESTURE_MAX_DT_US empties the window, and no decision is
+ * made until it is full again, so every window the tree sees is gap-free like
+ * the ones it was trained on.
+ *
+ * HAL-free, so imu_trace/gesture_eval runs the same source on the host.
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    11 Mar 2025
+ */
+
+#ifndef GESTURE_CLASSIFIER_H
+#define GESTURE_CLASSIFIER_H
+
+#include <stdint.h>
+#include <ImuGesture.h> // Gyro scale and bias, octave cooldown
+
+// DEFINES ****************************************************************************************
+#define GESTURE_WINDOW 16               // Samples, about 320 ms at the polled rate or while moving
+#define GESTURE_CONFIRM_SAMPLES 2
+#define GESTURE_COOLDOWN_US OCTAVE_CHANGE_COOLDOWN_US
+#define GESTURE_MAX_DT_US 100000        // A longer gap (hand at rest, no motion interrupt) clears the window
+#define GESTURE_SHAKE_DEADBAND_RAW 960  // 60 dps; smaller yaw rates do not set a direction
+#define GESTURE_LEVEL_ACCEL_X_MG -250   // Above this the fingers are back up (about 15 degrees of pitch)
+#define GESTURE_TREE_MAX_DEPTH 8
+#define GESTURE_LEAF 0xFF               // GestureNode_t.feature of a leaf
+
+// TYPEDEFS ***************************************************************************************
+typedef enum
+{
+    GESTURE_NONE,
+    GESTURE_OCTAVE_UP,                  // Twist to the left
+    GESTURE_OCTAVE_DOWN,                // Twist to the right
+    GESTURE_SUSTAIN,                    // Fingers pitched down and held
+    GESTURE_MODE_TOGGLE,                // Shake about the vertical axis
+    GESTURE_NUM_CLASSES
+} Gesture_t;
+
+typedef enum
+{
+    GF_TWIST_DEG,                       // Rotation about X over the window
+    GF_PITCH_DEG,                       // Rotation about Y over the window
+    GF_SHAKE_DPS,                       // Mean |gyro Z|
+    GF_REVERSALS,                       // Gyro Z direction changes
+    GF_ACCEL_X_MG,                      // Mean accel, gravity included
+    GF_ACCEL_Y_MG,
+    GF_ACCEL_Z_MG,
+    GF_JERK_MG,                         // Mean sample-to-sample accel change (L1)
+    GESTURE_NUM_FEATURES
+} GestureFeature_t;
+
+// Internal node: go left when features[feature] <= threshold.
+// Leaf: feature is GESTURE_LEAF and left holds the Gesture_t.
+typedef struct
+{
+    uint8_t feature;
+    uint8_t left;
+    uint8_t right;
+    int32_t threshold;
+} GestureNode_t;
+
+// Running sums, one per-sample contribution each
+enum
+{
+    GS_TWIST,
+    GS_PITCH,
+    GS_SHAKE,
+    GS_REVERSALS,
+    GS_ACCEL_X,
+    GS_ACCEL_Y,
+    GS_ACCEL_Z,
+    GS_JERK,
+    GS_TIME_MS,
+    GESTURE_NUM_SUMS
+};
+
+typedef struct
+{
+    // Window
+    int32_t history[GESTURE_WINDOW][GESTURE_NUM_SUMS];
+    int32_t sums[GESTURE_NUM_SUMS];
+    uint8_t head;
+    uint8_t count;
+    uint8_t started;
+    uint32_t lastSample_us;
+    int16_t prevAccel[3];
+    int8_t yawDirection;                // -1, 0 or 1
+
+    // Decision
+    uint8_t lastClass;                  // Tree output for the last sample
+    uint8_t candidate;
+    uint8_t candidateCount;
+    uint8_t confirmed;
+    uint8_t sustain;
+    uint8_t fired;                      // An event has fired, cooldown applies
+    uint32_t lastEvent_us;
+} GestureClassifier_t;
+
+// Generated table, see GestureTree.c
+extern const GestureNode_t GESTURE_TREE[];
+extern const uint8_t GESTURE_TREE_NODES;
+
+// One character per Gesture_t for traces and logs
+extern const char GESTURE_LABELS[GESTURE_NUM_CLASSES];
+
+// FUNCTION PROTOTYPES ****************************************************************************
+/**
+ * @brief Clears the window and the decision state.
+ */
+void GestureClassifier_Init(GestureClassifier_t *classifier);
+
+/**
+ * @brief Feeds one sample.
+ * @param gyro Raw gyro X, Y, Z (16 LSB/dps).
+ * @param accel Raw accel X, Y, Z in mg, gravity included.
+ * @param timestamp_us When the sample was taken.
+ * @return The gesture that fired on this sample: GESTURE_OCTAVE_UP,
+ *         GESTURE_OCTAVE_DOWN, GESTURE_MODE_TOGGLE, GESTURE_SUSTAIN when a
+ *         hold starts, otherwise GESTURE_NONE.
+ */
+Gesture_t GestureClassifier_Update(GestureClassifier_t *classifier, const int16_t gyro[3], const int16_t accel[3],
+                                   uint32_t timestamp_us);
+
+/**
+ * @return 1 while a sustain hold is in progress.
+ */
+uint8_t GestureClassifier_Sustained(const GestureClassifier_t *classifier);
+
+/**
+ * @brief Window features for the samples seen so far, as fed to the tree.
+ * @return 1 once the window is full, 0 before.
+ */
+uint8_t GestureClassifier_Features(const GestureClassifier_t *classifier, int32_t features[GESTURE_NUM_FEATURES]);
+
+/**
+ * @brief Walks a tree for one feature vector.
+ * @return The leaf class, GESTURE_NONE for a malformed tree.
+ */
+Gesture_t GestureClassifier_Classify(const GestureNode_t *tree, uint8_t nodes,
+                                     const int32_t features[GESTURE_NUM_FEATURES]);
+
+#endif // GESTURE_CLASSIFIER_H
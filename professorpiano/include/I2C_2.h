@@ -18,9 +18,148 @@
 
  I2C_HandleTypeDef hi2c2;
 
+ /*  ASYNCHRONOUS TRANSACTIONS
+  *
+  * Every transfer on I2C2 goes through caller-owned descriptors queued by
+  * priority class and worked off by the I2C2 EV/ER interrupts. Submit returns
+  * at once; the descriptor (and its data buffer) must stay valid until its
+  * status becomes I2C_DONE or I2C_FAILED. The blocking functions below are thin
+  * wrappers that submit a descriptor and sleep until it completes, so blocking
+  * and asynchronous users share the bus without stepping on each other.
+  *
+  * Arbitration happens at transaction boundaries: the next transfer always
+  * comes from the highest non-empty class. Register transfers longer than
+  * their device's maxSlice are cut into slices, so an IMU read waits for at
+  * most one slice of a long display update rather than all of it.
+  */
+ #define I2C_QUEUE_LENGTH    16      // Per priority class
+ #define I2C_TIMEOUT_MS      10      // Active slice is abandoned after this
+ #define I2C_MAX_DEVICES     8
+
+ // Latency histogram: bin k counts submit-to-completion times below
+ // I2C_LATENCY_BIN0_US << k, the last bin everything slower.
+ #define I2C_LATENCY_BINS    9
+ #define I2C_LATENCY_BIN0_US 250
+
+ // Bus speed. I2C_Init_2() starts in standard mode; I2C_ProbeFastMode_2()
+ // moves to fast mode once every device has answered there, and the bus drops
+ // back after I2C_FALLBACK_ERRORS failed slices in a row.
+ #define I2C_STANDARD_SPEED  100000
+ #define I2C_FAST_SPEED      400000
+ #define I2C_PROBE_TRIALS    3       // Address ACKs required per device
+ #define I2C_FALLBACK_ERRORS 8
+ #define I2C_MAX_RETRIES     2       // Extra attempts of a failed slice
+
+ // Fault handling. A hung slice, a bus or arbitration error, or a BUSY flag
+ // that never clears triggers a recovery from I2C_Service_2(): SCL is clocked
+ // by hand until the slave releases SDA, a STOP is sent and the peripheral is
+ // reset and re-initialised. Devices that keep failing are taken offline and
+ // only retried after an exponential backoff, so callers get an immediate
+ // ERROR instead of waiting on a dead device.
+ #define I2C_RECOVERY_CLOCKS         9       // Enough to finish any byte plus ACK
+ #define I2C_RECOVERY_INTERVAL_MS    100     // Between attempts while SDA stays low
+ #define I2C_OFFLINE_FAILURES        3       // Failed transactions in a row
+ #define I2C_BACKOFF_MIN_MS          100
+ #define I2C_BACKOFF_MAX_MS          3200
+
+ // Device flags
+ #define I2C_FIXED_REGISTER  0x01    // Register is a control byte, resent unchanged on every slice
+
+ typedef enum
+ {
+     I2C_OP_WRITE,       // Plain write of data[0..length-1], never sliced
+     I2C_OP_WRITE_REG,   // Register pointer write followed by data
+     I2C_OP_READ_REG     // Register pointer write, repeated start, read
+ } I2C_Op_t;
+
+ typedef enum
+ {
+     I2C_IDLE = 0,
+     I2C_QUEUED,
+     I2C_ACTIVE,         // Started; may sit between slices while preempted
+     I2C_DONE,
+     I2C_FAILED
+ } I2C_Status_t;
+
+ typedef enum
+ {
+     I2C_HEALTHY = 0,
+     I2C_DEGRADED,       // Failed recently, still in use
+     I2C_OFFLINE,        // Submits fail at once until the backoff expires
+     I2C_PROBING         // Backoff expired, next transaction decides
+ } I2C_Health_t;
+
+ typedef enum
+ {
+     I2C_PRIORITY_HIGH = 0,  // Time-critical sensor reads (IMU)
+     I2C_PRIORITY_NORMAL,    // Default for unconfigured devices
+     I2C_PRIORITY_BULK,      // Display and backlight updates
+     I2C_NUM_PRIORITIES
+ } I2C_Priority_t;
+
+ struct I2C_Transaction_s;
+ typedef void (*I2C_Callback_t)(struct I2C_Transaction_s *transaction);
+
+ typedef struct I2C_Transaction_s
+ {
+     uint8_t address;                // 7-bit device address
+     I2C_Op_t op;
+     uint8_t reg;                    // Register for I2C_OP_*_REG
+     uint8_t *data;
+     uint16_t length;
+     I2C_Callback_t callback;        // Runs in interrupt context, may be NULL
+     void *context;                  // Free for the submitter
+     volatile I2C_Status_t status;
+
+     // Filled in by the engine
+     uint8_t priority;
+     int8_t device;                  // Index into the device table, -1 if untracked
+     uint16_t done;                  // Bytes transferred by finished slices
+     uint16_t sliceLength;           // Bytes in the slice on the bus
+     uint8_t retries;                // Failed attempts of the current slice
+     uint32_t submit_us;
+     uint32_t startTick;             // HAL tick when the current slice started
+ } I2C_Transaction_t;
+
+ typedef struct
+ {
+     uint8_t address;
+     I2C_Priority_t priority;
+     uint16_t maxSlice;              // Bytes per slice, 0 = never slice
+     uint8_t flags;
+
+     // Health
+     I2C_Health_t health;
+     uint8_t consecutiveFailures;
+     uint16_t backoff_ms;
+     uint32_t offlineTick;           // HAL tick when it went offline
+
+     // Accounting
+     uint32_t transactions;
+     uint32_t failures;
+     uint32_t slices;
+     uint32_t preempted;             // Times a higher class cut in between slices
+     uint32_t retries;               // Slices repeated after an error
+     uint32_t rejected;              // Submits refused while offline
+     uint32_t worstLatency_us;
+     uint32_t latency[I2C_LATENCY_BINS];
+ } I2C_Device_t;
+
+ typedef struct
+ {
+     uint32_t clockSpeed;            // Current SCL frequency in Hz
+     uint32_t errors;                // Failed slices, retried or not
+     uint32_t consecutiveErrors;
+     uint32_t retries;
+     uint32_t fallbacks;             // Drops from fast to standard mode
+     uint32_t recoveries;            // Bus resets
+     uint8_t stuck;                  // SDA was still low after the last recovery
+ } I2C_BusStats_t;
+
  /** I2C_Init()
   *
-  * Initializes the I2C System at standard speed (100Kbps).
+  * Initializes the I2C System at standard speed (100Kbps). Call
+  * I2C_ProbeFastMode_2() once the attached devices are set up.
   *
   * @return SUCCESS or ERROR
   */
@@ -28,7 +167,7 @@
  
  /** I2C_ReadRegister(I2CAddress, deviceRegisterAddress)
   *
-  * Reads one device register on chosen I2C device.
+  * Reads one device register on chosen I2C device. Blocks until done.
   *
   * @param   I2CAddresss             (unsigned char) 7-bit address of I2C device
   *                                                  wished to interact with.
@@ -66,6 +205,115 @@
   * @return                          (int)   [SUCCESS, ERROR]
   */
  int I2C_ReadInt_2(char I2CAddress, char deviceRegisterAddress, char isBigEndian);
+
+ /** I2C_ReadRegisters_2(I2CAddress, startRegister, data, length)
+  *
+  * Reads length consecutive device registers in one transaction: register
+  * pointer write, repeated start, then a multi-byte read. Relies on the
+  * device auto-incrementing its register pointer.
+  *
+  * @param   I2CAddress      (uint8_t)   7-bit address of I2C device.
+  * @param   startRegister   (uint8_t)   First register to read.
+  * @param   data            (uint8_t *) Destination for length bytes.
+  * @param   length          (uint16_t)  Number of registers to read.
+  * @return                  (int8_t)    [SUCCESS, ERROR]
+  */
+ int8_t I2C_ReadRegisters_2(uint8_t I2CAddress, uint8_t startRegister, uint8_t *data, uint16_t length);
+
+ /** I2C_Write_2(I2CAddress, data, length)
+  *
+  * Writes length raw bytes in one transaction (no register pointer), e.g. a
+  * control byte followed by payload for the LCD.
+  *
+  * @return  (int8_t)    [SUCCESS, ERROR]
+  */
+ int8_t I2C_Write_2(uint8_t I2CAddress, const uint8_t *data, uint16_t length);
+
+ /** I2C_WriteRegisters_2(I2CAddress, startRegister, data, length)
+  *
+  * Writes length bytes after a register byte. Long writes to a device
+  * configured with a maxSlice go out in slices; with I2C_FIXED_REGISTER every
+  * slice repeats startRegister (the LCD data control byte), otherwise it
+  * follows the device's auto-increment.
+  *
+  * @return  (int8_t)    [SUCCESS, ERROR]
+  */
+ int8_t I2C_WriteRegisters_2(uint8_t I2CAddress, uint8_t startRegister, const uint8_t *data, uint16_t length);
+
+ /** I2C_Submit_2(transaction)
+  *
+  * Queues a transaction and returns immediately. The callback, if any, runs
+  * from the I2C interrupt once the transfer finished or failed.
+  *
+  * @param   transaction (I2C_Transaction_t *)   Filled-in descriptor.
+  * @return              (int8_t)                [SUCCESS, ERROR] (ERROR if the
+  *                                              queue is full, the descriptor
+  *                                              is still in use, the device is
+  *                                              offline or the bus is stuck)
+  */
+ int8_t I2C_Submit_2(I2C_Transaction_t *transaction);
+
+ /** I2C_Wait_2(transaction)
+  *
+  * Sleeps until a submitted transaction completes.
+  *
+  * @return  (int8_t)    [SUCCESS, ERROR]
+  */
+ int8_t I2C_Wait_2(I2C_Transaction_t *transaction);
+
+ /** I2C_InFlight_2(transaction)
+  *
+  * @return  (int8_t)    TRUE while the descriptor is queued or active.
+  */
+ int8_t I2C_InFlight_2(const I2C_Transaction_t *transaction);
+
+ /** I2C_ConfigureDevice_2(I2CAddress, priority, maxSlice, flags)
+  *
+  * Sets the priority class and slice length of a device. Devices that were
+  * never configured are queued as I2C_PRIORITY_NORMAL and not sliced.
+  *
+  * @return  (int8_t)    [SUCCESS, ERROR] (ERROR if the device table is full)
+  */
+ int8_t I2C_ConfigureDevice_2(uint8_t I2CAddress, I2C_Priority_t priority, uint16_t maxSlice, uint8_t flags);
+
+ /** I2C_GetDevice_2(I2CAddress)
+  *
+  * @return  (const I2C_Device_t *)  Accounting of a device, NULL if untracked.
+  */
+ const I2C_Device_t *I2C_GetDevice_2(uint8_t I2CAddress);
+
+ /** I2C_ProbeFastMode_2()
+  *
+  * Switches the idle bus to fast mode (400Kbps) and checks that every device
+  * in the device table ACKs its address I2C_PROBE_TRIALS times. If one does
+  * not, the bus goes back to standard mode.
+  *
+  * @return  (uint32_t)  Clock speed the bus runs at afterwards, 0 if the bus
+  *                      was busy and nothing was changed.
+  */
+ uint32_t I2C_ProbeFastMode_2(void);
+
+ /** I2C_GetBusStats_2()
+  *
+  * @return  (const I2C_BusStats_t *)    Bus speed and error counters.
+  */
+ const I2C_BusStats_t *I2C_GetBusStats_2(void);
+
+ /** I2C_PrintStats_2()
+  *
+  * Prints one line per device with its latency histogram and clears the
+  * counters.
+  */
+ void I2C_PrintStats_2(void);
+
+ /** I2C_Service_2()
+  *
+  * Bus watchdog: abandons an active slice older than I2C_TIMEOUT_MS, runs any
+  * pending bus recovery and applies the fast mode fallback. Called by
+  * I2C_Wait_2(); also call it periodically from the main loop so purely
+  * asynchronous traffic is watched too.
+  */
+ void I2C_Service_2(void);
  
  
 void I2C_ScanBus_BNO055_A(void);
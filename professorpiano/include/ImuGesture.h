@@ -0,0 +1,100 @@
+/**
+ * @file    ImuGesture.h
+ *
+ * HAL-free core of the octave gesture detector. Both IMU paths run in integer
+ * arithmetic on real sample timestamps:
+ *
+ *  - raw:    bias-corrected gyro X is integrated with the trapezoid rule over
+ *            the measured time between samples into a twist angle in
+ *            millidegrees, which leaks back to zero so gyro bias cannot
+ *            accumulate;
+ *  - fusion: the twist is read straight from the BNO055 NDOF quaternion,
+ *            relative to the first valid sample (the neutral hand pose).
+ *
+ * A twist past the threshold, or a hard push along X, steps the octave at most
+ * once per cooldown. Nothing in here touches the STM32 HAL, so the same source
+ * compiles natively for the host replay tool (see imu_trace/imu_replay.c).
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    10 Mar 2025
+ */
+
+#ifndef IMU_GESTURE_H
+#define IMU_GESTURE_H
+
+#include <stdint.h>
+
+// DEFINES ****************************************************************************************
+// Octave settings
+#define OCTAVE_MIN 3
+#define STARTING_OCTAVE 4
+#define OCTAVE_MAX 7
+#define OCTAVE_CHANGE_COOLDOWN_US 300000
+
+// Push along X that steps the octave, in mg (UNITS_PARAM selects mg)
+#define OCTAVE_THRESHOLD_ACCEL 800
+
+// Raw path. Gyro is 16 LSB/dps; at 250 dps full scale readings stay in
+// +/-4000, which keeps the integration step inside 32 bits.
+#define OCTAVE_GYRO_BIAS_RAW 18         // Gyro X at rest
+#define OCTAVE_GYRO_LSB_PER_DPS 16
+#define OCTAVE_GYRO_MAX_RAW 4000
+#define OCTAVE_TWIST_MDEG 30000         // Integrated twist that steps the octave
+#define OCTAVE_LEAK_TAU_US 2000000      // Twist decays to 1/e in this time at rest
+#define OCTAVE_MAX_DT_US 100000         // Longer gaps (no motion interrupt) count as this
+
+// Fusion path: the same 30 degree twist as sin(angle / 2) in Q14,
+// sin(15 deg) * 16384
+#define OCTAVE_TWIST_SIN_Q14 4240
+#define OCTAVE_QUAT_ONE 16384
+
+// TYPEDEFS ***************************************************************************************
+typedef struct
+{
+    int8_t octave;
+    uint8_t started;            // Raw: first sample seen. Fusion: reference captured
+    uint8_t changed;            // Octave changed at least once, cooldown applies
+    uint32_t lastSample_us;
+    uint32_t lastChange_us;
+
+    // Raw path
+    int16_t prevRate;           // Bias-corrected gyro X of the previous sample
+    int32_t twist_mdeg;
+    int32_t remainder;          // Integration remainder below 1 mdeg
+
+    // Fusion path
+    int16_t ref[4];             // Neutral pose quaternion w, x, y, z (Q14)
+} ImuGesture_t;
+
+// FUNCTION PROTOTYPES ****************************************************************************
+/**
+ * @brief Clears a detector and sets its octave.
+ */
+void ImuGesture_Init(ImuGesture_t *gesture, int8_t octave);
+
+/**
+ * @brief Raw path: feeds one AMG sample.
+ * @param gyroX Raw gyro X (16 LSB/dps).
+ * @param accelX Raw accel X in mg, gravity included.
+ * @param timestamp_us When the sample was taken.
+ * @return The octave after this sample.
+ */
+int8_t ImuGesture_UpdateRaw(ImuGesture_t *gesture, int16_t gyroX, int16_t accelX, uint32_t timestamp_us);
+
+/**
+ * @brief Fusion path: feeds one NDOF sample.
+ * @param quat Quaternion w, x, y, z in Q14.
+ * @param linAccelX Gravity-free accel X in mg.
+ * @param timestamp_us When the sample was taken.
+ * @return The octave after this sample.
+ */
+int8_t ImuGesture_UpdateFusion(ImuGesture_t *gesture, const int16_t quat[4], int16_t linAccelX,
+                               uint32_t timestamp_us);
+
+/**
+ * @brief Makes the next fusion sample the neutral pose.
+ */
+void ImuGesture_ResetReference(ImuGesture_t *gesture);
+
+#endif // IMU_GESTURE_H
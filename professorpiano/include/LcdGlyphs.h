@@ -0,0 +1,86 @@
+/**
+ * @file    LcdGlyphs.h
+ *
+ * Cache of piano symbols in the eight HD44780 CGRAM slots. A symbol is
+ * uploaded the first time it is asked for and stays until the slot is
+ * needed for another one; the least recently used slot goes first, but
+ * never one a cell on the display (or in the framebuffer, or handed out
+ * since the last flush) still shows. Uploads are queued on the LCD and go
+ * out with the next flush, so asking for a glyph costs no bus traffic and
+ * asking again for a cached one costs nothing at all.
+ *
+ * When every slot is pinned the helpers fall back to plain ASCII ('#', 'b',
+ * the digit), so text stays readable whatever is on screen.
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    11 Mar 2025
+ */
+
+#ifndef LCD_GLYPHS_H
+#define LCD_GLYPHS_H
+
+#include <stdint.h>
+#include <DFRobot_LCD.h>
+
+// DEFINES ****************************************************************************************
+#define LCD_GLYPH_FULL_BLOCK 0xFF       // Solid cell from the character ROM, no slot needed
+#define LCD_BAR_STEPS 5                 // Pixel columns per progress bar cell
+
+// TYPEDEFS ***************************************************************************************
+typedef enum
+{
+    GLYPH_SHARP,
+    GLYPH_FLAT,
+    GLYPH_FINGER_1,                     // Inverse digits, piano fingering 1 (thumb) to 5 (pinky)
+    GLYPH_FINGER_2,
+    GLYPH_FINGER_3,
+    GLYPH_FINGER_4,
+    GLYPH_FINGER_5,
+    GLYPH_BAR_1,                        // Progress bar cell with 1 to 4 columns filled
+    GLYPH_BAR_2,
+    GLYPH_BAR_3,
+    GLYPH_BAR_4,
+    NUM_GLYPHS
+} LcdGlyph_t;
+
+// FUNCTION PROTOTYPES ****************************************************************************
+/**
+ * @brief Empties the cache. Call after DFRobot_RGBLCD_Init().
+ * @param lcd Display the glyphs are loaded into.
+ */
+void LcdGlyphs_Init(DFRobot_RGBLCD_t *lcd);
+
+/**
+ * @brief Character code showing a glyph, loading it into a slot if needed.
+ * @param fallback Returned when every slot is pinned.
+ * @return LCD_CGRAM_CHAR(slot), or fallback.
+ */
+char LcdGlyphs_Get(LcdGlyph_t glyph, char fallback);
+
+/**
+ * @brief Writes a note name with a real sharp or flat sign: "C#" becomes
+ *        'C' and the sharp glyph. Names without an accidental are copied.
+ * @param out At least 3 characters.
+ */
+void LcdGlyphs_FormatNote(char *out, const char *note);
+
+/**
+ * @brief Character for a fingering number 1 to 5.
+ */
+char LcdGlyphs_Finger(uint8_t finger);
+
+/**
+ * @brief Writes a progress bar of cells characters and a terminating 0,
+ *        with LCD_BAR_STEPS steps per cell. At most one glyph is used.
+ * @param out At least cells + 1 characters.
+ */
+void LcdGlyphs_ProgressBar(char *out, uint8_t cells, uint16_t done, uint16_t total);
+
+/**
+ * @brief Glyph requests served from the cache, uploads queued, and requests
+ *        that fell back to ASCII since init.
+ */
+void LcdGlyphs_GetStats(uint32_t *hits, uint32_t *loads, uint32_t *fallbacks);
+
+#endif // LCD_GLYPHS_H
@@ -0,0 +1,86 @@
+/**
+ * @file    Lesson.h
+ *
+ * Songs as data. A lesson is a tempo and a list of fixed-size steps (note,
+ * octave, finger, duration), kept in flash either as a const Lesson_t in the
+ * LESSONS[] library or as a binary blob parsed in place by
+ * Lesson_FromBlob(). Notes are Note_t values, so checking a key press
+ * against the step is a single integer compare, and adding a song is a
+ * table entry, not code.
+ *
+ * Blob format, little endian: LessonBlobHeader_t followed by numSteps
+ * LessonStep_t. lesson_tool/midi2lesson.py writes either form from a MIDI
+ * file, and lesson_tool/lesson_check runs blobs through this parser.
+ *
+ * HAL-free, so the host tools can include it.
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    11 Mar 2025
+ */
+
+#ifndef LESSON_H
+#define LESSON_H
+
+#include <stdint.h>
+#include <PiezoDetect.h> // Note_t, Finger_t
+
+// DEFINES ****************************************************************************************
+#define LESSON_MAGIC "PPL1"
+#define LESSON_NAME_LENGTH 16               // Including the terminator
+#define LESSON_TICKS_PER_BEAT 4             // Step durations are in sixteenth notes
+#define LESSON_MAX_OCTAVE 7
+#define LESSON_NUM_NOTES 12                 // Note_t values
+
+// TYPEDEFS ***************************************************************************************
+typedef struct
+{
+    uint8_t note;                           // Note_t
+    uint8_t octave;                         // Octave the song is written in, 0 to LESSON_MAX_OCTAVE
+    uint8_t finger;                         // Finger_t that plays it, B_Thumb to A_Pinky
+    uint8_t ticks;                          // Duration in 1/LESSON_TICKS_PER_BEAT beats
+} LessonStep_t;
+
+typedef struct
+{
+    const char *name;
+    uint16_t tempo_bpm;
+    uint16_t numSteps;
+    const LessonStep_t *steps;
+} Lesson_t;
+
+typedef struct __attribute__((packed))
+{
+    char magic[4];                          // LESSON_MAGIC, no terminator
+    uint16_t tempo_bpm;
+    uint16_t numSteps;
+    char name[LESSON_NAME_LENGTH];          // Zero padded
+} LessonBlobHeader_t;
+
+// Built-in library, see Lessons.c
+extern const Lesson_t LESSONS[];
+extern const uint8_t NUM_LESSONS;
+
+// FUNCTION PROTOTYPES ****************************************************************************
+/**
+ * @brief Checks a blob and points a lesson into it; nothing is copied, so the
+ *        blob must stay in place (flash) while the lesson is used.
+ * @param blob Start of the header, 2-byte aligned.
+ * @param size Bytes available at blob.
+ * @return SUCCESS (1), or ERROR (-1) for a bad magic, size or step.
+ */
+int8_t Lesson_FromBlob(const uint8_t *blob, uint32_t size, Lesson_t *lesson);
+
+/**
+ * @brief Checks every step of a lesson.
+ * @return SUCCESS (1), or ERROR (-1) if any note, octave, finger or duration
+ *         is out of range.
+ */
+int8_t Lesson_Validate(const Lesson_t *lesson);
+
+/**
+ * @return Length of a step in milliseconds at the lesson's tempo.
+ */
+uint32_t Lesson_StepMs(const Lesson_t *lesson, const LessonStep_t *step);
+
+#endif // LESSON_H
@@ -0,0 +1,78 @@
+/**
+ * @file    LessonEngine.h
+ *
+ * Guided lesson as a state machine for the scheduler. The piezo detector
+ * pushes every classified key press with LessonEngine_PushKey(), the same
+ * press that free play sounds and logs, and the lesson task calls
+ * LessonEngine_Service() to consume them. Nothing in here waits: a step is
+ * prompted (display, finger LED, note length), then the engine listens until
+ * the step's note arrives in the step's octave, and after the last step the result stays up for
+ * LESSON_DONE_HOLD_MS before the lesson starts over. Octave tracking, voice
+ * expiry and the display keep running in their own tasks throughout.
+ *
+ * Key presses only queue while a lesson runs. The queue is flushed at every
+ * prompt, so a press that completed one step, or a chord, cannot also
+ * complete the next one.
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    11 Mar 2025
+ */
+
+#ifndef LESSON_ENGINE_H
+#define LESSON_ENGINE_H
+
+#include <stdint.h>
+#include <Lesson.h>
+
+// DEFINES ****************************************************************************************
+#define LESSON_KEY_QUEUE 8                  // Power of two
+#define LESSON_DONE_HOLD_MS 3000
+
+// TYPEDEFS ***************************************************************************************
+typedef enum
+{
+    LESSON_IDLE,                            // Free play
+    LESSON_PROMPT,                          // Show the next step
+    LESSON_LISTEN,                          // Wait for its note
+    LESSON_DONE,                            // Congratulations, then start over
+} LessonState_t;
+
+typedef struct
+{
+    uint8_t note;                           // Note_t
+    uint8_t octave;                         // currentOctave at the press
+    uint8_t finger;                         // As passed to PiezoMovingPeakDetector()
+    uint32_t time_ms;
+} LessonKey_t;
+
+// FUNCTION PROTOTYPES ****************************************************************************
+/**
+ * @brief Starts a lesson from its first step. The lesson must stay valid
+ *        (flash) until it is stopped.
+ * @return SUCCESS, or ERROR if Lesson_Validate() rejects it.
+ */
+int8_t LessonEngine_Start(const Lesson_t *lesson);
+
+/**
+ * @brief Ends the lesson and goes back to free play.
+ */
+void LessonEngine_Stop(void);
+
+/**
+ * @return 1 while a lesson runs, in any state but LESSON_IDLE.
+ */
+uint8_t LessonEngine_Active(void);
+
+/**
+ * @brief Queues a key press for the lesson; ignored in free play. Presses
+ *        that find the queue full are dropped.
+ */
+void LessonEngine_PushKey(Note_t note, uint8_t octave, uint8_t finger, uint32_t time_ms);
+
+/**
+ * @brief Advances the state machine with the queued presses. Never blocks.
+ */
+void LessonEngine_Service(uint32_t now_ms);
+
+#endif // LESSON_ENGINE_H
@@ -0,0 +1,97 @@
+/**
+ * @file    Log.h
+ *
+ * Console logging with a level per module. Each module has a compile-time
+ * level below; a LOG_*() call above it is a constant-false branch that the
+ * compiler drops together with its format string and argument evaluation,
+ * while the arguments are still type checked. LOG_MAX_LEVEL caps every
+ * module at once, e.g. -DLOG_MAX_LEVEL=LOG_LEVEL_WARN in build_flags for a
+ * release build.
+ *
+ * Calls that survive compilation also check a runtime level per module,
+ * which starts at the compile-time one and can only be lowered or raised
+ * back up to it with Log_SetLevel().
+ *
+ * Output goes through printf, i.e. the SerialLog ring; like printf, not for
+ * interrupt handlers. Use TRACE() from Trace.h on hot paths that need to
+ * keep their events in release builds.
+ *
+ *   LOG_INFO(LOG_PIEZO, "%s Key Pressed on %d finger\n", type, finger);
+ *
+ * Modules are named by their LogModule_t value; plain names like PIEZO are
+ * already feature switches and would expand before the token paste.
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    11 Mar 2025
+ */
+
+#ifndef LOG_H
+#define LOG_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+// DEFINES ****************************************************************************************
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_MAX_LEVEL
+#define LOG_MAX_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+// Compile-time level per module
+#define LOG_MAIN_LEVEL LOG_LEVEL_INFO
+#define LOG_PIEZO_LEVEL LOG_LEVEL_INFO      // Key presses at INFO
+#define LOG_OCTAVE_LEVEL LOG_LEVEL_WARN     // Octave and mode changes at INFO
+#define LOG_IMU_LEVEL LOG_LEVEL_INFO
+#define LOG_I2C_LEVEL LOG_LEVEL_WARN
+#define LOG_LESSON_LEVEL LOG_LEVEL_INFO     // Prompts and results
+#define LOG_TELEPLOT_LEVEL LOG_LEVEL_NONE   // DEBUG streams the piezo channels for Teleplot
+
+// TYPEDEFS ***************************************************************************************
+typedef enum
+{
+    LOG_MAIN,
+    LOG_PIEZO,
+    LOG_OCTAVE,
+    LOG_IMU,
+    LOG_I2C,
+    LOG_LESSON,
+    LOG_TELEPLOT,
+    LOG_NUM_MODULES
+} LogModule_t;
+
+// Runtime level per module, see Log_SetLevel()
+extern uint8_t logLevel[LOG_NUM_MODULES];
+
+// MACROS *****************************************************************************************
+// Compile-time constant unless the module is built in at this level
+#define LOG_ENABLED(module, level) \
+    (((level) <= LOG_MAX_LEVEL) && ((level) <= module##_LEVEL) && ((level) <= logLevel[module]))
+
+#define LOG(module, level, ...)               \
+    do                                        \
+    {                                         \
+        if (LOG_ENABLED(module, level))       \
+        {                                     \
+            printf(__VA_ARGS__);              \
+        }                                     \
+    } while (0)
+
+#define LOG_ERROR(module, ...) LOG(module, LOG_LEVEL_ERROR, __VA_ARGS__)
+#define LOG_WARN(module, ...) LOG(module, LOG_LEVEL_WARN, __VA_ARGS__)
+#define LOG_INFO(module, ...) LOG(module, LOG_LEVEL_INFO, __VA_ARGS__)
+#define LOG_DEBUG(module, ...) LOG(module, LOG_LEVEL_DEBUG, __VA_ARGS__)
+
+// FUNCTION PROTOTYPES ****************************************************************************
+/**
+ * @brief Sets a module's runtime level, clamped to its compile-time level.
+ * @return The level now in effect.
+ */
+uint8_t Log_SetLevel(LogModule_t module, uint8_t level);
+
+#endif // LOG_H
@@ -3,26 +3,62 @@
 
 #include <stdint.h>  // For uint32_t type
 #include <stdbool.h> // For boolean logic
+#include <BNO055_2.h>
+#include <ImuGesture.h> // Thresholds and octave limits
+#include <GestureClassifier.h>
 
-// Octave thresholds for movement detection
-#define OCTAVE_THRESHOLD_GYRO 90   
-#define OCTAVE_THRESHOLD_ACCEL 800 
-#define DRIFT_CORRECTIONX 0.0001
-// 
-// #define PRINT_OCTAVE_CHANGE
-
-#define SAMPLE_SIZE 10  
-#define DT 0.00001      // Time step in seconds
-
-// Octave settings
-#define OCTAVE_CHANGE_COOLDOWN 300  // Cooldown in milliseconds
-#define OCTAVE_HYSTERESIS 500        // Prevents small oscillations
-#define OCTAVE_MIN 3
-#define STARTING_OCTAVE 4
-#define OCTAVE_MAX 7
-extern int currentOctave;
-
-int updateOctave(int address);
-float trapezoidal_average(float *samples, float new_value);
+// Gestures from the BNO055 NDOF fusion outputs (quaternion + linear
+// acceleration) instead of integrating raw gyro X on the host. The default
+// octave source: the quaternion is an absolute pose, so the long gaps between
+// IMU_MOTION_INTERRUPT reads cost nothing, where the raw path has to integrate
+// across them. Without it the raw AMG path runs the same twist detector.
+#define OCTAVE_FUSION
+
+// Octave, sustain and mode gestures from the windowed classifier on raw gyro
+// and accel (GestureClassifier.h) instead of the twist detector alone. Opt-in:
+// the tree is only trained on synthetic traces so far (imu_trace/traces), so
+// octaves stay with the twist detector until it is retrained on recorded ones.
+// Reads raw AMG samples, so it replaces OCTAVE_FUSION rather than adding to it.
+// #define GESTURE_CLASSIFIER
+
+#if defined(OCTAVE_FUSION) && defined(GESTURE_CLASSIFIER)
+#error "OCTAVE_FUSION and GESTURE_CLASSIFIER read different BNO055 modes, define only one"
+#endif
+
+typedef enum
+{
+    PLAY_MODE_FREE,
+    PLAY_MODE_GUIDED,
+    NUM_PLAY_MODES
+} PlayMode_t;
+
+// One BNO055 per hand. Hand A carries the piezo fingers and its octave is
+// the one notes are played in; hand B is the second glove at ADR high.
+#define IMU_HAND_A 0
+#define IMU_HAND_B 1
+#define NUM_IMU_HANDS 2
+
+// Everything one sensor's gestures need, so both hands track independently
+typedef struct
+{
+    uint8_t address;                    // BNO055_ADDRESS_A / BNO055_ADDRESS_B
+    uint8_t present;                    // Answered at boot, set by the caller of BNO055_Init_2()
+    int octave;
+    uint8_t sustain;
+    ImuGesture_t gesture;               // Twist detector, see ImuGesture.c
+    GestureClassifier_t classifier;     // Window and decision state, see GestureClassifier.c
+} ImuHand_t;
+
+extern ImuHand_t imuHands[NUM_IMU_HANDS];
+extern int currentOctave;               // Octave of IMU_HAND_A
+extern int sustainHeld;                 // Either hand holds sustain; voices keep ringing while set
+extern PlayMode_t currentMode;          // Stepped by the mode toggle gesture of either hand
+
+// Samples carry the time they were taken (TIMERS_GetMicroSeconds()), which the
+// raw path integrates over and both paths use for the cooldown.
+int updateOctave(ImuHand_t *hand);           // Blocking read, then one of the below
+int updateOctaveFromSample(ImuHand_t *hand, const BNO055_Sample_t *sample, uint32_t timestamp_us);
+int updateOctaveFromFusion(ImuHand_t *hand, const BNO055_Fusion_t *fusion, uint32_t timestamp_us);
+void Octave_ResetReference(ImuHand_t *hand); // Next fusion sample becomes the neutral pose
 
 #endif // OCTAVE_H
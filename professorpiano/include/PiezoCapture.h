@@ -0,0 +1,67 @@
+/**
+ * @file    PiezoCapture.h
+ *
+ * Binary capture of raw piezo ADC frames over UART2 (DMA). Replaces the
+ * Teleplot printf stream (LOG_TELEPLOT_LEVEL) when recording traces for the
+ * host replay tool in piezo_trace/.
+ *
+ * Stream format: back-to-back PiezoCaptureFrame_t records, little endian.
+ * Each frame starts with PIEZO_CAPTURE_SYNC and ends with a 16-bit sum of
+ * every preceding byte in the frame, so the host can resync after drops.
+ *
+ * The frame layout is kept free of HAL types so the host tools can include
+ * this header directly.
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    6 Mar 2025
+ */
+
+#ifndef PIEZO_CAPTURE_H
+#define PIEZO_CAPTURE_H
+
+#include <stdint.h>
+
+// DEFINES ****************************************************************************************
+#define PIEZO_CAPTURE_SYNC          0xA55A
+#define PIEZO_CAPTURE_CHANNELS      7       // B_Thumb, Thumb, Index, Middle, Ring, Pinky, A_Pinky
+#define PIEZO_CAPTURE_BAUDRATE      921600  // ST-Link VCP handles up to 2 Mbaud
+#define PIEZO_CAPTURE_BATCH_FRAMES  32      // Frames per DMA transfer
+#define PIEZO_CAPTURE_PERIOD_US     500     // Matches ADC_FRAME_RATE_HZ, ~48 kB/s on the wire
+
+// TYPEDEFS ***************************************************************************************
+typedef struct __attribute__((packed))
+{
+    uint16_t sync;                           // PIEZO_CAPTURE_SYNC
+    uint16_t sequence;                       // Increments per frame, gaps = dropped frames
+    uint32_t timestamp_us;                   // Scan time derived from the ADC frame count
+    uint16_t adc[PIEZO_CAPTURE_CHANNELS];    // Raw 12-bit readings
+    uint16_t checksum;                       // Sum of all preceding bytes
+} PiezoCaptureFrame_t;
+
+// FUNCTION PROTOTYPES ****************************************************************************
+/**
+ * @brief Switches UART2 to PIEZO_CAPTURE_BAUDRATE and resets the capture buffers.
+ *        printf output is not usable while capturing.
+ */
+void PiezoCapture_Init(void);
+
+/**
+ * @brief Queues one frame of readings. Frames that do not fit are counted as dropped.
+ * @param adc PIEZO_CAPTURE_CHANNELS readings in finger order.
+ * @param timestamp_us Sample time in microseconds.
+ */
+void PiezoCapture_Push(const uint16_t *adc, uint32_t timestamp_us);
+
+/**
+ * @brief Hands the filled batch to the UART DMA once the previous transfer finished.
+ *        Call from the main loop.
+ */
+void PiezoCapture_Service(void);
+
+/**
+ * @return Number of frames dropped because the DMA could not keep up.
+ */
+uint32_t PiezoCapture_GetDropped(void);
+
+#endif // PIEZO_CAPTURE_H
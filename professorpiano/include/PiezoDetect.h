@@ -0,0 +1,99 @@
+/**
+ * @file    PiezoDetect.h
+ *
+ * HAL-free core of the piezo key-press detector: per-finger moving peak
+ * tracking and white/black key classification. Nothing in here touches the
+ * STM32 HAL, so the same source compiles natively for the host replay tool
+ * (see piezo_trace/piezo_replay.c).
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    6 Mar 2025
+ */
+
+#ifndef PIEZO_DETECT_H
+#define PIEZO_DETECT_H
+
+#include <stdint.h>
+
+// DEFINES ****************************************************************************************
+#define NOISE_THRESHOLD 45
+
+// Time after a finalized peak in which readings are ignored, so the ringing of
+// one press is not read as more presses. In time rather than updates, so it is
+// the same whatever rate the caller samples at.
+#define PIEZO_HOLDOFF_US 30000
+
+// Finger_t runs from Unknown (0) to A_Pinky (7), so per-finger tables hold 8 entries.
+#define PIEZO_NUM_FINGERS 8
+
+// TYPEDEFS ***************************************************************************************
+typedef enum
+{
+    Unknown = 0,
+    B_Thumb = 1,
+    Thumb = 2,
+    Index = 3,
+    Middle = 4,
+    Ring = 5,
+    Pinky = 6,
+    A_Pinky = 7
+} Finger_t;
+
+
+typedef enum
+{
+    INVALID_KEY = -1,
+    BLACK_KEY = 1,
+    WHITE_KEY = 0
+} KeyType_t;
+
+typedef enum
+{
+    Note_B = 0,
+    Note_C = 1,
+    Note_Cs = 2,
+    Note_D = 3,
+    Note_Ds = 4,
+    Note_E = 5,
+    Note_F = 6,
+    Note_Fs = 7,
+    Note_G = 8,
+    Note_Gs = 9,
+    Note_A = 10,
+    Note_As = 11
+} Note_t;
+
+typedef struct
+{
+    uint16_t blackKey; // Peaks above this (and below whiteKey) are black keys
+    uint16_t whiteKey; // Peaks above this are white keys
+} PiezoThreshold_t;
+
+// GLOBAL VARIABLES *******************************************************************************
+extern PiezoThreshold_t PiezoThresholds[PIEZO_NUM_FINGERS];
+
+// FUNCTION PROTOTYPES ****************************************************************************
+/**
+ * @brief Clears the peak tracking state of every finger.
+ */
+void PiezoDetect_Reset(void);
+
+/**
+ * @brief Feeds one ADC sample into the moving peak detector of a finger.
+ * @param Piezo_Read The current Piezo sensor reading.
+ * @param finger The finger the reading belongs to.
+ * @param sampleTime_us When the reading was taken; may wrap.
+ * @return The finished peak value once the signal starts falling, otherwise 0.
+ */
+uint16_t PiezoDetect_Update(uint16_t Piezo_Read, Finger_t finger, uint32_t sampleTime_us);
+
+/**
+ * @brief Classifies a finished peak against the finger's thresholds.
+ * @param PiezoPeak The detected peak value.
+ * @param finger The finger being used for pressing.
+ * @return WHITE_KEY, BLACK_KEY or INVALID_KEY.
+ */
+KeyType_t PiezoDetect_Classify(int PiezoPeak, Finger_t finger);
+
+#endif // PIEZO_DETECT_H
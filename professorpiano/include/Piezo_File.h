@@ -33,6 +33,8 @@ Alternatively, I might just use a function for the song instead of a state machi
 #include <timers.h>
 #include <leds.h>
 #include <math.h>
+#include <PiezoDetect.h>
+#include <Lesson.h>
 // #include <NoteFrequencies.h>
 
 // DEFINE TESTS ***********************************************************************************
@@ -40,17 +42,17 @@ Alternatively, I might just use a function for the song instead of a state machi
 #define PIEZO
 
 // #define PIEZO_CALIBRATE
-// #define PIEZO_TELEPLOT
+// #define PIEZO_CAPTURE
+// #define PIEZO_CAPTURE_RAW   // With PIEZO_CAPTURE: stream scans before decimation
 #define PIEZO_FREEPLAY
-// #define SONG_TEST_SONG
 
 #define HARDCODED
 #define SOUND
 
-// #define TWINKLETWINKLE_SONG
+// #define LESSON_SONG         // Boot into the lesson instead of free play; the mode gesture switches
+#define LESSON_SELECTED 0   // Twinkle Twinkle, see Lessons.c
 
 // DEFINES ****************************************************************************************
-#define PRINT_FLAG 1
 #define SLOW_PRINTING 100
 
 // #ifdef HARDCODED
@@ -76,8 +78,6 @@ Alternatively, I might just use a function for the song instead of a state machi
 // #define Calibrate_A_Pinky_WhiteKey 100
 // #endif // HARDCODED
 
-#define NOISE_THRESHOLD 45
-
 // PINOUTS ****************************************************************************************
 #define B_THUMB_PIN ADC_6   // Pin 21 - Piezo Sensor (ADC_6)   PA6
 #define THUMB_PIN   ADC_0   // Pin 36 - Piezo Sensor (ADC_0)   PA0
@@ -104,47 +104,11 @@ Alternatively, I might just use a function for the song instead of a state machi
 // GLOBAL VARIABLES *******************************************************************************
 
 // TYPEDEFS ***************************************************************************************
-typedef enum
-{
-    Unknown = 0,
-    B_Thumb = 1,
-    Thumb = 2,
-    Index = 3,
-    Middle = 4,
-    Ring = 5,
-    Pinky = 6,
-    A_Pinky = 7
-} Finger_t;
-
-
-typedef enum
-{
-    INVALID_KEY = -1,
-    BLACK_KEY = 1,
-    WHITE_KEY = 0
-} KeyType_t;
-
-typedef enum
-{
-    Note_B = 0,
-    Note_C = 1,
-    Note_Cs = 2,
-    Note_D = 3,
-    Note_Ds = 4,
-    Note_E = 5,
-    Note_F = 6,
-    Note_Fs = 7,
-    Note_G = 8,
-    Note_Gs = 9,
-    Note_A = 10,
-    Note_As = 11
-} Note_t;
+// Finger_t, KeyType_t and Note_t live in PiezoDetect.h.
 
 // LOOKUP TABLES **********************************************************************************
 extern const Note_t NOTE_MAP[7][2];
-extern const char *TWINKLETWINKLE[];
-extern const char *SONG_TEST[];
-extern const char *SONG_TEST2[];
+extern const uint8_t FINGERING[7];         // Piano finger (1 = thumb) of each NOTE_MAP row
 extern const char *GetNoteString(Note_t note);
 extern const uint8_t FINGER_PIN[8];
 extern const uint8_t LED_PIN[8];
@@ -186,6 +150,11 @@ void OFF_LEDS(void);
  */
 void SET_LEDS(const char *note);
 
+/**
+ * @brief Lights one finger's LED and turns the others off.
+ */
+void SET_FINGER_LED(Finger_t finger);
+
 /**
  * @brief Initializes the Piezo sensor, setting baselines and thresholds for each finger.
  */
@@ -195,10 +164,11 @@ void Piezo_Init(void);
  * @brief Detects peaks in Piezo readings and determines key presses.
  * @param Piezo_Read The current Piezo sensor reading.
  * @param finger The finger being used for pressing.
+ * @param sampleTime_us When the reading was taken, for the detector's holdoff.
  * @param currentTime The current system time.
  * @return The detected peak value or 0 if no valid peak is found.
  */
-uint16_t PiezoMovingPeakDetector(uint16_t Piezo_Read, Finger_t finger, uint32_t currentTime);
+uint16_t PiezoMovingPeakDetector(uint16_t Piezo_Read, Finger_t finger, uint32_t sampleTime_us, uint32_t currentTime);
 
 /**
  * @brief Determines whether a pressed key is a white or black key.
@@ -208,12 +178,6 @@ uint16_t PiezoMovingPeakDetector(uint16_t Piezo_Read, Finger_t finger, uint32_t
  */
 int WhiteOrBlackKey(int PiezoPeak, Finger_t finger);
 
-/**
- * @brief Guides the user in playing Twinkle Twinkle Little Star by detecting correct notes.
- * @return 1 if the song is completed, 0 if still in progress.
- */
-int TwinkleTwinkle(void);
-
 
 // ************************************************************************************************
 // Frequency lookup table for each note and octave
@@ -0,0 +1,105 @@
+/**
+ * @file    Scheduler.h
+ *
+ * Small cooperative run-to-completion scheduler for the main loop. Tasks are
+ * either periodic (released every period_us) or event-driven (released by
+ * Scheduler_Signal(), which is safe to call from interrupts). Ready tasks run
+ * in registration order, so register the latency-critical ones first.
+ *
+ * Every task keeps its own accounting: runs, worst release-to-finish latency,
+ * worst run time, deadline misses and releases that were coalesced because
+ * the previous one had not run yet. When nothing is ready the core sleeps in
+ * WFI until the next interrupt (DMA, EXTI, or the 1 ms SysTick/TIM2 ticks);
+ * the task that runs first after a wakeup is credited with it, so the report
+ * shows which task keeps the core awake.
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    8 Mar 2025
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+
+// DEFINES ****************************************************************************************
+#define SCHEDULER_MAX_TASKS 12             // main.c registers 8
+#define SCHEDULER_NO_TASK   (-1)
+
+// TYPEDEFS ***************************************************************************************
+typedef void (*SchedulerFunc_t)(void);
+
+typedef struct
+{
+    const char *name;
+    SchedulerFunc_t run;
+    uint32_t period_us;             // 0 = event task
+    uint32_t deadline_us;           // Release-to-finish budget, 0 = none
+    uint32_t nextRelease_us;
+    volatile uint32_t release_us;   // When the pending release happened
+    volatile uint8_t pending;
+
+    // Accounting
+    uint32_t runs;
+    uint32_t wakeups;               // Runs that ended a sleep
+    uint32_t misses;                // Finished after deadline_us
+    volatile uint32_t coalesced;    // Released again while still pending
+    uint32_t worstLatency_us;
+    uint32_t worstRuntime_us;
+    uint32_t totalRuntime_us;
+} SchedulerTask_t;
+
+// FUNCTION PROTOTYPES ****************************************************************************
+/**
+ * @brief Removes all tasks. Call before registering.
+ */
+void Scheduler_Init(void);
+
+/**
+ * @brief Registers a task released every period_us, first release one period from now.
+ * @return Task id, or SCHEDULER_NO_TASK if the table is full.
+ */
+int8_t Scheduler_AddPeriodic(const char *name, SchedulerFunc_t run, uint32_t period_us, uint32_t deadline_us);
+
+/**
+ * @brief Registers a task that only runs after Scheduler_Signal().
+ * @return Task id, or SCHEDULER_NO_TASK if the table is full.
+ */
+int8_t Scheduler_AddEvent(const char *name, SchedulerFunc_t run, uint32_t deadline_us);
+
+/**
+ * @brief Releases an event task. Interrupt safe; repeated signals before the
+ *        task runs are merged into one run and counted as coalesced.
+ */
+void Scheduler_Signal(int8_t task);
+
+/**
+ * @brief Releases due periodic tasks and runs the highest priority ready one.
+ * @return 1 if a task ran, 0 if nothing was ready.
+ */
+uint8_t Scheduler_RunOnce(void);
+
+/**
+ * @brief Sleeps in WFI unless a task is ready. Interrupts that release a task
+ *        between the check and the sleep still end it immediately.
+ */
+void Scheduler_Idle(void);
+
+/**
+ * @brief Runs the scheduler forever, sleeping whenever no task is ready.
+ */
+void Scheduler_Run(void);
+
+/**
+ * @return Accounting of a registered task, NULL for an invalid id.
+ */
+const SchedulerTask_t *Scheduler_GetTask(int8_t task);
+
+/**
+ * @brief Prints one accounting line per task plus the sleep summary and clears
+ *        the counters.
+ */
+void Scheduler_PrintStats(void);
+
+#endif // SCHEDULER_H
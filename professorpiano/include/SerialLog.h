@@ -0,0 +1,72 @@
+/**
+ * @file    SerialLog.h
+ *
+ * Non-blocking console output. printf() and friends end up in _write(),
+ * which copies the text into a ring buffer and returns; UART2 TX DMA drains
+ * the ring one contiguous chunk at a time, restarted from the transfer
+ * complete interrupt. Nothing on the console path waits for the UART any
+ * more, so a printf in the detection path costs a memcpy instead of about
+ * 1 ms per 11 characters at 115200 baud.
+ *
+ * The ring has a single producer (thread context) and a single consumer
+ * (the DMA), so writes need no lock. When the text does not fit, the whole
+ * write is dropped and counted; writes from interrupt handlers are dropped
+ * and counted separately, as newlib's printf is not reentrant anyway.
+ *
+ * The UART is shared with PiezoCapture: whoever finds it idle starts a
+ * transfer, and the log picks up again when the other one finishes.
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    11 Mar 2025
+ */
+
+#ifndef SERIAL_LOG_H
+#define SERIAL_LOG_H
+
+#include <stdint.h>
+
+// DEFINES ****************************************************************************************
+#define SERIAL_LOG_SIZE 4096                // Bytes, power of two; about 360 ms at 115200 baud
+#define SERIAL_LOG_FLUSH_TIMEOUT_MS 500
+
+// TYPEDEFS ***************************************************************************************
+typedef struct
+{
+    uint32_t written;                       // Bytes accepted into the ring
+    uint32_t droppedBytes;                  // Bytes of writes that did not fit or came from an ISR
+    uint32_t droppedWrites;                 // Writes that did not fit
+    uint32_t isrWrites;                     // Writes from interrupt context, all dropped
+    uint32_t highWater;                     // Most bytes waiting at once
+    uint32_t transfers;                     // DMA transfers started
+} SerialLogStats_t;
+
+// FUNCTION PROTOTYPES ****************************************************************************
+/**
+ * @brief Queues bytes for the console. Never blocks.
+ * @return length if the bytes were queued, 0 if they were dropped.
+ */
+uint32_t SerialLog_Write(const uint8_t *data, uint32_t length);
+
+/**
+ * @return Bytes a SerialLog_Write() from thread context can take right now.
+ */
+uint32_t SerialLog_Space(void);
+
+/**
+ * @brief Waits until everything queued has left the UART, e.g. before a baud
+ *        rate change, giving up after SERIAL_LOG_FLUSH_TIMEOUT_MS.
+ */
+void SerialLog_Flush(void);
+
+/**
+ * @brief Copies the counters since boot.
+ */
+void SerialLog_GetStats(SerialLogStats_t *stats);
+
+/**
+ * @brief Prints the counters, one line.
+ */
+void SerialLog_PrintStats(void);
+
+#endif // SERIAL_LOG_H
@@ -0,0 +1,104 @@
+/**
+ * @file    Trace.h
+ *
+ * Binary event trace. Hot paths record fixed-size events (timestamp, event
+ * id, two integer arguments) into a RAM ring with TRACE(); the trace task
+ * moves finished records into the console stream (SerialLog), one text line
+ * each between the ordinary log lines. Recording an event is a handful of
+ * stores with interrupts masked, with no formatting and no floats, so it is
+ * safe from interrupt handlers; the hex formatting happens in the task.
+ * event_trace/trace_decode turns a captured console back into a readable log
+ * or CSV.
+ *
+ * Stream format: every record is a line of TRACE_LINE_PREFIX followed by the
+ * TraceRecord_t bytes (little endian, starting with TRACE_SYNC) as upper case
+ * hex, then a newline. The console stays plain text, so pio device monitor
+ * shows the records as lines of hex among the log. The check byte and the
+ * event id tell records from text that happens to look like one; the 8-bit
+ * sequence shows records lost to a full ring.
+ *
+ * The record layout and event ids are kept free of HAL types so the host
+ * decoder can include this header directly.
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    11 Mar 2025
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+
+// DEFINES ****************************************************************************************
+#define TRACE_ENABLED                       // Records on the console; without it TRACE() compiles away
+
+#define TRACE_SYNC 0xA5
+#define TRACE_RING_RECORDS 64               // Power of two, 1 KiB
+#define TRACE_LINE_PREFIX "~T"
+#define TRACE_LINE_BYTES (sizeof(TRACE_LINE_PREFIX) - 1 + (2 * sizeof(TraceRecord_t)) + 1)
+
+// TYPEDEFS ***************************************************************************************
+// Append only: the decoder knows events by number
+typedef enum
+{
+    TRACE_BOOT,                             // arg0 = TRACE_RING_RECORDS, arg1 = sizeof(TraceRecord_t)
+    TRACE_KEY_PRESS,                        // arg0 = finger | keyType << 8 | Note_t << 16, arg1 = peak
+    TRACE_VOICE_START,                      // arg0 = voice, arg1 = Note_t | octave << 8
+    TRACE_VOICE_STOP,                       // arg0 = voice, arg1 = ms it played
+    TRACE_OCTAVE,                           // arg0 = hand, arg1 = new octave
+    TRACE_GESTURE,                          // arg0 = hand, arg1 = Gesture_t
+    TRACE_I2C_FAILURE,                      // arg0 = 7-bit address, arg1 = consecutive failures
+    TRACE_DEADLINE_MISS,                    // arg0 = task index, arg1 = release-to-finish us
+    TRACE_MARK,                             // Free for debugging
+    TRACE_LESSON_STEP,                      // arg0 = step, arg1 = ms from prompt to the right note
+    TRACE_NUM_EVENTS
+} TraceEvent_t;
+
+typedef struct __attribute__((packed))
+{
+    uint8_t sync;                           // TRACE_SYNC
+    uint8_t event;                          // TraceEvent_t
+    uint8_t sequence;                       // Increments per record, gaps = dropped records
+    uint8_t check;                          // TraceRecord_Check()
+    uint32_t timestamp_us;
+    int32_t arg[2];
+} TraceRecord_t;
+
+// FUNCTIONS **************************************************************************************
+// Folds the record into one byte; cheap enough for the emit path
+static inline uint8_t TraceRecord_Check(uint8_t event, uint8_t sequence, uint32_t timestamp_us, int32_t arg0,
+                                        int32_t arg1)
+{
+    uint32_t x = timestamp_us ^ (uint32_t)arg0 ^ ((uint32_t)arg1 * 3u);
+    x ^= x >> 16;
+    x ^= x >> 8;
+    return (uint8_t)(x ^ event ^ (sequence * 5u) ^ 0x5Au);
+}
+
+#ifdef TRACE_ENABLED
+#define TRACE(event, arg0, arg1) Trace_Emit((event), (int32_t)(arg0), (int32_t)(arg1))
+#else
+#define TRACE(event, arg0, arg1) ((void)0)
+#endif // TRACE_ENABLED
+
+// FUNCTION PROTOTYPES ****************************************************************************
+/**
+ * @brief Records one event. Safe from any context; drops (and counts) the
+ *        event when the ring is full. Use TRACE() so disabled builds lose
+ *        the call as well.
+ */
+void Trace_Emit(uint8_t event, int32_t arg0, int32_t arg1);
+
+/**
+ * @brief Moves finished records to the console stream, one line each, as
+ *        long as it has room. Call from thread context, e.g. a scheduler task.
+ */
+void Trace_Service(void);
+
+/**
+ * @return Records dropped because the ring was full.
+ */
+uint32_t Trace_GetDropped(void);
+
+#endif // TRACE_H
@@ -9,26 +9,49 @@
  *
  * @date    16 Sep 2023
  *
- * @TODO    Switch to an interrupt-driven ADC framework that uses DMA to read/
- *          store data from each of the 7 channels when triggered. This special
- *          approach is required since the ADC SFRs are not labeled by channel,
- *          i.e. otherwise we cannot tell which ADC value was read by which
- *          ADC channel (values are mixed up).
+ * The 7 piezo channels are converted as one scan sequence triggered by TIM3
+ * at ADC_SCAN_RATE_HZ. DMA2 Stream0 writes every sequence into a circular raw
+ * buffer; the half-transfer and transfer-complete interrupts decimate each
+ * finished half into the frame history that the read functions serve.
  */
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include "ADC_2.h"
+#include "Decimator.h"
 
 
 /*  PROTOTYPES  */
 static int8_t ADC_ConfigPins(void);
 static int8_t ADC_ConfigClks(void);
+static int8_t ADC_ConfigDMA(void);
+static int8_t ADC_ConfigTrigger(void);
 
 
 /*  MODULE-LEVEL DEFINITIONS, MACROS    */
+#define ADC_CHANNEL_COUNT   19      // ADC_CHANNEL_0 ... ADC_CHANNEL_18
+#define ADC_RANK_NONE       0xFF
+
 static int8_t initStatus = FALSE;
 
+static DMA_HandleTypeDef hdma_adc1;
+static TIM_HandleTypeDef htimAdc;
+
+static const uint32_t scanSequence[ADC_NUM_CHANNELS] = ADC_SCAN_SEQUENCE;
+static uint8_t channelRank[ADC_CHANNEL_COUNT];  // channel -> slot in a frame
+
+// Circular DMA target; the first half is one block, the second half the next.
+static uint16_t adcRaw[2][ADC_BLOCK_SCANS][ADC_NUM_CHANNELS];
+// Decimated frames, written one block at a time from the DMA interrupt.
+static uint16_t adcFrames[ADC_BUFFER_FRAMES][ADC_NUM_CHANNELS];
+static Decimator_t decimator;
+
+static volatile uint32_t blockCount = 0;        // Blocks decimated so far
+static uint32_t blockConsumed = 0;              // Blocks handed out or dropped
+static uint32_t blocksDropped = 0;              // Overwritten before handed out
+static uint32_t rawConsumed = 0;                // Last raw block handed out
+static void (*blockCallback)(void) = NULL;      // Block-ready notification
+
 
 /*  FUNCTIONS   */
 /** ADC_ConfigPins()
@@ -68,15 +91,97 @@ static int8_t ADC_ConfigClks(void)
     return SUCCESS;
 }
 
+/** ADC_ConfigDMA()
+ *
+ * Configure DMA2 Stream0 / Channel 0 to move every scan result of ADC1 into
+ * adcRaw, wrapping around forever.
+ *
+ * @return  (int8_t)    [SUCCESS, ERROR]
+ */
+static int8_t ADC_ConfigDMA(void)
+{
+    __HAL_RCC_DMA2_CLK_ENABLE();
+
+    hdma_adc1.Instance = DMA2_Stream0;
+    hdma_adc1.Init.Channel = DMA_CHANNEL_0;
+    hdma_adc1.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    hdma_adc1.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_adc1.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_adc1.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+    hdma_adc1.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+    hdma_adc1.Init.Mode = DMA_CIRCULAR;
+    hdma_adc1.Init.Priority = DMA_PRIORITY_HIGH;
+    hdma_adc1.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+    if (HAL_DMA_Init(&hdma_adc1) != HAL_OK)
+    {
+        return ERROR;
+    }
+    __HAL_LINKDMA(&hadc1, DMA_Handle, hdma_adc1);
+
+    HAL_NVIC_SetPriority(DMA2_Stream0_IRQn, 1, 0);
+    HAL_NVIC_EnableIRQ(DMA2_Stream0_IRQn);
+
+    return SUCCESS;
+}
+
+/** ADC_ConfigTrigger()
+ *
+ * Configure TIM3 to emit a TRGO update event at ADC_SCAN_RATE_HZ; every event
+ * starts one scan of all channels.
+ *
+ * @return  (int8_t)    [SUCCESS, ERROR]
+ */
+static int8_t ADC_ConfigTrigger(void)
+{
+    TIM_ClockConfigTypeDef sClockSourceConfig = {0};
+    TIM_MasterConfigTypeDef sMasterConfig = {0};
+
+    // APB1 timers run at twice PCLK1 whenever the APB1 prescaler is not 1.
+    uint32_t timerClock = HAL_RCC_GetPCLK1Freq();
+    if ((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_HCLK_DIV1)
+    {
+        timerClock *= 2;
+    }
+
+    htimAdc.Instance = TIM3;
+    htimAdc.Init.Prescaler = 0;
+    htimAdc.Init.CounterMode = TIM_COUNTERMODE_UP;
+    htimAdc.Init.Period = (timerClock / ADC_SCAN_RATE_HZ) - 1;
+    htimAdc.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+    htimAdc.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_ENABLE;
+    if (HAL_TIM_Base_Init(&htimAdc) != HAL_OK)
+    {
+        return ERROR;
+    }
+    sClockSourceConfig.ClockSource = TIM_CLOCKSOURCE_INTERNAL;
+    if (HAL_TIM_ConfigClockSource(&htimAdc, &sClockSourceConfig) != HAL_OK)
+    {
+        return ERROR;
+    }
+    sMasterConfig.MasterOutputTrigger = TIM_TRGO_UPDATE;
+    sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
+    if (HAL_TIMEx_MasterConfigSynchronization(&htimAdc, &sMasterConfig) != HAL_OK)
+    {
+        return ERROR;
+    }
+
+    return SUCCESS;
+}
+
 /** ADC_Start()
  *
- * Start ADC convesions.
+ * Start background conversions: arm the circular DMA, then start the trigger.
  *
  * @return  (int8_t)    [SUCCESS, ERROR]
  */
 int8_t ADC_Start_2(void)
 {
-    HAL_ADC_Start(&hadc1);
+    Decimator_Init(&decimator, ADC_NUM_CHANNELS, ADC_OVERSAMPLE_SHIFT, ADC_DECIMATOR_ORDER, 0);
+    if (HAL_ADC_Start_DMA(&hadc1, (uint32_t *)adcRaw, 2 * ADC_BLOCK_SCANS * ADC_NUM_CHANNELS) != HAL_OK)
+    {
+        return ERROR;
+    }
+    HAL_TIM_Base_Start(&htimAdc);
 
     return SUCCESS;
 }
@@ -89,34 +194,185 @@ int8_t ADC_Start_2(void)
  */
 int8_t ADC_End_2(void)
 {
-    HAL_ADC_Stop(&hadc1);
+    HAL_TIM_Base_Stop(&htimAdc);
+    HAL_ADC_Stop_DMA(&hadc1);
 	HAL_ADC_DeInit(&hadc1);
 
     return SUCCESS;
 }
 
+/** ADC_LatestFrame()
+ *
+ * @return  (uint32_t)  Index of the newest decimated frame in adcFrames.
+ */
+static uint32_t ADC_LatestFrame(void)
+{
+    return ((blockCount * ADC_BLOCK_FRAMES) + ADC_BUFFER_FRAMES - 1) % ADC_BUFFER_FRAMES;
+}
+
+/** ADC_DecimateBlock(half)
+ *
+ * Runs one finished half of the raw DMA buffer through the decimator into the
+ * next block of adcFrames. Called from the DMA interrupt.
+ */
+static void ADC_DecimateBlock(uint8_t half)
+{
+    uint32_t firstFrame = (blockCount * ADC_BLOCK_FRAMES) % ADC_BUFFER_FRAMES;
+    Decimator_Process(&decimator, adcRaw[half][0], ADC_BLOCK_SCANS, adcFrames[firstFrame]);
+    blockCount++;
+
+    if (blockCallback != NULL)
+    {
+        blockCallback();
+    }
+}
+
 /** ADC_Read(channel)
  *
- * Selects ADC channel and returns 12-bit reading.
+ * Returns the newest 12-bit reading of a scanned channel from the DMA buffer.
  *
  * @param   channel (uint32_t)  Select ADC channel:
- *                                  [ADC_0, ADC_1, ..., ADC_5, POT]
- * @return          (uint16_t)  12-bit ADC reading.
+ *                                  [ADC_0, ADC_1, ..., ADC_6]
+ * @return          (uint16_t)  12-bit ADC reading, 0 for unscanned channels.
  */
 uint16_t ADC_Read_2(uint32_t channel)
 {
-	// Select channel and sampling time.
-	ADC_ChannelConfTypeDef sConfig = {0};
-	sConfig.Channel = channel;
-	sConfig.Rank = 1;
-	sConfig.SamplingTime = ADC_SAMPLETIME_3CYCLES;
-	HAL_ADC_ConfigChannel(&hadc1, &sConfig);
-	
-	// Start ADC Conversion, wait for conversion and return value.
-    ADC_Start_2();
-	HAL_ADC_PollForConversion(&hadc1, 1);
+    if ((channel >= ADC_CHANNEL_COUNT) || (channelRank[channel] == ADC_RANK_NONE) || (blockCount == 0))
+    {
+        return 0;
+    }
+    return adcFrames[ADC_LatestFrame()][channelRank[channel]];
+}
+
+/** ADC_ReadBlock_2(channel, dest, count)
+ *
+ * Copies the newest count decimated readings of a scanned channel, oldest
+ * first.
+ *
+ * @return  (uint16_t)  Number of readings copied.
+ */
+uint16_t ADC_ReadBlock_2(uint32_t channel, uint16_t *dest, uint16_t count)
+{
+    if ((channel >= ADC_CHANNEL_COUNT) || (channelRank[channel] == ADC_RANK_NONE))
+    {
+        return 0;
+    }
+    if (count > ADC_BUFFER_FRAMES)
+    {
+        count = ADC_BUFFER_FRAMES;
+    }
+    if (count > blockCount * ADC_BLOCK_FRAMES)
+    {
+        count = blockCount * ADC_BLOCK_FRAMES;
+    }
+
+    uint8_t rank = channelRank[channel];
+    uint32_t frame = (ADC_LatestFrame() + ADC_BUFFER_FRAMES + 1 - count) % ADC_BUFFER_FRAMES;
+    for (uint16_t i = 0; i < count; i++)
+    {
+        dest[i] = adcFrames[frame][rank];
+        frame = (frame + 1) % ADC_BUFFER_FRAMES;
+    }
+    return count;
+}
+
+/** ADC_GetBlock_2(block, firstFrame)
+ *
+ * Hands out every decimated block once, oldest first.
+ *
+ * @return  (int8_t)    TRUE if a block was pending.
+ */
+int8_t ADC_GetBlock_2(const uint16_t **block, uint32_t *firstFrame)
+{
+    uint32_t completed = blockCount;
+    if (completed == blockConsumed)
+    {
+        return FALSE;
+    }
+
+    // The next block is decimated into the slot of the oldest one, so a
+    // consumer that far behind could read it half overwritten
+    if ((completed - blockConsumed) > (ADC_BUFFER_BLOCKS - 1))
+    {
+        blocksDropped += (completed - blockConsumed) - (ADC_BUFFER_BLOCKS - 1);
+        blockConsumed = completed - (ADC_BUFFER_BLOCKS - 1);
+    }
+
+    uint32_t frame = blockConsumed * ADC_BLOCK_FRAMES;
+    blockConsumed++;
+    *block = adcFrames[frame % ADC_BUFFER_FRAMES];
+    *firstFrame = frame;
+    return TRUE;
+}
+
+/** ADC_GetRawBlock_2(block, firstScan)
+ *
+ * Hands out the newest completed half of the raw DMA buffer once.
+ *
+ * @return  (int8_t)    TRUE if a new block was available.
+ */
+int8_t ADC_GetRawBlock_2(const uint16_t **block, uint32_t *firstScan)
+{
+    uint32_t completed = blockCount;
+    if (completed == rawConsumed)
+    {
+        return FALSE;
+    }
+    rawConsumed = completed;
+
+    // Odd counts finished the first half, even counts the second half.
+    *block = adcRaw[(completed & 1) ? 0 : 1][0];
+    *firstScan = (completed - 1) * ADC_BLOCK_SCANS;
+    return TRUE;
+}
 
-	return HAL_ADC_GetValue(&hadc1);
+/** ADC_GetDroppedBlocks_2()
+ *
+ * @return  (uint32_t)  Decimated blocks overwritten before they were handed out.
+ */
+uint32_t ADC_GetDroppedBlocks_2(void)
+{
+    return blocksDropped;
+}
+
+/** ADC_SetBlockCallback_2(callback)
+ *
+ * Registers the block-ready notification.
+ */
+void ADC_SetBlockCallback_2(void (*callback)(void))
+{
+    blockCallback = callback;
+}
+
+/** ADC_GetFrameCount_2()
+ *
+ * @return  (uint32_t)  Number of decimated frames produced since ADC_Init_2().
+ */
+uint32_t ADC_GetFrameCount_2(void)
+{
+    return blockCount * ADC_BLOCK_FRAMES;
+}
+
+/* DMA half/complete callbacks: one half of the raw buffer is ready. */
+void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef *hadc)
+{
+    if (hadc->Instance == ADC1)
+    {
+        ADC_DecimateBlock(0);
+    }
+}
+
+void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc)
+{
+    if (hadc->Instance == ADC1)
+    {
+        ADC_DecimateBlock(1);
+    }
+}
+
+void DMA2_Stream0_IRQHandler(void)
+{
+    HAL_DMA_IRQHandler(&hdma_adc1);
 }
 
 /** ADC_Init()
@@ -139,33 +395,49 @@ int8_t ADC_Init_2(void)
         hadc1.Instance = ADC1;
         hadc1.Init.ClockPrescaler = ADC_CLOCK_SYNC_PCLK_DIV4;
         hadc1.Init.Resolution = ADC_RESOLUTION_12B;
-        hadc1.Init.ScanConvMode = DISABLE;
-        hadc1.Init.ContinuousConvMode = ENABLE;
+        hadc1.Init.ScanConvMode = ENABLE;
+        hadc1.Init.ContinuousConvMode = DISABLE;
         hadc1.Init.DiscontinuousConvMode = DISABLE;
-        hadc1.Init.ExternalTrigConvEdge = ADC_EXTERNALTRIGCONVEDGE_NONE;
-        hadc1.Init.ExternalTrigConv = ADC_SOFTWARE_START;
+        hadc1.Init.ExternalTrigConvEdge = ADC_EXTERNALTRIGCONVEDGE_RISING;
+        hadc1.Init.ExternalTrigConv = ADC_EXTERNALTRIGCONV_T3_TRGO;
         hadc1.Init.DataAlign = ADC_DATAALIGN_RIGHT;
-		hadc1.Init.NbrOfConversion = 1;
-        hadc1.Init.DMAContinuousRequests = DISABLE;
-        hadc1.Init.EOCSelection = ADC_EOC_SINGLE_CONV;
+		hadc1.Init.NbrOfConversion = ADC_NUM_CHANNELS;
+        hadc1.Init.DMAContinuousRequests = ENABLE;
+        hadc1.Init.EOCSelection = ADC_EOC_SEQ_CONV;
 
         if (HAL_ADC_Init(&hadc1) != HAL_OK)
         {
           return ERROR;
         }
 
-		// By default, select onboard potentiometer.
+		// One rank per piezo channel, in finger order.
         ADC_ChannelConfTypeDef sConfig = {0};
-		sConfig.Channel = POT;
-		sConfig.Rank = 1;
-		sConfig.SamplingTime = ADC_SAMPLETIME_3CYCLES;
-		if (HAL_ADC_ConfigChannel(&hadc1, &sConfig) != HAL_OK)
+        for (uint8_t ch = 0; ch < ADC_CHANNEL_COUNT; ch++)
         {
-			return ERROR;
-		}
+            channelRank[ch] = ADC_RANK_NONE;
+        }
+        for (uint8_t rank = 0; rank < ADC_NUM_CHANNELS; rank++)
+        {
+            sConfig.Channel = scanSequence[rank];
+            sConfig.Rank = rank + 1;
+            sConfig.SamplingTime = ADC_SAMPLETIME_15CYCLES;   // 7 x 2.25 us per scan
+            if (HAL_ADC_ConfigChannel(&hadc1, &sConfig) != HAL_OK)
+            {
+                return ERROR;
+            }
+            channelRank[scanSequence[rank]] = rank;
+        }
 
-        // Start ADC.
-        ADC_Start_2();
+        if ((ADC_ConfigDMA() != SUCCESS) || (ADC_ConfigTrigger() != SUCCESS))
+        {
+            return ERROR;
+        }
+
+        // Start background acquisition.
+        if (ADC_Start_2() != SUCCESS)
+        {
+            return ERROR;
+        }
 
         // Complete initialization.
         initStatus = TRUE;
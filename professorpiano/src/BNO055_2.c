@@ -15,6 +15,7 @@
  #include <BNO055_2.h> 
  #include <timers.h>
  #include <Board_2.h>
+ #include <Log.h>
  
  
  /*  MODULE-LEVEL DEFINITIONS, MACROS    */
@@ -267,9 +268,11 @@
      TIMER_Init(); // Initialize timer module for delay functions.
      if (I2C_Init_2() != SUCCESS)
      {
-         printf("I2C initialization error\r\n");
+         LOG_ERROR(LOG_IMU, "I2C initialization error\r\n");
          return ERROR;
      }
+     // Samples feed the gesture detector, never wait behind display traffic.
+     I2C_ConfigureDevice_2(address, I2C_PRIORITY_HIGH, 0, 0);
  
      unsigned char byteReturn;
      // Delaying to ensure that successive programs do not glitch the sensor.
@@ -284,7 +287,7 @@
      byteReturn = I2C_ReadRegister_2(address, BNO055_CHIP_ID_ADDR);
      if (byteReturn != BNO055_ID)
      {
-        printf("BNO055 at 0x%x not detected!\n", address);
+        LOG_ERROR(LOG_IMU, "BNO055 at 0x%x not detected!\n", address);
          return ERROR;
      }
  
@@ -344,11 +347,220 @@
          OPERATION_MODE_AMG
      );
      DelayMicros_2(30000);
-     printf("BNO055 initialized at 0x%x\n", address);
+     LOG_INFO(LOG_IMU, "BNO055 initialized at 0x%x\n", address);
      return byteReturn;
 
  }
  
+ /** BNO055_ReadSample_2(address, sample)
+  *
+  * Reads all nine raw axes (registers 0x08-0x19) in one transaction.
+  *
+  * @return  (int8_t)    [SUCCESS, ERROR]
+  */
+ int8_t BNO055_ReadSample_2(uint8_t address, BNO055_Sample_t *sample)
+ {
+     return I2C_ReadRegisters_2(address, BNO055_SAMPLE_START_ADDR, (uint8_t *)sample, sizeof(*sample));
+ }
+
+ /** BNO055_ReadSampleAsync_2(transaction, address, sample, callback)
+  *
+  * Queues the raw axes read without waiting for it.
+  *
+  * @return  (int8_t)    [SUCCESS, ERROR]
+  */
+ int8_t BNO055_ReadSampleAsync_2(I2C_Transaction_t *transaction, uint8_t address,
+                                 BNO055_Sample_t *sample, I2C_Callback_t callback)
+ {
+     if (I2C_InFlight_2(transaction))
+     {
+         return ERROR; // Still queued from the last call
+     }
+     transaction->address = address;
+     transaction->op = I2C_OP_READ_REG;
+     transaction->reg = BNO055_SAMPLE_START_ADDR;
+     transaction->data = (uint8_t *)sample;
+     transaction->length = sizeof(*sample);
+     transaction->callback = callback;
+     return I2C_Submit_2(transaction);
+ }
+
+ /** BNO055_EnableFusion_2(address)
+  *
+  * CONFIG -> NDOF.
+  *
+  * @return  (int8_t)    [SUCCESS, ERROR]
+  */
+ int8_t BNO055_EnableFusion_2(uint8_t address)
+ {
+     if (I2C_WriteReg_2(address, BNO055_OPR_MODE_ADDR, OPERATION_MODE_CONFIG) != SUCCESS)
+     {
+         return ERROR;
+     }
+     // Delay between changing op modes > 19 msec.
+     DelayMicros_2(25000);
+     if (I2C_WriteReg_2(address, BNO055_OPR_MODE_ADDR, OPERATION_MODE_NDOF) != SUCCESS)
+     {
+         return ERROR;
+     }
+     DelayMicros_2(25000);
+     return SUCCESS;
+ }
+
+ /** BNO055_ReadFusion_2(address, fusion)
+  *
+  * Reads quaternion and linear acceleration (registers 0x20-0x2D).
+  *
+  * @return  (int8_t)    [SUCCESS, ERROR]
+  */
+ int8_t BNO055_ReadFusion_2(uint8_t address, BNO055_Fusion_t *fusion)
+ {
+     return I2C_ReadRegisters_2(address, BNO055_FUSION_START_ADDR, (uint8_t *)fusion, sizeof(*fusion));
+ }
+
+ /** BNO055_ReadFusionAsync_2(transaction, address, fusion, callback)
+  *
+  * Queues the fusion read without waiting for it.
+  *
+  * @return  (int8_t)    [SUCCESS, ERROR]
+  */
+ int8_t BNO055_ReadFusionAsync_2(I2C_Transaction_t *transaction, uint8_t address,
+                                 BNO055_Fusion_t *fusion, I2C_Callback_t callback)
+ {
+     if (I2C_InFlight_2(transaction))
+     {
+         return ERROR; // Still queued from the last call
+     }
+     transaction->address = address;
+     transaction->op = I2C_OP_READ_REG;
+     transaction->reg = BNO055_FUSION_START_ADDR;
+     transaction->data = (uint8_t *)fusion;
+     transaction->length = sizeof(*fusion);
+     transaction->callback = callback;
+     return I2C_Submit_2(transaction);
+ }
+
+ // INT_MSK / INT_EN bits (page 1)
+ #define BNO055_INT_GYR_AM   (0x04)
+ #define BNO055_INT_ACC_AM   (0x40)
+ // ACC_INT_SETTINGS: any-motion on X, Y and Z, one sample duration
+ #define BNO055_ACC_AM_XYZ   (0x1C)
+ // GYR_INT_SETTINGS: any-motion on X, Y and Z, filtered data off
+ #define BNO055_GYR_AM_XYZ   (0x07)
+ // SYS_TRIGGER: reset all interrupt status bits and the INT output
+ #define BNO055_RST_INT      (0x40)
+
+ static void (*interruptCallback)(void) = NULL;
+ static uint8_t rstIntValue = BNO055_RST_INT;   // Buffer for the async clear
+
+ /** BNO055_EnableMotionInterrupt_2(address, accelThreshold, gyroThreshold)
+  *
+  * Configures accel/gyro any-motion interrupts on the INT pin.
+  *
+  * @return  (int8_t)    [SUCCESS, ERROR]
+  */
+ int8_t BNO055_EnableMotionInterrupt_2(uint8_t address, uint8_t accelThreshold, uint8_t gyroThreshold)
+ {
+     uint8_t mode = I2C_ReadRegister_2(address, BNO055_OPR_MODE_ADDR) & 0x0F;
+     const uint8_t writes[][2] = {
+         {BNO055_OPR_MODE_ADDR, OPERATION_MODE_CONFIG},
+         {BNO055_PAGE_ID_ADDR, BNO055_PAGE1},
+         {BNO055_ACC_AM_THRES, accelThreshold},
+         {BNO055_ACC_INT_SETTINGS, BNO055_ACC_AM_XYZ},
+         {BNO055_GYR_AM_THRES, gyroThreshold},
+         {BNO055_GYR_INT_SETTINGS, BNO055_GYR_AM_XYZ},
+         {BNO055_INT_MSK, BNO055_INT_ACC_AM | BNO055_INT_GYR_AM},
+         {BNO055_INT_EN, BNO055_INT_ACC_AM | BNO055_INT_GYR_AM},
+         {BNO055_PAGE_ID_ADDR, BNO055_PAGE0},
+         {BNO055_SYS_TRIGGER_ADDR, BNO055_RST_INT},
+         {BNO055_OPR_MODE_ADDR, mode}
+     };
+
+     int8_t status = SUCCESS;
+     for (uint8_t i = 0; i < sizeof(writes) / sizeof(writes[0]); i++)
+     {
+         if (I2C_WriteReg_2(address, writes[i][0], writes[i][1]) != SUCCESS)
+         {
+             status = ERROR;
+         }
+         if (i == 0)
+         {
+             // Delay between changing op modes > 19 msec.
+             DelayMicros_2(25000);
+         }
+     }
+     DelayMicros_2(25000);
+     return status;
+ }
+
+ /** BNO055_InitInterruptPin_2(callback)
+  *
+  * Rising-edge EXTI on the INT pin.
+  */
+ void BNO055_InitInterruptPin_2(void (*callback)(void))
+ {
+     GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+     interruptCallback = callback;
+     __HAL_RCC_GPIOB_CLK_ENABLE();
+     GPIO_InitStruct.Pin = BNO055_INT_PIN;
+     GPIO_InitStruct.Mode = GPIO_MODE_IT_RISING;
+     GPIO_InitStruct.Pull = GPIO_PULLDOWN;
+     HAL_GPIO_Init(BNO055_INT_PORT, &GPIO_InitStruct);
+
+     HAL_NVIC_SetPriority(BNO055_INT_IRQn, 0, 0);
+     HAL_NVIC_EnableIRQ(BNO055_INT_IRQn);
+ }
+
+ int8_t BNO055_InterruptPending_2(void)
+ {
+     return (HAL_GPIO_ReadPin(BNO055_INT_PORT, BNO055_INT_PIN) == GPIO_PIN_SET) ? TRUE : FALSE;
+ }
+
+ /** BNO055_ClearInterruptAsync_2(transaction, address)
+  *
+  * Queues the RST_INT write without waiting for it.
+  *
+  * @return  (int8_t)    [SUCCESS, ERROR]
+  */
+ int8_t BNO055_ClearInterruptAsync_2(I2C_Transaction_t *transaction, uint8_t address)
+ {
+     if (I2C_InFlight_2(transaction))
+     {
+         return ERROR; // Still queued from the last call
+     }
+     transaction->address = address;
+     transaction->op = I2C_OP_WRITE_REG;
+     transaction->reg = BNO055_SYS_TRIGGER_ADDR;
+     transaction->data = &rstIntValue;
+     transaction->length = 1;
+     transaction->callback = NULL;
+     return I2C_Submit_2(transaction);
+ }
+
+ void EXTI4_IRQHandler(void)
+ {
+     if (__HAL_GPIO_EXTI_GET_IT(BNO055_INT_PIN))
+     {
+         __HAL_GPIO_EXTI_CLEAR_IT(BNO055_INT_PIN);
+         if (interruptCallback != NULL)
+         {
+             interruptCallback();
+         }
+     }
+ }
+
+ /** BNO055_ReadRegisters_2(address, startRegister, data, length)
+  *
+  * Reads a contiguous register range in one transaction.
+  *
+  * @return  (int8_t)    [SUCCESS, ERROR]
+  */
+ int8_t BNO055_ReadRegisters_2(uint8_t address, uint8_t startRegister, uint8_t *data, uint16_t length)
+ {
+     return I2C_ReadRegisters_2(address, startRegister, data, length);
+ }
+
  /** BNO055_ReadAccelX()
   *
   * Reads sensor axis as given by name.
@@ -462,6 +674,11 @@
  void DelayMicros_2(uint32_t microsec)
  {
      uint32_t curr_us = TIMERS_GetMicroSeconds();
+     // Sleep until the 1 ms timer tick while more than a tick is left, spin the rest.
+     while (((TIMERS_GetMicroSeconds() - curr_us) + 1000) < microsec)
+     {
+         __WFI();
+     }
      while ((TIMERS_GetMicroSeconds() - curr_us) < microsec);
  }
  
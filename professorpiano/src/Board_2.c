@@ -9,6 +9,7 @@
  #include <Board_2.h>
  #include <leds.h>
  #include <stdio.h>
+ #include <SerialLog.h>
  
  /*  PROTOTYPES  */
  static int8_t  Nucleo_ConfigSysClk_2(void);
@@ -18,6 +19,7 @@
  static int8_t  Serial_ConfigPins_2(void);
  //  -- Removed the custom Serial_BRRCalculator, let HAL do it --
  static int8_t  Serial_Begin_2(void);
+ static int8_t  Serial_ConfigDMA_2(void);
  static int8_t  Serial_Init_2(void);
  void           Error_Handler_2(void);
  
@@ -26,6 +28,7 @@
  
  // Define UART2 handler and setup printf() functionality.
  UART_HandleTypeDef huart2;
+ DMA_HandleTypeDef  hdma_usart2_tx;
  
  #ifdef __GNUC__
   #define PUTCHAR_PROTOTYPE int __io_putchar_2(int ch)
@@ -35,9 +38,11 @@
   #define GETCHAR_PROTOTYPE int fgetc(FILE *f)
  #endif
  
+ // Goes through the DMA-drained console ring like printf (see SerialLog.c).
  PUTCHAR_PROTOTYPE
  {
-     HAL_UART_Transmit(&huart2, (uint8_t *)&ch, 1, HAL_MAX_DELAY);
+     uint8_t byte = (uint8_t)ch;
+     SerialLog_Write(&byte, 1);
      return ch;
  }
  
@@ -164,7 +169,7 @@
  static int8_t Serial_Begin_2(void)
  {
      huart2.Instance          = USART2;
-     huart2.Init.BaudRate     = SERIAL_BAUDRATE; // 115200
+     huart2.Init.BaudRate     = SERIAL_BAUDRATE; // 115200 unless changed
      huart2.Init.WordLength   = UART_WORDLENGTH_8B;
      huart2.Init.StopBits     = UART_STOPBITS_1;
      huart2.Init.Parity       = UART_PARITY_NONE;
@@ -178,6 +183,36 @@
      return SUCCESS;
  }
  
+ /**
+  * Link DMA1 Stream6 / Channel 4 (USART2_TX) to UART2 so bulk output can be
+  * sent without blocking the CPU.
+  */
+ static int8_t Serial_ConfigDMA_2(void)
+ {
+     __HAL_RCC_DMA1_CLK_ENABLE();
+
+     hdma_usart2_tx.Instance                 = DMA1_Stream6;
+     hdma_usart2_tx.Init.Channel             = DMA_CHANNEL_4;
+     hdma_usart2_tx.Init.Direction           = DMA_MEMORY_TO_PERIPH;
+     hdma_usart2_tx.Init.PeriphInc           = DMA_PINC_DISABLE;
+     hdma_usart2_tx.Init.MemInc              = DMA_MINC_ENABLE;
+     hdma_usart2_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+     hdma_usart2_tx.Init.MemDataAlignment    = DMA_MDATAALIGN_BYTE;
+     hdma_usart2_tx.Init.Mode                = DMA_NORMAL;
+     hdma_usart2_tx.Init.Priority            = DMA_PRIORITY_LOW; // Audio DMA stays on top
+     hdma_usart2_tx.Init.FIFOMode            = DMA_FIFOMODE_DISABLE;
+     if (HAL_DMA_Init(&hdma_usart2_tx) != HAL_OK) {
+         return ERROR;
+     }
+     __HAL_LINKDMA(&huart2, hdmatx, hdma_usart2_tx);
+
+     HAL_NVIC_SetPriority(DMA1_Stream6_IRQn, 5, 0);
+     HAL_NVIC_EnableIRQ(DMA1_Stream6_IRQn);
+     HAL_NVIC_SetPriority(USART2_IRQn, 5, 0);
+     HAL_NVIC_EnableIRQ(USART2_IRQn);
+     return SUCCESS;
+ }
+
  /**
   * Complete the serial initialization steps.
   */
@@ -185,8 +220,70 @@
  {
      Serial_ConfigPins_2();
      Serial_Begin_2();
+     return Serial_ConfigDMA_2();
+ }
+
+ /**
+  * Re-open UART2 at a new baud rate. Any DMA transfer in flight is aborted.
+  */
+ int8_t BOARD_SetBaudrate_2(uint32_t baudrate)
+ {
+     HAL_UART_Abort(&huart2);
+     huart2.Init.BaudRate = baudrate;
+     if (HAL_UART_Init(&huart2) != HAL_OK) {
+         return ERROR;
+     }
      return SUCCESS;
  }
+
+ /**
+  * Kick off a non-blocking UART2 transmission.
+  */
+ int8_t BOARD_SerialWriteDMA_2(const uint8_t *data, uint16_t size)
+ {
+     if (HAL_UART_Transmit_DMA(&huart2, (uint8_t *)data, size) != HAL_OK) {
+         return ERROR;
+     }
+     return SUCCESS;
+ }
+
+ /**
+  * TRUE while UART2 is still shifting out a previous transmission.
+  */
+ int8_t BOARD_SerialBusy_2(void)
+ {
+     return (huart2.gState != HAL_UART_STATE_READY) ? TRUE : FALSE;
+ }
+
+ /**
+  * HAL_Delay
+  * Overrides the weak HAL version: sleeps between SysTick interrupts instead of
+  * spinning on HAL_GetTick(), with the same "at least Delay ms" guarantee.
+  */
+ void HAL_Delay(uint32_t Delay)
+ {
+     uint32_t tickstart = HAL_GetTick();
+     uint32_t wait = Delay;
+ 
+     if (wait < HAL_MAX_DELAY)
+     {
+         wait += (uint32_t)(uwTickFreq);
+     }
+     while ((HAL_GetTick() - tickstart) < wait)
+     {
+         __WFI();
+     }
+ }
+ 
+ void DMA1_Stream6_IRQHandler(void)
+ {
+     HAL_DMA_IRQHandler(&hdma_usart2_tx);
+ }
+
+ void USART2_IRQHandler(void)
+ {
+     HAL_UART_IRQHandler(&huart2);
+ }
  
  /******************************************************************************
   *                        ONBOARD NUCLEO FUNCTIONALITY
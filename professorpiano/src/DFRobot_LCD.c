@@ -3,6 +3,14 @@
 #include <string.h>
 
 #include "I2C_2.h"
+#include "Board_2.h"   /*  SUCCESS / ERROR */
+
+/*  Display traffic is bulk: it yields the bus to IMU reads every slice. */
+#define LCD_I2C_SLICE 8
+
+/*  Control bytes of the LCD backpack: a command, or data up to the STOP. */
+#define LCD_CONTROL_COMMAND 0x80
+#define LCD_CONTROL_DATA    0x40
 
 /*  A small 2D array of color definitions, as in the original code. */
 static const uint8_t color_define[4][3] = {
@@ -16,34 +24,28 @@ static const uint8_t color_define[4][3] = {
  * @brief Low-level helper: send multiple bytes in ONE i2c transaction
  *        (replicates Wire.beginTransmission() / write() / endTransmission()).
  */
-static void i2cSendBytes(uint8_t i2cAddr, const uint8_t *buf, size_t len)
+static int8_t i2cSendBytes(DFRobot_RGBLCD_t *p, uint8_t i2cAddr, const uint8_t *buf, size_t len)
 {
-    /*  i2cAddr is the 7-bit address; HAL expects 8-bit in hi2cX calls -> shift left 1. */
-    HAL_StatusTypeDef ret = HAL_I2C_Master_Transmit(&hi2c2, (i2cAddr << 1), (uint8_t*)buf, len, 100);
-    if(ret != HAL_OK)
+    /*  Goes through the shared I2C2 queue so it cannot collide with IMU reads.
+     *  Fails at once while the I2C driver has the device marked offline. */
+    if(I2C_Write_2(i2cAddr, buf, (uint16_t)len) != SUCCESS)
     {
-        //error
+        p->i2cErrors++;
+        return ERROR;
     }
+    return SUCCESS;
 }
 
 /*!
  * @brief Send command vs. data to the LCD. The DFRobot “backpack” expects
  *        first byte = control (0x80 for cmd, 0x40 for data), second byte = payload
  */
-static void lcdCommand(DFRobot_RGBLCD_t *p, uint8_t cmd)
+static int8_t lcdCommand(DFRobot_RGBLCD_t *p, uint8_t cmd)
 {
     uint8_t data[2];
-    data[0] = 0x80;   /* indicate “command” */
+    data[0] = LCD_CONTROL_COMMAND;
     data[1] = cmd;
-    i2cSendBytes(p->lcdAddr, data, 2);
-}
-
-static void lcdWrite(DFRobot_RGBLCD_t *p, uint8_t value)
-{
-    uint8_t data[2];
-    data[0] = 0x40;   /* indicate “data” */
-    data[1] = value;
-    i2cSendBytes(p->lcdAddr, data, 2);
+    return i2cSendBytes(p, p->lcdAddr, data, 2);
 }
 
 /*!
@@ -54,7 +56,10 @@ static void setReg(DFRobot_RGBLCD_t *p, uint8_t addr, uint8_t data)
     /*  The DFRobot board’s RGB chip is memory-mapped, so we can do:
      *    I2C_WriteReg_2() or HAL_I2C_Mem_Write() with the “register address” = addr
      */
-    I2C_WriteReg_2(p->rgbAddr, addr, data);
+    if(I2C_WriteReg_2(p->rgbAddr, addr, data) != SUCCESS)
+    {
+        p->i2cErrors++;
+    }
     /*  or do the full HAL call directly, e.g.:
      *  HAL_I2C_Mem_Write(&hi2c2, (p->rgbAddr << 1),
      *                    addr, I2C_MEMADD_SIZE_8BIT,
@@ -62,6 +67,107 @@ static void setReg(DFRobot_RGBLCD_t *p, uint8_t addr, uint8_t data)
      */
 }
 
+/*!
+ * @brief Shadow framebuffer helpers. The glass is assumed blank after a
+ *        clear, so shown starts as spaces.
+ */
+static void shadowReset(DFRobot_RGBLCD_t *p)
+{
+    memset(p->frame, ' ', sizeof(p->frame));
+    memset(p->shown, ' ', sizeof(p->shown));
+    memset(p->dirty, 0, sizeof(p->dirty));
+    memset(p->stale, 0, sizeof(p->stale));
+    p->cursorCol = 0;
+    p->cursorRow = 0;
+}
+
+static void shadowPut(DFRobot_RGBLCD_t *p, uint8_t ch)
+{
+    uint8_t row = p->cursorRow;
+    uint8_t col = p->cursorCol;
+    if(col >= LCD_MAX_COLS)
+    {
+        return;
+    }
+    p->cursorCol++;
+
+    p->frame[row][col] = ch;
+    if((ch != p->shown[row][col]) || (p->stale[row] & (1u << col)))
+    {
+        p->dirty[row] |= (uint16_t)(1u << col);
+    }
+    else
+    {
+        p->dirty[row] &= (uint16_t)~(1u << col);
+    }
+}
+
+/*!
+ * @brief Finds the next changed run in a row at or after *col, swallowing
+ *        clean gaps of up to LCD_MERGE_GAP cells.
+ * @return 0 when the row has no more changes
+ */
+static uint8_t shadowNextRun(const DFRobot_RGBLCD_t *p, uint8_t row, uint8_t *col, uint8_t *first, uint8_t *length)
+{
+    uint16_t dirty = p->dirty[row];
+    uint8_t c = *col;
+    if((c >= LCD_MAX_COLS) || !(dirty >> c))
+    {
+        return 0;
+    }
+
+    while(!(dirty & (1u << c))) c++;
+    uint8_t last = c;
+    *first = c;
+    for(c = *first + 1; c < LCD_MAX_COLS && c <= last + LCD_MERGE_GAP + 1; c++)
+    {
+        if(dirty & (1u << c)) last = c;
+    }
+    *col = last + 1;
+    *length = last - *first + 1;
+    return 1;
+}
+
+/*!
+ * @brief Bookkeeping once a run made it to the glass, or did not.
+ */
+static void shadowRunSent(DFRobot_RGBLCD_t *p, uint8_t row, uint8_t first, uint8_t length)
+{
+    uint16_t mask = (uint16_t)(((1u << length) - 1u) << first);
+    memcpy(&p->shown[row][first], &p->frame[row][first], length);
+    p->dirty[row] &= (uint16_t)~mask;
+    p->stale[row] &= (uint16_t)~mask;
+    p->flushedBytes += length;
+}
+
+static void shadowRunFailed(DFRobot_RGBLCD_t *p, uint8_t row, uint8_t first, uint8_t length)
+{
+    uint16_t mask = (uint16_t)(((1u << length) - 1u) << first);
+    p->stale[row] |= mask;
+    p->dirty[row] |= mask;
+    p->i2cErrors++;
+}
+
+/*!
+ * @brief Blocking CGRAM write: address command, then all eight rows as one
+ *        data transfer.
+ */
+static int8_t cgramUpload(DFRobot_RGBLCD_t *p, uint8_t location)
+{
+    if(lcdCommand(p, LCD_SETCGRAMADDR | (location << 3)) != SUCCESS)
+    {
+        return ERROR;
+    }
+    if(I2C_WriteRegisters_2(p->lcdAddr, LCD_CONTROL_DATA, p->cgram[location], LCD_GLYPH_ROWS) != SUCCESS)
+    {
+        p->i2cErrors++;
+        return ERROR;
+    }
+    p->cgramDirty &= (uint8_t)~(1u << location);
+    p->cgramUploads++;
+    return SUCCESS;
+}
+
 /*!
  * @brief Internal “begin” used by the init function
  */
@@ -117,8 +223,18 @@ void DFRobot_RGBLCD_Init(DFRobot_RGBLCD_t *p, uint8_t lcdCols, uint8_t lcdRows,
     I2C_Init_2();
     I2C_ScanBus_LCD_ADDRESS();
     I2C_ScanBus_RGB_ADDRESS();
+    I2C_ConfigureDevice_2(lcdAddr, I2C_PRIORITY_BULK, LCD_I2C_SLICE, I2C_FIXED_REGISTER);
+    I2C_ConfigureDevice_2(rgbAddr, I2C_PRIORITY_BULK, LCD_I2C_SLICE, 0);
 
     p->lcdAddr = lcdAddr;
+    p->i2cErrors = 0;
+    p->numRuns = 0;
+    p->numUploads = 0;
+
+    /*  CGRAM content is unknown after power-up; nothing is loaded. */
+    memset(p->cgram, 0, sizeof(p->cgram));
+    p->cgramDirty = 0;
+    p->cgramUploads = 0;
     p->rgbAddr = rgbAddr;
     p->cols = lcdCols;
     p->rows = lcdRows;
@@ -128,6 +244,8 @@ void DFRobot_RGBLCD_Init(DFRobot_RGBLCD_t *p, uint8_t lcdCols, uint8_t lcdRows,
     p->displayMode     = 0;
     p->currline        = 0;
     p->numlines        = lcdRows;
+    p->flushedBytes    = 0;
+    shadowReset(p);
 
     /*  Kick off the HD44780 init sequence. */
     lcdBegin(p, lcdCols, lcdRows, 0);
@@ -139,6 +257,7 @@ void DFRobot_RGBLCD_Init(DFRobot_RGBLCD_t *p, uint8_t lcdCols, uint8_t lcdRows,
 void DFRobot_RGBLCD_Clear(DFRobot_RGBLCD_t *p)
 {
     lcdCommand(p, LCD_CLEARDISPLAY);
+    shadowReset(p);
     /*  The data sheet says clearing can take >1ms, so wait at least 2ms. */
     HAL_Delay(2);
 }
@@ -222,43 +341,223 @@ void DFRobot_RGBLCD_AutoScrollOff(DFRobot_RGBLCD_t *p)
 
 void DFRobot_RGBLCD_SetCursor(DFRobot_RGBLCD_t *p, uint8_t col, uint8_t row)
 {
-    /*  On a typical 16x2: row=0 => 0x80 + col, row=1 => 0xC0 + col. */
-    /*  Adjust for your own LCD if it has more lines or custom mapping. */
-    if(row > 1) row = 1; /* or handle bigger? */
+    /*  Only moves the shadow cursor; Flush() addresses every run itself. */
+    if(row >= LCD_MAX_ROWS) row = LCD_MAX_ROWS - 1;
 
-    uint8_t val = (row == 0) ? (0x80 | col) : (0xC0 | col);
-    uint8_t data[2];
-    data[0] = 0x80;  /* command byte */
-    data[1] = val;
-    i2cSendBytes(p->lcdAddr, data, 2);
+    p->cursorCol = col;
+    p->cursorRow = row;
 }
 
 void DFRobot_RGBLCD_WriteChar(DFRobot_RGBLCD_t *p, uint8_t ch)
 {
-    lcdWrite(p, ch);
+    shadowPut(p, ch);
+    DFRobot_RGBLCD_Flush(p);
 }
 
-void DFRobot_RGBLCD_Print(DFRobot_RGBLCD_t *p, const char *str)
+void DFRobot_RGBLCD_BufferPrint(DFRobot_RGBLCD_t *p, const char *str)
 {
     while(*str)
     {
-        lcdWrite(p, (uint8_t)(*str));
+        shadowPut(p, (uint8_t)(*str));
         str++;
     }
 }
 
+void DFRobot_RGBLCD_Print(DFRobot_RGBLCD_t *p, const char *str)
+{
+    DFRobot_RGBLCD_BufferPrint(p, str);
+    DFRobot_RGBLCD_Flush(p);
+}
+
+int8_t DFRobot_RGBLCD_Flush(DFRobot_RGBLCD_t *p)
+{
+    p->flushCount++;
+
+    /*  Glyphs first, so new characters never show a stale bitmap. The
+     *  DDRAM address command of each run moves the LCD out of CGRAM. */
+    for(uint8_t slot = 0; slot < LCD_CGRAM_SLOTS; slot++)
+    {
+        if((p->cgramDirty & (1u << slot)) && (cgramUpload(p, slot) != SUCCESS))
+        {
+            return ERROR;
+        }
+    }
+
+    for(uint8_t row = 0; row < LCD_MAX_ROWS; row++)
+    {
+        uint8_t col = 0, first, length;
+        while(shadowNextRun(p, row, &col, &first, &length))
+        {
+            /*  One DDRAM address command, then the whole run as data. A
+             *  run that fails stays dirty and goes out on the next flush. */
+            uint8_t address = (row == 0) ? (0x80 | first) : (0xC0 | first);
+            if(lcdCommand(p, address) != SUCCESS)
+            {
+                return ERROR;
+            }
+            if(I2C_WriteRegisters_2(p->lcdAddr, LCD_CONTROL_DATA, &p->frame[row][first], length) != SUCCESS)
+            {
+                shadowRunFailed(p, row, first, length);
+                return ERROR;
+            }
+            shadowRunSent(p, row, first, length);
+        }
+    }
+    return SUCCESS;
+}
+
+uint8_t DFRobot_RGBLCD_FlushBusy(const DFRobot_RGBLCD_t *p)
+{
+    for(uint8_t u = 0; u < p->numUploads; u++)
+    {
+        if(I2C_InFlight_2(&p->uploads[u].command) || I2C_InFlight_2(&p->uploads[u].data))
+        {
+            return 1;
+        }
+    }
+    for(uint8_t r = 0; r < p->numRuns; r++)
+    {
+        if(I2C_InFlight_2(&p->runs[r].command) || I2C_InFlight_2(&p->runs[r].data))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int8_t DFRobot_RGBLCD_FlushAsync(DFRobot_RGBLCD_t *p)
+{
+    if(DFRobot_RGBLCD_FlushBusy(p))
+    {
+        return ERROR;
+    }
+
+    /*  The last flush assumed success; undo that for what failed. An
+     *  upload the driver rejected was never counted. */
+    for(uint8_t u = 0; u < p->numUploads; u++)
+    {
+        DFRobot_RGBLCD_Run_t *upload = &p->uploads[u];
+        if((upload->command.status == I2C_FAILED) || (upload->data.status == I2C_FAILED))
+        {
+            p->cgramDirty |= (uint8_t)(1u << upload->first);
+            if(upload->queued)
+            {
+                p->cgramUploads--;
+            }
+            p->i2cErrors++;
+        }
+    }
+    for(uint8_t r = 0; r < p->numRuns; r++)
+    {
+        DFRobot_RGBLCD_Run_t *run = &p->runs[r];
+        if((run->command.status == I2C_FAILED) || (run->data.status == I2C_FAILED))
+        {
+            shadowRunFailed(p, run->row, run->first, run->length);
+        }
+    }
+    p->numRuns = 0;
+    p->numUploads = 0;
+    p->flushCount++;
+
+    for(uint8_t slot = 0; slot < LCD_CGRAM_SLOTS; slot++)
+    {
+        if(!(p->cgramDirty & (1u << slot)))
+        {
+            continue;
+        }
+        DFRobot_RGBLCD_Run_t *upload = &p->uploads[p->numUploads];
+        upload->first = slot;
+        upload->length = LCD_GLYPH_ROWS;
+        upload->queued = 0;
+        upload->commandBytes[0] = LCD_CONTROL_COMMAND;
+        upload->commandBytes[1] = LCD_SETCGRAMADDR | (slot << 3);
+        memcpy(upload->dataBytes, p->cgram[slot], LCD_GLYPH_ROWS);
+
+        upload->command = (I2C_Transaction_t){
+            .address = p->lcdAddr,
+            .op = I2C_OP_WRITE,
+            .data = upload->commandBytes,
+            .length = 2,
+        };
+        upload->data = (I2C_Transaction_t){
+            .address = p->lcdAddr,
+            .op = I2C_OP_WRITE_REG,
+            .reg = LCD_CONTROL_DATA,
+            .data = upload->dataBytes,
+            .length = LCD_GLYPH_ROWS,
+        };
+
+        p->numUploads++;
+        if((I2C_Submit_2(&upload->command) != SUCCESS) || (I2C_Submit_2(&upload->data) != SUCCESS))
+        {
+            /*  Characters must not go out ahead of their glyph. */
+            return SUCCESS;
+        }
+        p->cgramDirty &= (uint8_t)~(1u << slot);
+        p->cgramUploads++;
+        upload->queued = 1;
+    }
+
+    for(uint8_t row = 0; row < LCD_MAX_ROWS; row++)
+    {
+        uint8_t col = 0, first, length;
+        while((p->numRuns < LCD_MAX_RUNS) && shadowNextRun(p, row, &col, &first, &length))
+        {
+            DFRobot_RGBLCD_Run_t *run = &p->runs[p->numRuns];
+            run->row = row;
+            run->first = first;
+            run->length = length;
+            run->commandBytes[0] = LCD_CONTROL_COMMAND;
+            run->commandBytes[1] = (row == 0) ? (0x80 | first) : (0xC0 | first);
+            memcpy(run->dataBytes, &p->frame[row][first], length);
+
+            run->command = (I2C_Transaction_t){
+                .address = p->lcdAddr,
+                .op = I2C_OP_WRITE,
+                .data = run->commandBytes,
+                .length = 2,
+            };
+            run->data = (I2C_Transaction_t){
+                .address = p->lcdAddr,
+                .op = I2C_OP_WRITE_REG,
+                .reg = LCD_CONTROL_DATA,
+                .data = run->dataBytes,
+                .length = length,
+            };
+
+            /*  Same device, same priority class: the queue keeps them in order. */
+            if((I2C_Submit_2(&run->command) != SUCCESS) || (I2C_Submit_2(&run->data) != SUCCESS))
+            {
+                /*  Device offline or queue full: nothing more this time. */
+                p->numRuns++;
+                return SUCCESS;
+            }
+            shadowRunSent(p, row, first, length);
+            p->numRuns++;
+        }
+    }
+    return SUCCESS;
+}
+
 void DFRobot_RGBLCD_CreateSymbol(DFRobot_RGBLCD_t *p, uint8_t location, const uint8_t charmap[])
 {
     location &= 0x7; /* Only 8 locations 0..7 */
-    lcdCommand(p, LCD_SETCGRAMADDR | (location << 3));
 
-    /*  According to the original code, it writes 8 bytes to CGRAM. 
-     *  Each of those writes must have the 0x40 “data prefix”. 
-     */
-    for(int i = 0; i < 8; i++)
+    /*  The 8 rows go as one data transfer (0x40 prefix, then the rows),
+     *  and the copy keeps LoadSymbol's bookkeeping straight. */
+    memcpy(p->cgram[location], charmap, LCD_GLYPH_ROWS);
+    cgramUpload(p, location);
+}
+
+void DFRobot_RGBLCD_LoadSymbol(DFRobot_RGBLCD_t *p, uint8_t location, const uint8_t charmap[LCD_GLYPH_ROWS])
+{
+    location &= 0x7;
+    if((memcmp(p->cgram[location], charmap, LCD_GLYPH_ROWS) == 0) && !(p->cgramDirty & (1u << location)))
     {
-        lcdWrite(p, charmap[i]);
+        return;
     }
+    memcpy(p->cgram[location], charmap, LCD_GLYPH_ROWS);
+    p->cgramDirty |= (uint8_t)(1u << location);
 }
 
 void DFRobot_RGBLCD_SetRGB(DFRobot_RGBLCD_t *p, uint8_t r, uint8_t g, uint8_t b)
@@ -0,0 +1,89 @@
+/**
+ * @file    Decimator.c
+ *
+ * HAL-free CIC decimator for interleaved multi-channel ADC frames.
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    7 Mar 2025
+ */
+
+// INCLUDES ***************************************************************************************
+#include <string.h>
+#include <Decimator.h>
+
+// FUNCTIONS **************************************************************************************
+void Decimator_Init(Decimator_t *dec, uint8_t channels, uint8_t factorShift, uint8_t order, uint8_t extraBits)
+{
+    if (channels > DECIMATOR_MAX_CHANNELS)
+    {
+        channels = DECIMATOR_MAX_CHANNELS;
+    }
+    if (order < 1)
+    {
+        order = 1;
+    }
+    else if (order > DECIMATOR_MAX_ORDER)
+    {
+        order = DECIMATOR_MAX_ORDER;
+    }
+
+    // CIC gain is (1 << factorShift) ^ order
+    uint8_t gainShift = order * factorShift;
+    if (extraBits > DECIMATOR_MAX_EXTRA)
+    {
+        extraBits = DECIMATOR_MAX_EXTRA;
+    }
+    if (extraBits > gainShift)
+    {
+        extraBits = gainShift;
+    }
+
+    memset(dec, 0, sizeof(*dec));
+    dec->channels = channels;
+    dec->order = order;
+    dec->factorShift = factorShift;
+    dec->outputShift = gainShift - extraBits;
+}
+
+uint16_t Decimator_Process(Decimator_t *dec, const uint16_t *in, uint16_t inFrames, uint16_t *out)
+{
+    const uint16_t factor = 1u << dec->factorShift;
+    const uint32_t rounding = (dec->outputShift > 0) ? (1u << (dec->outputShift - 1)) : 0;
+    uint16_t outFrames = 0;
+
+    for (uint16_t f = 0; f < inFrames; f++)
+    {
+        // Integrators run at the input rate
+        for (uint8_t c = 0; c < dec->channels; c++)
+        {
+            uint32_t acc = *in++;
+            for (uint8_t k = 0; k < dec->order; k++)
+            {
+                dec->integrator[k][c] += acc;
+                acc = dec->integrator[k][c];
+            }
+        }
+
+        if (++dec->phase < factor)
+        {
+            continue;
+        }
+        dec->phase = 0;
+
+        // Combs run at the output rate
+        for (uint8_t c = 0; c < dec->channels; c++)
+        {
+            uint32_t acc = dec->integrator[dec->order - 1][c];
+            for (uint8_t k = 0; k < dec->order; k++)
+            {
+                uint32_t delayed = dec->comb[k][c];
+                dec->comb[k][c] = acc;
+                acc -= delayed;
+            }
+            *out++ = (uint16_t)((acc + rounding) >> dec->outputShift);
+        }
+        outFrames++;
+    }
+    return outFrames;
+}
@@ -0,0 +1,70 @@
+/**
+ * @file    Display.c
+ *
+ * Display model for the RGB LCD, refreshed asynchronously and rate-limited.
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    11 Mar 2025
+ */
+
+// INCLUDES ***************************************************************************************
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <Display.h>
+#include <DFRobot_LCD.h>
+#include <timers.h>
+
+// GLOBAL VARIABLES *******************************************************************************
+static uint32_t lastRefresh_us = 0;
+static uint32_t writes = 0;
+static uint32_t refreshes = 0;
+static uint8_t pending = 0;         // Model changed since the last refresh
+
+// FUNCTIONS **************************************************************************************
+void Display_PrintLine(uint8_t row, const char *format, ...)
+{
+    char line[LCD_MAX_COLS + 1];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+
+    if (length < 0)
+    {
+        length = 0;
+    }
+    if (length < LCD_MAX_COLS)
+    {
+        memset(&line[length], ' ', LCD_MAX_COLS - length);
+    }
+    line[LCD_MAX_COLS] = '\0';
+
+    DFRobot_RGBLCD_SetCursor(&myLCD, 0, row);
+    DFRobot_RGBLCD_BufferPrint(&myLCD, line);
+    writes++;
+    pending = 1;
+}
+
+void Display_Service(void)
+{
+    uint32_t now_us = TIMERS_GetMicroSeconds();
+    if (!pending || ((now_us - lastRefresh_us) < DISPLAY_REFRESH_US) || DFRobot_RGBLCD_FlushBusy(&myLCD))
+    {
+        return;
+    }
+
+    // Runs that fail are marked dirty again by the next FlushAsync(), so keep
+    // coming back until one finds nothing left to send
+    DFRobot_RGBLCD_FlushAsync(&myLCD);
+    pending = ((myLCD.dirty[0] | myLCD.dirty[1]) != 0) || (myLCD.numRuns != 0);
+    lastRefresh_us = now_us;
+    refreshes++;
+}
+
+void Display_GetStats(uint32_t *writeCount, uint32_t *refreshCount)
+{
+    *writeCount = writes;
+    *refreshCount = refreshes;
+}
@@ -0,0 +1,217 @@
+/**
+ * @file    GestureClassifier.c
+ *
+ * Streaming hand gesture classifier: running window sums, a generated
+ * decision tree and a small confirm/cooldown state machine.
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    11 Mar 2025
+ */
+
+// INCLUDES ***************************************************************************************
+#include <string.h>
+#include <GestureClassifier.h>
+
+// DEFINES ****************************************************************************************
+// Angle sums are in gyro LSB * ms = 1/16 mdeg
+#define ANGLE_SUM_PER_DEG (OCTAVE_GYRO_LSB_PER_DPS * 1000)
+
+// GLOBAL VARIABLES *******************************************************************************
+const char GESTURE_LABELS[GESTURE_NUM_CLASSES] = {'-', 'U', 'D', 'S', 'M'};
+
+// FUNCTIONS **************************************************************************************
+void GestureClassifier_Init(GestureClassifier_t *classifier)
+{
+    memset(classifier, 0, sizeof(*classifier));
+}
+
+uint8_t GestureClassifier_Sustained(const GestureClassifier_t *classifier)
+{
+    return classifier->sustain;
+}
+
+static int32_t Abs32(int32_t value)
+{
+    return (value < 0) ? -value : value;
+}
+
+// Empties the window but keeps the decision state, so a sustain held through
+// a pause is not released by the restart
+static void GestureClassifier_ClearWindow(GestureClassifier_t *classifier)
+{
+    memset(classifier->sums, 0, sizeof(classifier->sums));
+    classifier->head = 0;
+    classifier->count = 0;
+    classifier->started = 0;
+    classifier->yawDirection = 0;
+}
+
+// Slides the window by one sample: the oldest contribution leaves the sums,
+// the new one enters
+static void GestureClassifier_Push(GestureClassifier_t *classifier, const int16_t gyro[3], const int16_t accel[3],
+                                   uint32_t timestamp_us)
+{
+    // With IMU_MOTION_INTERRUPT nothing arrives while the hand rests. The
+    // tree was trained on gap-free windows, so the motion before a pause
+    // must not share a window with the motion after it.
+    if (classifier->started && ((timestamp_us - classifier->lastSample_us) > GESTURE_MAX_DT_US))
+    {
+        GestureClassifier_ClearWindow(classifier);
+    }
+
+    int32_t *slot = classifier->history[classifier->head];
+    if (classifier->count == GESTURE_WINDOW)
+    {
+        for (uint8_t s = 0; s < GESTURE_NUM_SUMS; s++)
+        {
+            classifier->sums[s] -= slot[s];
+        }
+    }
+    else
+    {
+        classifier->count++;
+    }
+
+    // The first sample has no interval or previous accel to compare with
+    uint8_t first = !classifier->started;
+    classifier->started = 1;
+    uint32_t dt = first ? 0 : (timestamp_us - classifier->lastSample_us);
+    classifier->lastSample_us = timestamp_us;
+    int32_t dt_ms = (int32_t)(dt / 1000);
+
+    int8_t direction = classifier->yawDirection;
+    if (gyro[2] > GESTURE_SHAKE_DEADBAND_RAW)
+    {
+        direction = 1;
+    }
+    else if (gyro[2] < -GESTURE_SHAKE_DEADBAND_RAW)
+    {
+        direction = -1;
+    }
+
+    slot[GS_TWIST] = (gyro[0] - OCTAVE_GYRO_BIAS_RAW) * dt_ms;
+    slot[GS_PITCH] = gyro[1] * dt_ms;
+    slot[GS_SHAKE] = Abs32(gyro[2]) * dt_ms;
+    slot[GS_REVERSALS] = (classifier->yawDirection != 0) && (direction != classifier->yawDirection);
+    slot[GS_ACCEL_X] = accel[0];
+    slot[GS_ACCEL_Y] = accel[1];
+    slot[GS_ACCEL_Z] = accel[2];
+    slot[GS_JERK] = first ? 0
+                          : Abs32(accel[0] - classifier->prevAccel[0]) + Abs32(accel[1] - classifier->prevAccel[1]) +
+                                Abs32(accel[2] - classifier->prevAccel[2]);
+    slot[GS_TIME_MS] = dt_ms;
+
+    for (uint8_t s = 0; s < GESTURE_NUM_SUMS; s++)
+    {
+        classifier->sums[s] += slot[s];
+    }
+    classifier->yawDirection = direction;
+    memcpy(classifier->prevAccel, accel, sizeof(classifier->prevAccel));
+    classifier->head = (classifier->head + 1) % GESTURE_WINDOW;
+}
+
+uint8_t GestureClassifier_Features(const GestureClassifier_t *classifier, int32_t features[GESTURE_NUM_FEATURES])
+{
+    const int32_t *sums = classifier->sums;
+    int32_t count = classifier->count ? classifier->count : 1;
+    int32_t time_ms = sums[GS_TIME_MS] ? sums[GS_TIME_MS] : 1;
+
+    features[GF_TWIST_DEG] = sums[GS_TWIST] / ANGLE_SUM_PER_DEG;
+    features[GF_PITCH_DEG] = sums[GS_PITCH] / ANGLE_SUM_PER_DEG;
+    features[GF_SHAKE_DPS] = sums[GS_SHAKE] / (OCTAVE_GYRO_LSB_PER_DPS * time_ms);
+    features[GF_REVERSALS] = sums[GS_REVERSALS];
+    features[GF_ACCEL_X_MG] = sums[GS_ACCEL_X] / count;
+    features[GF_ACCEL_Y_MG] = sums[GS_ACCEL_Y] / count;
+    features[GF_ACCEL_Z_MG] = sums[GS_ACCEL_Z] / count;
+    features[GF_JERK_MG] = sums[GS_JERK] / count;
+    return classifier->count == GESTURE_WINDOW;
+}
+
+Gesture_t GestureClassifier_Classify(const GestureNode_t *tree, uint8_t nodes,
+                                     const int32_t features[GESTURE_NUM_FEATURES])
+{
+    uint8_t node = 0;
+    for (uint8_t depth = 0; (depth <= GESTURE_TREE_MAX_DEPTH) && (node < nodes); depth++)
+    {
+        const GestureNode_t *n = &tree[node];
+        if (n->feature == GESTURE_LEAF)
+        {
+            return (n->left < GESTURE_NUM_CLASSES) ? (Gesture_t)n->left : GESTURE_NONE;
+        }
+        if (n->feature >= GESTURE_NUM_FEATURES)
+        {
+            break;
+        }
+        node = (features[n->feature] <= n->threshold) ? n->left : n->right;
+    }
+    return GESTURE_NONE;
+}
+
+Gesture_t GestureClassifier_Update(GestureClassifier_t *classifier, const int16_t gyro[3], const int16_t accel[3],
+                                   uint32_t timestamp_us)
+{
+    GestureClassifier_Push(classifier, gyro, accel, timestamp_us);
+
+    // Sustain is a pose, so the latest sample can end it. Waiting for the
+    // tree would need a full window, and with IMU_MOTION_INTERRUPT none
+    // comes while the hand rests level: the last sample before the rest may
+    // be the only level one.
+    uint8_t level = accel[0] > GESTURE_LEVEL_ACCEL_X_MG;
+    if (level)
+    {
+        classifier->sustain = 0;
+    }
+
+    // Decisions wait for a full window, at boot and after a pause alike
+    int32_t features[GESTURE_NUM_FEATURES];
+    if (!GestureClassifier_Features(classifier, features))
+    {
+        classifier->lastClass = GESTURE_NONE;
+        return GESTURE_NONE;
+    }
+    Gesture_t gesture = GestureClassifier_Classify(GESTURE_TREE, GESTURE_TREE_NODES, features);
+    classifier->lastClass = gesture;
+
+    if (gesture != classifier->candidate)
+    {
+        classifier->candidate = gesture;
+        classifier->candidateCount = 0;
+    }
+    if (classifier->candidateCount < GESTURE_CONFIRM_SAMPLES)
+    {
+        classifier->candidateCount++;
+    }
+    if ((classifier->candidateCount != GESTURE_CONFIRM_SAMPLES) || (gesture == classifier->confirmed))
+    {
+        return GESTURE_NONE;
+    }
+
+    // A new class just got confirmed
+    classifier->confirmed = gesture;
+    switch (gesture)
+    {
+    case GESTURE_NONE:
+        classifier->sustain = 0;
+        return GESTURE_NONE;
+
+    case GESTURE_SUSTAIN:
+        // The window lags; the fingers may already be back up
+        if (classifier->sustain || level)
+        {
+            return GESTURE_NONE;
+        }
+        classifier->sustain = 1;
+        return GESTURE_SUSTAIN;
+
+    default:
+        // The return swing of a twist must not fire the opposite one
+        if (classifier->fired && ((timestamp_us - classifier->lastEvent_us) <= GESTURE_COOLDOWN_US))
+        {
+            return GESTURE_NONE;
+        }
+        classifier->fired = 1;
+        classifier->lastEvent_us = timestamp_us;
+        return gesture;
+    }
+}
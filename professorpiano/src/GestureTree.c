@@ -0,0 +1,64 @@
+/**
+ * @file    GestureTree.c
+ *
+ * Decision tree for GestureClassifier.c, generated by imu_trace/gesture_train
+ * (--depth 6 --min-leaf 12) from:
+ *
+ *   traces/train_01.csv
+ *   traces/train_02.csv
+ *   traces/train_03.csv
+ *   traces/train_04.csv
+ *
+ * Do not edit; record and label more traces and retrain instead.
+ *
+ * Training windows, correct / total:
+ *   GESTURE_NONE           9084 / 9278
+ *   GESTURE_OCTAVE_UP       198 / 198
+ *   GESTURE_OCTAVE_DOWN     344 / 346
+ *   GESTURE_SUSTAIN        1501 / 1503
+ *   GESTURE_MODE_TOGGLE     800 / 801
+ */
+
+#include <GestureClassifier.h>
+
+const GestureNode_t GESTURE_TREE[] = {
+    {GF_SHAKE_DPS, 1, 26, 58}, // 0
+    {GF_ACCEL_X_MG, 2, 13, -458}, // 1
+    {GF_SHAKE_DPS, 3, 8, 2}, // 2
+    {GF_ACCEL_X_MG, 4, 7, -621}, // 3
+    {GF_PITCH_DEG, 5, 6, 17}, // 4
+    {GESTURE_LEAF, GESTURE_SUSTAIN, 0, 0}, // 5
+    {GESTURE_LEAF, GESTURE_NONE, 0, 0}, // 6
+    {GESTURE_LEAF, GESTURE_NONE, 0, 0}, // 7
+    {GF_PITCH_DEG, 9, 12, 13}, // 8
+    {GF_PITCH_DEG, 10, 11, -25}, // 9
+    {GESTURE_LEAF, GESTURE_NONE, 0, 0}, // 10
+    {GESTURE_LEAF, GESTURE_SUSTAIN, 0, 0}, // 11
+    {GESTURE_LEAF, GESTURE_NONE, 0, 0}, // 12
+    {GF_TWIST_DEG, 14, 23, 20}, // 13
+    {GF_TWIST_DEG, 15, 18, -25}, // 14
+    {GF_ACCEL_Y_MG, 16, 17, -34}, // 15
+    {GESTURE_LEAF, GESTURE_OCTAVE_UP, 0, 0}, // 16
+    {GESTURE_LEAF, GESTURE_NONE, 0, 0}, // 17
+    {GF_TWIST_DEG, 19, 22, -20}, // 18
+    {GF_ACCEL_Y_MG, 20, 21, -175}, // 19
+    {GESTURE_LEAF, GESTURE_OCTAVE_UP, 0, 0}, // 20
+    {GESTURE_LEAF, GESTURE_NONE, 0, 0}, // 21
+    {GESTURE_LEAF, GESTURE_NONE, 0, 0}, // 22
+    {GF_ACCEL_Y_MG, 24, 25, -69}, // 23
+    {GESTURE_LEAF, GESTURE_NONE, 0, 0}, // 24
+    {GESTURE_LEAF, GESTURE_OCTAVE_DOWN, 0, 0}, // 25
+    {GF_REVERSALS, 27, 28, 0}, // 26
+    {GESTURE_LEAF, GESTURE_NONE, 0, 0}, // 27
+    {GF_SHAKE_DPS, 29, 36, 82}, // 28
+    {GF_REVERSALS, 30, 35, 1}, // 29
+    {GF_ACCEL_Z_MG, 31, 32, 995}, // 30
+    {GESTURE_LEAF, GESTURE_MODE_TOGGLE, 0, 0}, // 31
+    {GF_SHAKE_DPS, 33, 34, 67}, // 32
+    {GESTURE_LEAF, GESTURE_NONE, 0, 0}, // 33
+    {GESTURE_LEAF, GESTURE_MODE_TOGGLE, 0, 0}, // 34
+    {GESTURE_LEAF, GESTURE_MODE_TOGGLE, 0, 0}, // 35
+    {GESTURE_LEAF, GESTURE_MODE_TOGGLE, 0, 0}, // 36
+};
+
+const uint8_t GESTURE_TREE_NODES = sizeof(GESTURE_TREE) / sizeof(GESTURE_TREE[0]);
@@ -8,9 +8,14 @@
  #include <stdio.h>
  #include <stdlib.h>
  #include <stdint.h>
+ #include <stddef.h>
+ #include <string.h>
  #include "stm32f4xx_hal.h"
  #include "stm32f4xx_hal_i2c.h"
  #include "I2C_2.h"
+ #include <timers.h>
+ #include <Trace.h>
+ #include <Log.h>
  
  
  /*  MODULE-LEVEL DEFINITIONS, MACROS    */
@@ -31,6 +36,31 @@
  I2C_HandleTypeDef hi2c2;
  
  static uint8_t initStatus = FALSE;
+
+ // One queue per priority class, worked off by the I2C2 interrupts. A started
+ // transaction stays at the head of its queue until its last slice finishes.
+ typedef struct
+ {
+     I2C_Transaction_t *entries[I2C_QUEUE_LENGTH];
+     uint8_t head;
+     uint8_t count;
+ } I2C_Queue_t;
+
+ static I2C_Queue_t queues[I2C_NUM_PRIORITIES];
+ static I2C_Transaction_t *volatile active = NULL;    // Slice on the bus
+
+ static I2C_Device_t devices[I2C_MAX_DEVICES];
+ static uint8_t numDevices = 0;
+
+ static I2C_BusStats_t busStats = {.clockSpeed = I2C_STANDARD_SPEED};
+
+ // Set from the interrupt, handled by I2C_Service_2() in the main loop
+ static volatile uint8_t recoveryPending = FALSE;
+ static uint32_t lastRecoveryTick = 0;
+
+ // Bus pins, for manual clocking during recovery
+ #define I2C_SCL_PIN GPIO_PIN_10
+ #define I2C_SDA_PIN GPIO_PIN_9
  
  
  /*  FUNCTIONS   */
@@ -45,7 +75,7 @@
      if (initStatus == FALSE)
      {
          hi2c2.Instance = I2C2;
-         hi2c2.Init.ClockSpeed = 100000;
+         hi2c2.Init.ClockSpeed = I2C_STANDARD_SPEED;
          hi2c2.Init.DutyCycle = I2C_DUTYCYCLE_2;
          hi2c2.Init.OwnAddress1 = 0;
          hi2c2.Init.AddressingMode = I2C_ADDRESSINGMODE_7BIT;
@@ -101,6 +131,659 @@
    }
  }
 
+ /*  TRANSACTION ENGINE  */
+ static int8_t I2C_FindDevice(uint8_t I2CAddress)
+ {
+     for (uint8_t i = 0; i < numDevices; i++)
+     {
+         if (devices[i].address == I2CAddress)
+         {
+             return (int8_t)i;
+         }
+     }
+     return -1;
+ }
+
+ // Looks a device up, adding it with default settings if there is room.
+ static int8_t I2C_TrackDevice(uint8_t I2CAddress)
+ {
+     int8_t device = I2C_FindDevice(I2CAddress);
+     if ((device < 0) && (numDevices < I2C_MAX_DEVICES))
+     {
+         device = (int8_t)numDevices++;
+         devices[device].address = I2CAddress;
+         devices[device].priority = I2C_PRIORITY_NORMAL;
+         devices[device].maxSlice = 0;
+         devices[device].flags = 0;
+         devices[device].health = I2C_HEALTHY;
+         devices[device].backoff_ms = I2C_BACKOFF_MIN_MS;
+     }
+     return device;
+ }
+
+ static void I2C_RecordLatency(I2C_Device_t *device, uint32_t latency_us)
+ {
+     uint8_t bin = 0;
+     while ((bin < I2C_LATENCY_BINS - 1) && (latency_us >= ((uint32_t)I2C_LATENCY_BIN0_US << bin)))
+     {
+         bin++;
+     }
+     device->latency[bin]++;
+     if (latency_us > device->worstLatency_us)
+     {
+         device->worstLatency_us = latency_us;
+     }
+ }
+
+ // Health state machine, fed with the outcome of every transaction that
+ // reached the bus.
+ static void I2C_DeviceSucceeded(I2C_Device_t *device)
+ {
+     device->health = I2C_HEALTHY;
+     device->consecutiveFailures = 0;
+     device->backoff_ms = I2C_BACKOFF_MIN_MS;
+ }
+
+ static void I2C_DeviceFailed(I2C_Device_t *device)
+ {
+     if (device->consecutiveFailures < UINT8_MAX)
+     {
+         device->consecutiveFailures++;
+     }
+     TRACE(TRACE_I2C_FAILURE, device->address, device->consecutiveFailures);
+
+     if (device->health == I2C_PROBING)
+     {
+         // Still dead: wait twice as long before the next probe
+         device->backoff_ms = (device->backoff_ms * 2 > I2C_BACKOFF_MAX_MS) ?
+             I2C_BACKOFF_MAX_MS : device->backoff_ms * 2;
+         device->health = I2C_OFFLINE;
+         device->offlineTick = HAL_GetTick();
+     }
+     else if (device->consecutiveFailures >= I2C_OFFLINE_FAILURES)
+     {
+         device->health = I2C_OFFLINE;
+         device->offlineTick = HAL_GetTick();
+     }
+     else
+     {
+         device->health = I2C_DEGRADED;
+     }
+ }
+
+ // TRUE if transactions to the device must not go on the bus right now.
+ // Moves an offline device to probing once its backoff has expired.
+ static int8_t I2C_DeviceBlocked(int8_t index)
+ {
+     if (index < 0)
+     {
+         return FALSE;
+     }
+     I2C_Device_t *device = &devices[index];
+     if (device->health != I2C_OFFLINE)
+     {
+         return FALSE;
+     }
+     if ((HAL_GetTick() - device->offlineTick) < device->backoff_ms)
+     {
+         return TRUE;
+     }
+     device->health = I2C_PROBING;
+     return FALSE;
+ }
+
+ // Removes the head of its queue (the active transaction) and hands it back
+ // to its owner. Interrupts must be masked or this must run from the I2C
+ // interrupt.
+ static void I2C_Finish(I2C_Transaction_t *transaction, I2C_Status_t status)
+ {
+     I2C_Queue_t *queue = &queues[transaction->priority];
+     queue->head = (queue->head + 1) % I2C_QUEUE_LENGTH;
+     queue->count--;
+     if (active == transaction)
+     {
+         active = NULL;
+     }
+
+     if (transaction->device >= 0)
+     {
+         I2C_Device_t *device = &devices[transaction->device];
+         device->transactions++;
+         if (status != I2C_DONE)
+         {
+             device->failures++;
+         }
+         I2C_RecordLatency(device, TIMERS_GetMicroSeconds() - transaction->submit_us);
+     }
+
+     transaction->status = status;
+     if (transaction->callback != NULL)
+     {
+         transaction->callback(transaction);
+     }
+ }
+
+ // Puts the next slice of a transaction on the bus.
+ static HAL_StatusTypeDef I2C_StartSlice(I2C_Transaction_t *transaction)
+ {
+     uint16_t length = transaction->length - transaction->done;
+     uint8_t reg = transaction->reg;
+     uint8_t *data = transaction->data + transaction->done;
+
+     if ((transaction->op != I2C_OP_WRITE) && (transaction->device >= 0))
+     {
+         const I2C_Device_t *device = &devices[transaction->device];
+         if ((device->maxSlice != 0) && (length > device->maxSlice))
+         {
+             length = device->maxSlice;
+         }
+         if (!(device->flags & I2C_FIXED_REGISTER))
+         {
+             reg += transaction->done; // Register auto-increment
+         }
+     }
+     transaction->sliceLength = length;
+     transaction->startTick = HAL_GetTick();
+
+     uint16_t address = transaction->address << 1; // Use 8-bit address.
+     switch (transaction->op)
+     {
+         case I2C_OP_WRITE:
+             return HAL_I2C_Master_Transmit_IT(&hi2c2, address, data, length);
+         case I2C_OP_WRITE_REG:
+             return HAL_I2C_Mem_Write_IT(&hi2c2, address, reg, I2C_MEMADD_SIZE_8BIT, data, length);
+         case I2C_OP_READ_REG:
+             return HAL_I2C_Mem_Read_IT(&hi2c2, address, reg, I2C_MEMADD_SIZE_8BIT, data, length);
+         default:
+             return HAL_ERROR;
+     }
+ }
+
+ // Starts the head of the highest non-empty class, which may be a fresh
+ // transaction or the next slice of a preempted one, until something is on
+ // the bus or all queues are empty. Interrupts must be masked or this must run
+ // from the I2C interrupt.
+ static void I2C_StartNext(void)
+ {
+     while ((active == NULL) && !recoveryPending)
+     {
+         I2C_Queue_t *queue = NULL;
+         for (uint8_t p = 0; p < I2C_NUM_PRIORITIES; p++)
+         {
+             if (queues[p].count > 0)
+             {
+                 queue = &queues[p];
+                 break;
+             }
+         }
+         if (queue == NULL)
+         {
+             return;
+         }
+
+         I2C_Transaction_t *transaction = queue->entries[queue->head];
+         if ((transaction->status == I2C_QUEUED) && I2C_DeviceBlocked(transaction->device))
+         {
+             // Went offline while this was queued
+             I2C_Finish(transaction, I2C_FAILED);
+             continue;
+         }
+
+         transaction->status = I2C_ACTIVE;
+         active = transaction;
+         HAL_StatusTypeDef ret = I2C_StartSlice(transaction);
+         if (ret == HAL_BUSY)
+         {
+             // BUSY flag never cleared: a slave is holding the bus. Leave the
+             // transaction queued and let I2C_Service_2() free the bus.
+             active = NULL;
+             recoveryPending = TRUE;
+         }
+         else if (ret != HAL_OK)
+         {
+             // Never got on the bus; fail it and try the next one.
+             I2C_Finish(transaction, I2C_FAILED);
+         }
+         else if (transaction->device >= 0)
+         {
+             devices[transaction->device].slices++;
+         }
+     }
+ }
+
+ // A slice finished on the bus. The transaction either completes or yields
+ // the bus if a more urgent class has work queued.
+ static void I2C_SliceDone(I2C_Status_t status)
+ {
+     I2C_Transaction_t *transaction = active;
+     if (transaction == NULL)
+     {
+         return;
+     }
+     active = NULL;
+
+     if (status == I2C_DONE)
+     {
+         busStats.consecutiveErrors = 0;
+         transaction->retries = 0;
+         transaction->done += transaction->sliceLength;
+         if (transaction->done < transaction->length)
+         {
+             for (uint8_t p = 0; p < transaction->priority; p++)
+             {
+                 if ((queues[p].count > 0) && (transaction->device >= 0))
+                 {
+                     devices[transaction->device].preempted++;
+                     break;
+                 }
+             }
+             I2C_StartNext();
+             return;
+         }
+         if (transaction->device >= 0)
+         {
+             I2C_DeviceSucceeded(&devices[transaction->device]);
+         }
+     }
+     else
+     {
+         busStats.errors++;
+         busStats.consecutiveErrors++;
+         if (transaction->retries < I2C_MAX_RETRIES)
+         {
+             // Stays at the head of its queue, so the same slice goes again
+             transaction->retries++;
+             busStats.retries++;
+             if (transaction->device >= 0)
+             {
+                 devices[transaction->device].retries++;
+             }
+             I2C_StartNext();
+             return;
+         }
+         if (transaction->device >= 0)
+         {
+             I2C_DeviceFailed(&devices[transaction->device]);
+         }
+     }
+     I2C_Finish(transaction, status);
+     I2C_StartNext();
+ }
+
+ // Reconfigures SCL. Only call with interrupts masked and nothing on the bus.
+ static void I2C_SetClockSpeed(uint32_t clockSpeed)
+ {
+     HAL_I2C_DeInit(&hi2c2);
+     hi2c2.Init.ClockSpeed = clockSpeed;
+     HAL_I2C_Init(&hi2c2);
+     busStats.clockSpeed = clockSpeed;
+     busStats.consecutiveErrors = 0;
+ }
+
+ // Roughly half a 100 kHz SCL period at 48 MHz.
+ static void I2C_HalfBit(void)
+ {
+     for (volatile uint16_t i = 0; i < 40; i++)
+     {
+     }
+ }
+
+ // Frees a bus held by a slave that lost track mid-byte and resets the
+ // peripheral. Only call with interrupts masked and nothing on the bus.
+ static void I2C_RecoverBus(void)
+ {
+     HAL_I2C_DeInit(&hi2c2);
+
+     // Drive both lines as open-drain GPIO, released
+     GPIO_InitTypeDef GPIO_InitStruct = {0};
+     HAL_GPIO_WritePin(GPIOB, I2C_SCL_PIN | I2C_SDA_PIN, GPIO_PIN_SET);
+     GPIO_InitStruct.Pin = I2C_SCL_PIN | I2C_SDA_PIN;
+     GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_OD;
+     GPIO_InitStruct.Pull = GPIO_PULLUP;
+     GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+     HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
+     I2C_HalfBit();
+
+     // Clock until the slave finishes its byte and lets go of SDA
+     for (uint8_t i = 0; (i < I2C_RECOVERY_CLOCKS) &&
+          (HAL_GPIO_ReadPin(GPIOB, I2C_SDA_PIN) == GPIO_PIN_RESET); i++)
+     {
+         HAL_GPIO_WritePin(GPIOB, I2C_SCL_PIN, GPIO_PIN_RESET);
+         I2C_HalfBit();
+         HAL_GPIO_WritePin(GPIOB, I2C_SCL_PIN, GPIO_PIN_SET);
+         I2C_HalfBit();
+     }
+
+     // STOP condition: SDA rises while SCL is high
+     HAL_GPIO_WritePin(GPIOB, I2C_SCL_PIN, GPIO_PIN_RESET);
+     I2C_HalfBit();
+     HAL_GPIO_WritePin(GPIOB, I2C_SDA_PIN, GPIO_PIN_RESET);
+     I2C_HalfBit();
+     HAL_GPIO_WritePin(GPIOB, I2C_SCL_PIN, GPIO_PIN_SET);
+     I2C_HalfBit();
+     HAL_GPIO_WritePin(GPIOB, I2C_SDA_PIN, GPIO_PIN_SET);
+     I2C_HalfBit();
+     busStats.stuck = (HAL_GPIO_ReadPin(GPIOB, I2C_SDA_PIN) == GPIO_PIN_RESET) ? TRUE : FALSE;
+
+     // Clears a BUSY flag latched by the glitch; MspInit restores the pins
+     __HAL_RCC_I2C2_FORCE_RESET();
+     __HAL_RCC_I2C2_RELEASE_RESET();
+     HAL_I2C_Init(&hi2c2);
+
+     busStats.recoveries++;
+     lastRecoveryTick = HAL_GetTick();
+ }
+
+ // Fails everything queued so blocked callers return. Used when the bus
+ // cannot be recovered.
+ static void I2C_FailAll(void)
+ {
+     for (uint8_t p = 0; p < I2C_NUM_PRIORITIES; p++)
+     {
+         while (queues[p].count > 0)
+         {
+             I2C_Finish(queues[p].entries[queues[p].head], I2C_FAILED);
+         }
+     }
+ }
+
+ int8_t I2C_Submit_2(I2C_Transaction_t *transaction)
+ {
+     if ((initStatus == FALSE) || (transaction == NULL))
+     {
+         return ERROR;
+     }
+
+     uint32_t primask = __get_PRIMASK();
+     __disable_irq();
+     if (I2C_InFlight_2(transaction))
+     {
+         // Checked with interrupts masked: the same descriptor may be
+         // submitted from both the main loop and an interrupt.
+         __set_PRIMASK(primask);
+         return ERROR;
+     }
+     int8_t device = I2C_TrackDevice(transaction->address);
+     if (busStats.stuck || I2C_DeviceBlocked(device))
+     {
+         // Fail fast instead of queueing behind a dead bus or device
+         if (device >= 0)
+         {
+             devices[device].rejected++;
+         }
+         transaction->status = I2C_FAILED;
+         __set_PRIMASK(primask);
+         return ERROR;
+     }
+     I2C_Priority_t priority = (device >= 0) ? devices[device].priority : I2C_PRIORITY_NORMAL;
+     I2C_Queue_t *queue = &queues[priority];
+     if (queue->count >= I2C_QUEUE_LENGTH)
+     {
+         __set_PRIMASK(primask);
+         return ERROR;
+     }
+     transaction->priority = priority;
+     transaction->device = device;
+     transaction->done = 0;
+     transaction->retries = 0;
+     transaction->submit_us = TIMERS_GetMicroSeconds();
+     transaction->status = I2C_QUEUED;
+     queue->entries[(queue->head + queue->count) % I2C_QUEUE_LENGTH] = transaction;
+     queue->count++;
+     I2C_StartNext();
+     __set_PRIMASK(primask);
+     return SUCCESS;
+ }
+
+ int8_t I2C_InFlight_2(const I2C_Transaction_t *transaction)
+ {
+     return ((transaction->status == I2C_QUEUED) || (transaction->status == I2C_ACTIVE)) ? TRUE : FALSE;
+ }
+
+ void I2C_Service_2(void)
+ {
+     uint32_t primask = __get_PRIMASK();
+     __disable_irq();
+     I2C_Transaction_t *transaction = active;
+     if ((transaction != NULL) && ((HAL_GetTick() - transaction->startTick) > I2C_TIMEOUT_MS))
+     {
+         // Slice hung mid-transfer; count it as failed and free the bus
+         // before it is retried.
+         recoveryPending = TRUE;
+         I2C_SliceDone(I2C_FAILED);
+     }
+     else if ((transaction == NULL) && (initStatus == TRUE) && __HAL_I2C_GET_FLAG(&hi2c2, I2C_FLAG_BUSY))
+     {
+         // Idle, yet the peripheral sees the bus busy: SDA or SCL held low
+         recoveryPending = TRUE;
+     }
+
+     if (recoveryPending && (active == NULL) &&
+         (!busStats.stuck || ((HAL_GetTick() - lastRecoveryTick) >= I2C_RECOVERY_INTERVAL_MS)))
+     {
+         I2C_RecoverBus();
+         if (busStats.stuck)
+         {
+             // Held low for good; fail everything and keep trying at intervals
+             I2C_FailAll();
+         }
+         else
+         {
+             recoveryPending = FALSE;
+             I2C_StartNext();
+         }
+     }
+
+     // Fast mode keeps failing: wait for a slice boundary, then slow down.
+     if ((busStats.clockSpeed > I2C_STANDARD_SPEED) &&
+         (busStats.consecutiveErrors >= I2C_FALLBACK_ERRORS) && (active == NULL))
+     {
+         I2C_SetClockSpeed(I2C_STANDARD_SPEED);
+         busStats.fallbacks++;
+         I2C_StartNext();
+     }
+     __set_PRIMASK(primask);
+ }
+
+ uint32_t I2C_ProbeFastMode_2(void)
+ {
+     if (initStatus == FALSE)
+     {
+         return 0;
+     }
+
+     uint32_t primask = __get_PRIMASK();
+     __disable_irq();
+     for (uint8_t p = 0; p < I2C_NUM_PRIORITIES; p++)
+     {
+         if (queues[p].count > 0)
+         {
+             __set_PRIMASK(primask);
+             return 0;
+         }
+     }
+     I2C_SetClockSpeed(I2C_FAST_SPEED);
+     __set_PRIMASK(primask);
+
+     // Polling probe; the queue is empty and stays so during boot. A device
+     // that already fails at 100 kHz (an unfitted second IMU) says nothing
+     // about 400 kHz.
+     for (uint8_t i = 0; i < numDevices; i++)
+     {
+         if (devices[i].consecutiveFailures > 0)
+         {
+             continue;
+         }
+         if (HAL_I2C_IsDeviceReady(&hi2c2, devices[i].address << 1, I2C_PROBE_TRIALS, 10) != HAL_OK)
+         {
+             LOG_WARN(LOG_I2C, "I2C device 0x%02X failed at %lu Hz, using %lu Hz\r\n", devices[i].address,
+                      (unsigned long)I2C_FAST_SPEED, (unsigned long)I2C_STANDARD_SPEED);
+             primask = __get_PRIMASK();
+             __disable_irq();
+             I2C_SetClockSpeed(I2C_STANDARD_SPEED);
+             busStats.fallbacks++;
+             __set_PRIMASK(primask);
+             break;
+         }
+     }
+     return busStats.clockSpeed;
+ }
+
+ const I2C_BusStats_t *I2C_GetBusStats_2(void)
+ {
+     return &busStats;
+ }
+
+ int8_t I2C_ConfigureDevice_2(uint8_t I2CAddress, I2C_Priority_t priority, uint16_t maxSlice, uint8_t flags)
+ {
+     if (priority >= I2C_NUM_PRIORITIES)
+     {
+         return ERROR;
+     }
+
+     uint32_t primask = __get_PRIMASK();
+     __disable_irq();
+     int8_t device = I2C_TrackDevice(I2CAddress);
+     if (device >= 0)
+     {
+         // Takes effect for transactions submitted from now on
+         devices[device].priority = priority;
+         devices[device].maxSlice = maxSlice;
+         devices[device].flags = flags;
+     }
+     __set_PRIMASK(primask);
+     return (device >= 0) ? SUCCESS : ERROR;
+ }
+
+ const I2C_Device_t *I2C_GetDevice_2(uint8_t I2CAddress)
+ {
+     int8_t device = I2C_FindDevice(I2CAddress);
+     return (device >= 0) ? &devices[device] : NULL;
+ }
+
+ void I2C_PrintStats_2(void)
+ {
+     static const char *const classNames[I2C_NUM_PRIORITIES] = {"high", "normal", "bulk"};
+     static const char *const healthNames[] = {"ok", "degr", "off", "probe"};
+
+     printf("i2c2 at %lu Hz: %lu errors, %lu retries, %lu fallbacks, %lu recoveries%s\r\n",
+            (unsigned long)busStats.clockSpeed, (unsigned long)busStats.errors,
+            (unsigned long)busStats.retries, (unsigned long)busStats.fallbacks,
+            (unsigned long)busStats.recoveries, busStats.stuck ? ", SDA STUCK" : "");
+     busStats.errors = 0;
+     busStats.retries = 0;
+
+     printf("i2c   class  health  xfers  fail  retry  reject  slices  preempt  worst_us  latency <%uus x2^k:\r\n",
+            I2C_LATENCY_BIN0_US);
+     for (uint8_t i = 0; i < numDevices; i++)
+     {
+         // Copy first so the interrupt cannot change it halfway through
+         uint32_t primask = __get_PRIMASK();
+         __disable_irq();
+         I2C_Device_t device = devices[i];
+         memset(&devices[i].transactions, 0, sizeof(I2C_Device_t) - offsetof(I2C_Device_t, transactions));
+         __set_PRIMASK(primask);
+
+         printf("0x%02X  %-6s %-6s %6lu %5lu %6lu %7lu %7lu %8lu %9lu ", device.address,
+                classNames[device.priority], healthNames[device.health],
+                (unsigned long)device.transactions, (unsigned long)device.failures,
+                (unsigned long)device.retries, (unsigned long)device.rejected,
+                (unsigned long)device.slices, (unsigned long)device.preempted,
+                (unsigned long)device.worstLatency_us);
+         for (uint8_t bin = 0; bin < I2C_LATENCY_BINS; bin++)
+         {
+             printf(" %lu", (unsigned long)device.latency[bin]);
+         }
+         printf("\r\n");
+     }
+ }
+
+ int8_t I2C_Wait_2(I2C_Transaction_t *transaction)
+ {
+     // Must not be called from an interrupt; the completion would never run.
+     while (I2C_InFlight_2(transaction))
+     {
+         I2C_Service_2();
+
+         // Same pattern as Scheduler_Idle(): a completion between the check
+         // and WFI still ends the sleep.
+         __disable_irq();
+         if (I2C_InFlight_2(transaction))
+         {
+             __WFI();
+         }
+         __enable_irq();
+     }
+     return (transaction->status == I2C_DONE) ? SUCCESS : ERROR;
+ }
+
+ // Submits a stack descriptor and sleeps until it completes.
+ static int8_t I2C_Transfer(uint8_t I2CAddress, I2C_Op_t op, uint8_t reg, uint8_t *data, uint16_t length)
+ {
+     I2C_Transaction_t transaction = {
+         .address = I2CAddress,
+         .op = op,
+         .reg = reg,
+         .data = data,
+         .length = length,
+         .callback = NULL,
+         .status = I2C_IDLE
+     };
+     if (I2C_Submit_2(&transaction) != SUCCESS)
+     {
+         return ERROR;
+     }
+     return I2C_Wait_2(&transaction);
+ }
+
+ void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef *hi2c)
+ {
+     if (hi2c->Instance == I2C2)
+     {
+         I2C_SliceDone(I2C_DONE);
+     }
+ }
+
+ void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c)
+ {
+     if (hi2c->Instance == I2C2)
+     {
+         I2C_SliceDone(I2C_DONE);
+     }
+ }
+
+ void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c)
+ {
+     if (hi2c->Instance == I2C2)
+     {
+         I2C_SliceDone(I2C_DONE);
+     }
+ }
+
+ void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
+ {
+     if (hi2c->Instance == I2C2)
+     {
+         if (hi2c->ErrorCode & (HAL_I2C_ERROR_BERR | HAL_I2C_ERROR_ARLO | HAL_I2C_ERROR_TIMEOUT))
+         {
+             // Misplaced START/STOP or lost arbitration: reset before retrying
+             recoveryPending = TRUE;
+         }
+         I2C_SliceDone(I2C_FAILED);
+     }
+ }
+
+ void I2C2_EV_IRQHandler(void)
+ {
+     HAL_I2C_EV_IRQHandler(&hi2c2);
+ }
+
+ void I2C2_ER_IRQHandler(void)
+ {
+     HAL_I2C_ER_IRQHandler(&hi2c2);
+ }
+
+ /*  BLOCKING ACCESS */
  /** I2C_ReadRegister(I2CAddress, deviceRegisterAddress)
   *
   * Reads one device register on chosen I2C device.
@@ -116,27 +799,15 @@
      unsigned char deviceRegisterAddress
  )
  {
-     HAL_StatusTypeDef ret;
-     I2CAddress = I2CAddress << 1; // use 8-bit address
-     uint8_t* data = &deviceRegisterAddress;
- 
-     // Start condition; wait for it to end, this is internal and cannot stall.
-     ret = HAL_I2C_Master_Transmit(&hi2c2, I2CAddress, data, 1, HAL_MAX_DELAY);
-     if (ret != HAL_OK)
-     {
-         printf("I2C Tx Error on read start condition\r\n");
-         return 0;
-     }
- 
-     // Get byte; wait for it to end, this is internal and cannot stall.
-     ret = HAL_I2C_Master_Receive(&hi2c2, I2CAddress, data, 1, HAL_MAX_DELAY);
-     if (ret != HAL_OK)
+     uint8_t data = 0;
+
+     if (I2C_Transfer(I2CAddress, I2C_OP_READ_REG, deviceRegisterAddress, &data, 1) != SUCCESS)
      {
-         printf("I2C Rx Error on read byte\r\n");
+         LOG_ERROR(LOG_I2C, "I2C Rx Error on read byte\r\n");
          return 0;
      }
- 
-     return *data;
+
+     return data;
  }
  
  /** I2C_WriteReg(I2CAddress, deviceRegisterAddress, data)
@@ -157,21 +828,9 @@
      uint8_t data
  )
  {
-     HAL_StatusTypeDef ret;
-     I2CAddress = I2CAddress << 1; // Use 8-bit address.
+    //  printf("I2C Write: Addr=0x%X, Reg=0x%X, Data=0x%X\n", I2CAddress, deviceRegisterAddress, data);
 
-    //  printf("I2C Write: Addr=0x%X, Reg=0x%X, Data=0x%X\n", I2CAddress >> 1, deviceRegisterAddress, data);
-
-     ret = HAL_I2C_Mem_Write(
-         &hi2c2,
-         I2CAddress,
-         deviceRegisterAddress,
-         I2C_MEMADD_SIZE_8BIT,
-         &data,
-         1,
-         HAL_MAX_DELAY
-     );
-     if (ret != HAL_OK)
+     if (I2C_Transfer(I2CAddress, I2C_OP_WRITE_REG, deviceRegisterAddress, &data, 1) != SUCCESS)
      {
         // printf("I2C Tx Error on write data\r\n");
          return ERROR;
@@ -179,7 +838,25 @@
  
      return SUCCESS;   
  }
+
+ /** I2C_Write_2(I2CAddress, data, length)
+  *
+  * Writes length raw bytes in one transaction (no register pointer).
+  *
+  * @return                  (int8_t)    [SUCCESS, ERROR]
+  */
+ int8_t I2C_Write_2(uint8_t I2CAddress, const uint8_t *data, uint16_t length)
+ {
+     // HAL only reads from the buffer on transmit.
+     return I2C_Transfer(I2CAddress, I2C_OP_WRITE, 0, (uint8_t *)data, length);
+ }
  
+ int8_t I2C_WriteRegisters_2(uint8_t I2CAddress, uint8_t startRegister, const uint8_t *data, uint16_t length)
+ {
+     // HAL only reads from the buffer on transmit.
+     return I2C_Transfer(I2CAddress, I2C_OP_WRITE_REG, startRegister, (uint8_t *)data, length);
+ }
+
  /** I2C_ReadInt(I2CAddress, deviceRegisterAddress, isBigEndian)
   *
   * Reads two sequential registers to build a 16-bit value. isBigEndian dictates
@@ -222,6 +899,28 @@
  }
 
 
+ /** I2C_ReadRegisters_2(I2CAddress, startRegister, data, length)
+  *
+  * Reads length consecutive device registers in one transaction.
+  *
+  * @return                  (int8_t)    [SUCCESS, ERROR]
+  */
+ int8_t I2C_ReadRegisters_2(
+     uint8_t I2CAddress,
+     uint8_t startRegister,
+     uint8_t *data,
+     uint16_t length
+ )
+ {
+     if (I2C_Transfer(I2CAddress, I2C_OP_READ_REG, startRegister, data, length) != SUCCESS)
+     {
+         LOG_ERROR(LOG_I2C, "I2C Rx Error on burst read\r\n");
+         return ERROR;
+     }
+
+     return SUCCESS;
+ }
+
 /**
  * @brief Scan the I2C bus for devices.
  * @param hi2c  Pointer to an initialized I2C_HandleTypeDef (e.g., &hI2C2 or &hi2c2).
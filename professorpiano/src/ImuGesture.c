@@ -0,0 +1,157 @@
+/**
+ * @file    ImuGesture.c
+ *
+ * HAL-free core of the octave gesture detector, in integer arithmetic on real
+ * sample timestamps. Split out of Octave.c so recorded IMU traces can be
+ * replayed through the exact firmware logic on the host.
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    10 Mar 2025
+ */
+
+// INCLUDES ***************************************************************************************
+#include <string.h>
+#include <ImuGesture.h>
+
+// DEFINES ****************************************************************************************
+// (prevRate + rate) * dt_us / STEP_DIVISOR = trapezoid area in mdeg
+#define STEP_DIVISOR (2 * OCTAVE_GYRO_LSB_PER_DPS * 1000)
+
+// Leak in 64 us ticks so twist * ticks stays inside 32 bits
+#define LEAK_TICK_SHIFT 6
+#define LEAK_TAU_TICKS (OCTAVE_LEAK_TAU_US >> LEAK_TICK_SHIFT)
+
+// Physical limit of a wrist twist; also bounds the leak product
+#define TWIST_LIMIT_MDEG 180000
+
+// Quaternions with a squared norm outside [1/2, 2] (Q28) are not valid fusion
+// output yet (all zeros until the filter has started)
+#define QUAT_MIN_NORM_Q28 ((int64_t)1 << 27)
+#define QUAT_MAX_NORM_Q28 ((int64_t)1 << 29)
+
+// FUNCTIONS **************************************************************************************
+void ImuGesture_Init(ImuGesture_t *gesture, int8_t octave)
+{
+    memset(gesture, 0, sizeof(*gesture));
+    gesture->octave = octave;
+}
+
+void ImuGesture_ResetReference(ImuGesture_t *gesture)
+{
+    gesture->started = 0;
+}
+
+// Steps the octave for a gesture, at most once per OCTAVE_CHANGE_COOLDOWN_US
+static int8_t ImuGesture_Apply(ImuGesture_t *gesture, uint8_t moveRight, uint8_t moveLeft, uint32_t timestamp_us)
+{
+    if (gesture->changed && ((timestamp_us - gesture->lastChange_us) <= OCTAVE_CHANGE_COOLDOWN_US))
+    {
+        return gesture->octave;
+    }
+
+    if (moveRight && !moveLeft && (gesture->octave > OCTAVE_MIN))
+    {
+        gesture->octave--;
+    }
+    else if (moveLeft && !moveRight && (gesture->octave < OCTAVE_MAX))
+    {
+        gesture->octave++;
+    }
+    else
+    {
+        return gesture->octave;
+    }
+    gesture->changed = 1;
+    gesture->lastChange_us = timestamp_us;
+    return gesture->octave;
+}
+
+int8_t ImuGesture_UpdateRaw(ImuGesture_t *gesture, int16_t gyroX, int16_t accelX, uint32_t timestamp_us)
+{
+    int32_t rate = gyroX - OCTAVE_GYRO_BIAS_RAW;
+    if (rate > OCTAVE_GYRO_MAX_RAW)
+    {
+        rate = OCTAVE_GYRO_MAX_RAW;
+    }
+    else if (rate < -OCTAVE_GYRO_MAX_RAW)
+    {
+        rate = -OCTAVE_GYRO_MAX_RAW;
+    }
+
+    if (!gesture->started)
+    {
+        // Nothing to integrate against yet
+        gesture->started = 1;
+        gesture->prevRate = (int16_t)rate;
+        gesture->lastSample_us = timestamp_us;
+        return gesture->octave;
+    }
+
+    uint32_t dt = timestamp_us - gesture->lastSample_us;
+    gesture->lastSample_us = timestamp_us;
+    if (dt > OCTAVE_MAX_DT_US)
+    {
+        dt = OCTAVE_MAX_DT_US;
+    }
+
+    // Trapezoid rule; the remainder carries sub-mdeg steps to the next sample
+    int32_t area = (gesture->prevRate + rate) * (int32_t)dt + gesture->remainder;
+    gesture->twist_mdeg += area / STEP_DIVISOR;
+    gesture->remainder = area % STEP_DIVISOR;
+    gesture->prevRate = (int16_t)rate;
+
+    // Leak towards zero instead of subtracting a drift proportional to uptime
+    gesture->twist_mdeg -= (gesture->twist_mdeg * (int32_t)(dt >> LEAK_TICK_SHIFT)) / LEAK_TAU_TICKS;
+    if (gesture->twist_mdeg > TWIST_LIMIT_MDEG)
+    {
+        gesture->twist_mdeg = TWIST_LIMIT_MDEG;
+    }
+    else if (gesture->twist_mdeg < -TWIST_LIMIT_MDEG)
+    {
+        gesture->twist_mdeg = -TWIST_LIMIT_MDEG;
+    }
+
+    uint8_t moveRight = (gesture->twist_mdeg > OCTAVE_TWIST_MDEG) || (accelX > OCTAVE_THRESHOLD_ACCEL);
+    uint8_t moveLeft = (gesture->twist_mdeg < -OCTAVE_TWIST_MDEG) || (accelX < -OCTAVE_THRESHOLD_ACCEL);
+    return ImuGesture_Apply(gesture, moveRight, moveLeft, timestamp_us);
+}
+
+int8_t ImuGesture_UpdateFusion(ImuGesture_t *gesture, const int16_t quat[4], int16_t linAccelX,
+                               uint32_t timestamp_us)
+{
+    int32_t w = quat[0], x = quat[1], y = quat[2], z = quat[3];
+
+    // Bounding the norm also keeps the Q28 products below from overflowing
+    int64_t norm = (int64_t)w * w + x * x + y * y + z * z;
+    if ((norm < QUAT_MIN_NORM_Q28) || (norm > QUAT_MAX_NORM_Q28))
+    {
+        return gesture->octave;
+    }
+    gesture->lastSample_us = timestamp_us;
+    if (!gesture->started)
+    {
+        gesture->ref[0] = (int16_t)w;
+        gesture->ref[1] = (int16_t)x;
+        gesture->ref[2] = (int16_t)y;
+        gesture->ref[3] = (int16_t)z;
+        gesture->started = 1;
+        return gesture->octave;
+    }
+
+    // Rotation since the neutral pose, conj(ref) * q, in Q28. Its X part is
+    // sin(angle / 2) about the forearm axis, so comparing it to a fixed sine
+    // needs no trig.
+    int32_t rw = gesture->ref[0], rx = gesture->ref[1], ry = gesture->ref[2], rz = gesture->ref[3];
+    int32_t relW = rw * w + rx * x + ry * y + rz * z;
+    int32_t relX = rw * x - rx * w - ry * z + rz * y;
+    if (relW < 0)
+    {
+        relX = -relX; // q and -q are the same rotation; take the short way
+    }
+    int32_t twistLimit = (int32_t)OCTAVE_TWIST_SIN_Q14 << 14;
+
+    uint8_t moveRight = (relX > twistLimit) || (linAccelX > OCTAVE_THRESHOLD_ACCEL);
+    uint8_t moveLeft = (relX < -twistLimit) || (linAccelX < -OCTAVE_THRESHOLD_ACCEL);
+    return ImuGesture_Apply(gesture, moveRight, moveLeft, timestamp_us);
+}
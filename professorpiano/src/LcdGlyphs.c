@@ -0,0 +1,204 @@
+/**
+ * @file    LcdGlyphs.c
+ *
+ * LRU cache of piano symbols in the HD44780 CGRAM slots.
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    11 Mar 2025
+ */
+
+// INCLUDES ***************************************************************************************
+#include <string.h>
+#include <LcdGlyphs.h>
+
+// DEFINES ****************************************************************************************
+#define NO_GLYPH 0xFF
+
+// TYPEDEFS ***************************************************************************************
+typedef struct
+{
+    uint8_t glyph;                      // LcdGlyph_t in the slot, NO_GLYPH if empty
+    uint32_t lastUse;                   // useClock of the last request, for LRU
+    uint32_t flushCount;                // lcd->flushCount at the last request
+} GlyphSlot_t;
+
+// GLOBAL VARIABLES *******************************************************************************
+// 5x8 bitmaps, bit 4 is the leftmost column
+static const uint8_t GLYPH_BITMAPS[NUM_GLYPHS][LCD_GLYPH_ROWS] = {
+    [GLYPH_SHARP] = {0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A, 0x00},
+    [GLYPH_FLAT] = {0x10, 0x10, 0x16, 0x19, 0x11, 0x12, 0x1C, 0x00},
+    [GLYPH_FINGER_1] = {0x1F, 0x1B, 0x13, 0x1B, 0x1B, 0x11, 0x1F, 0x00},
+    [GLYPH_FINGER_2] = {0x1F, 0x13, 0x1D, 0x1B, 0x17, 0x11, 0x1F, 0x00},
+    [GLYPH_FINGER_3] = {0x1F, 0x13, 0x1D, 0x1B, 0x1D, 0x13, 0x1F, 0x00},
+    [GLYPH_FINGER_4] = {0x1F, 0x15, 0x15, 0x11, 0x1D, 0x1D, 0x1F, 0x00},
+    [GLYPH_FINGER_5] = {0x1F, 0x11, 0x17, 0x13, 0x1D, 0x13, 0x1F, 0x00},
+    [GLYPH_BAR_1] = {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10},
+    [GLYPH_BAR_2] = {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},
+    [GLYPH_BAR_3] = {0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C},
+    [GLYPH_BAR_4] = {0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E},
+};
+
+static DFRobot_RGBLCD_t *glyphLcd = NULL;
+static GlyphSlot_t slots[LCD_CGRAM_SLOTS];
+static uint32_t useClock = 0;
+static uint32_t hits = 0;
+static uint32_t loads = 0;
+static uint32_t fallbacks = 0;
+
+// FUNCTIONS **************************************************************************************
+void LcdGlyphs_Init(DFRobot_RGBLCD_t *lcd)
+{
+    glyphLcd = lcd;
+    for (uint8_t s = 0; s < LCD_CGRAM_SLOTS; s++)
+    {
+        slots[s].glyph = NO_GLYPH;
+        slots[s].lastUse = 0;
+        slots[s].flushCount = 0;
+    }
+    useClock = 0;
+    hits = 0;
+    loads = 0;
+    fallbacks = 0;
+}
+
+// Slots some cell wants on screen or still shows, one bit per slot
+static uint8_t LcdGlyphs_Visible(void)
+{
+    uint8_t visible = 0;
+    for (uint8_t row = 0; row < LCD_MAX_ROWS; row++)
+    {
+        for (uint8_t col = 0; col < LCD_MAX_COLS; col++)
+        {
+            uint8_t frame = glyphLcd->frame[row][col];
+            uint8_t shown = glyphLcd->shown[row][col];
+            if (frame < 2 * LCD_CGRAM_SLOTS)
+            {
+                visible |= 1u << (frame % LCD_CGRAM_SLOTS);
+            }
+            if (shown < 2 * LCD_CGRAM_SLOTS)
+            {
+                visible |= 1u << (shown % LCD_CGRAM_SLOTS);
+            }
+        }
+    }
+    return visible;
+}
+
+char LcdGlyphs_Get(LcdGlyph_t glyph, char fallback)
+{
+    if ((glyphLcd == NULL) || (glyph >= NUM_GLYPHS))
+    {
+        fallbacks++;
+        return fallback;
+    }
+    useClock++;
+
+    for (uint8_t s = 0; s < LCD_CGRAM_SLOTS; s++)
+    {
+        if (slots[s].glyph == glyph)
+        {
+            slots[s].lastUse = useClock;
+            slots[s].flushCount = glyphLcd->flushCount;
+            hits++;
+            return LCD_CGRAM_CHAR(s);
+        }
+    }
+
+    // An empty slot, else the least recently used one nobody can see. Slots
+    // handed out since the last flush are not in the framebuffer yet, but
+    // the caller is about to print them.
+    uint8_t visible = LcdGlyphs_Visible();
+    int8_t victim = -1;
+    for (uint8_t s = 0; s < LCD_CGRAM_SLOTS; s++)
+    {
+        if (slots[s].glyph == NO_GLYPH)
+        {
+            victim = s;
+            break;
+        }
+        if ((visible & (1u << s)) || (slots[s].flushCount == glyphLcd->flushCount))
+        {
+            continue;
+        }
+        if ((victim < 0) || (slots[s].lastUse < slots[victim].lastUse))
+        {
+            victim = s;
+        }
+    }
+    if (victim < 0)
+    {
+        fallbacks++;
+        return fallback;
+    }
+
+    slots[victim].glyph = glyph;
+    slots[victim].lastUse = useClock;
+    slots[victim].flushCount = glyphLcd->flushCount;
+    DFRobot_RGBLCD_LoadSymbol(glyphLcd, (uint8_t)victim, GLYPH_BITMAPS[glyph]);
+    loads++;
+    return LCD_CGRAM_CHAR(victim);
+}
+
+void LcdGlyphs_FormatNote(char *out, const char *note)
+{
+    out[0] = note[0];
+    if (note[0] == '\0')
+    {
+        return;
+    }
+    switch (note[1])
+    {
+    case '#':
+        out[1] = LcdGlyphs_Get(GLYPH_SHARP, '#');
+        out[2] = '\0';
+        break;
+    case 'b':
+        out[1] = LcdGlyphs_Get(GLYPH_FLAT, 'b');
+        out[2] = '\0';
+        break;
+    default:
+        out[1] = '\0';
+        break;
+    }
+}
+
+char LcdGlyphs_Finger(uint8_t finger)
+{
+    if ((finger < 1) || (finger > 5))
+    {
+        return '?';
+    }
+    return LcdGlyphs_Get((LcdGlyph_t)(GLYPH_FINGER_1 + finger - 1), (char)('0' + finger));
+}
+
+void LcdGlyphs_ProgressBar(char *out, uint8_t cells, uint16_t done, uint16_t total)
+{
+    uint32_t steps = (total == 0) ? 0 : ((uint32_t)done * cells * LCD_BAR_STEPS) / total;
+    if (steps > (uint32_t)cells * LCD_BAR_STEPS)
+    {
+        steps = (uint32_t)cells * LCD_BAR_STEPS;
+    }
+
+    uint8_t c = 0;
+    for (; c < steps / LCD_BAR_STEPS; c++)
+    {
+        out[c] = (char)LCD_GLYPH_FULL_BLOCK;
+    }
+    if ((steps % LCD_BAR_STEPS) != 0)
+    {
+        out[c++] = LcdGlyphs_Get((LcdGlyph_t)(GLYPH_BAR_1 + (steps % LCD_BAR_STEPS) - 1), '|');
+    }
+    for (; c < cells; c++)
+    {
+        out[c] = ' ';
+    }
+    out[cells] = '\0';
+}
+
+void LcdGlyphs_GetStats(uint32_t *hitCount, uint32_t *loadCount, uint32_t *fallbackCount)
+{
+    *hitCount = hits;
+    *loadCount = loads;
+    *fallbackCount = fallbacks;
+}
@@ -0,0 +1,74 @@
+/**
+ * @file    Lesson.c
+ *
+ * Lesson blob parsing and step checks.
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    11 Mar 2025
+ */
+
+// INCLUDES ***************************************************************************************
+#include <string.h>
+#include <Lesson.h>
+
+// DEFINES ****************************************************************************************
+#ifndef SUCCESS
+#define SUCCESS ((int8_t)1)
+#define ERROR ((int8_t)-1)
+#endif
+
+// FUNCTIONS **************************************************************************************
+int8_t Lesson_Validate(const Lesson_t *lesson)
+{
+    if ((lesson->tempo_bpm == 0) || (lesson->numSteps == 0))
+    {
+        return ERROR;
+    }
+    for (uint16_t i = 0; i < lesson->numSteps; i++)
+    {
+        const LessonStep_t *step = &lesson->steps[i];
+        if ((step->note >= LESSON_NUM_NOTES) || (step->octave > LESSON_MAX_OCTAVE) ||
+            (step->finger < B_Thumb) || (step->finger > A_Pinky) || (step->ticks == 0))
+        {
+            return ERROR;
+        }
+    }
+    return SUCCESS;
+}
+
+int8_t Lesson_FromBlob(const uint8_t *blob, uint32_t size, Lesson_t *lesson)
+{
+    const LessonBlobHeader_t *header = (const LessonBlobHeader_t *)blob;
+    if ((size < sizeof(LessonBlobHeader_t)) || (memcmp(header->magic, LESSON_MAGIC, 4) != 0))
+    {
+        return ERROR;
+    }
+    if ((size - sizeof(LessonBlobHeader_t)) / sizeof(LessonStep_t) < header->numSteps)
+    {
+        return ERROR;
+    }
+    // The name is used as a C string in place
+    if (memchr(header->name, '\0', LESSON_NAME_LENGTH) == NULL)
+    {
+        return ERROR;
+    }
+
+    Lesson_t parsed = {
+        .name = header->name,
+        .tempo_bpm = header->tempo_bpm,
+        .numSteps = header->numSteps,
+        .steps = (const LessonStep_t *)(blob + sizeof(LessonBlobHeader_t)),
+    };
+    if (Lesson_Validate(&parsed) != SUCCESS)
+    {
+        return ERROR;
+    }
+    *lesson = parsed;
+    return SUCCESS;
+}
+
+uint32_t Lesson_StepMs(const Lesson_t *lesson, const LessonStep_t *step)
+{
+    return (60000UL * step->ticks) / ((uint32_t)lesson->tempo_bpm * LESSON_TICKS_PER_BEAT);
+}
@@ -0,0 +1,170 @@
+/**
+ * @file    LessonEngine.c
+ *
+ * Guided lesson state machine, stepped by the lesson task.
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    11 Mar 2025
+ */
+
+// INCLUDES ***************************************************************************************
+#include <LessonEngine.h>
+#include <Piezo_File.h>
+#include <Board_2.h> // SUCCESS / ERROR
+#include <Display.h>
+#include <LcdGlyphs.h>
+#include <Log.h>
+#include <Trace.h>
+
+// DEFINES ****************************************************************************************
+#define KEY_MASK (LESSON_KEY_QUEUE - 1)
+
+// GLOBAL VARIABLES *******************************************************************************
+static const Lesson_t *lesson = NULL;
+static LessonState_t state = LESSON_IDLE;
+static uint16_t step = 0;
+static uint32_t stepStart_ms = 0;
+static uint32_t doneSince_ms = 0;
+static uint8_t wrongShown = 0;
+static uint32_t soundDuration = 0;          // SOUND_DURATION outside the lesson
+
+// Producer is the ADC task, consumer the lesson task; both run from the main loop
+static LessonKey_t keys[LESSON_KEY_QUEUE];
+static uint8_t keyHead = 0;
+static uint8_t keyTail = 0;
+
+// FUNCTIONS **************************************************************************************
+int8_t LessonEngine_Start(const Lesson_t *newLesson)
+{
+    if (Lesson_Validate(newLesson) != SUCCESS)
+    {
+        LOG_ERROR(LOG_LESSON, "Lesson %s is not valid\n", newLesson->name);
+        return ERROR;
+    }
+    if (state == LESSON_IDLE)
+    {
+        soundDuration = SOUND_DURATION;
+    }
+    lesson = newLesson;
+    step = 0;
+    state = LESSON_PROMPT;
+    LOG_INFO(LOG_LESSON, "Welcome to %s! %u notes at %u bpm\n", lesson->name, lesson->numSteps, lesson->tempo_bpm);
+    return SUCCESS;
+}
+
+void LessonEngine_Stop(void)
+{
+    if (state == LESSON_IDLE)
+    {
+        return;
+    }
+    state = LESSON_IDLE;
+    SOUND_DURATION = soundDuration;
+    OFF_LEDS();
+    Display_PrintLine(0, "PIANO PROFESSOR!");
+    Display_PrintLine(1, "Free play");
+}
+
+uint8_t LessonEngine_Active(void)
+{
+    return state != LESSON_IDLE;
+}
+
+void LessonEngine_PushKey(Note_t note, uint8_t octave, uint8_t finger, uint32_t time_ms)
+{
+    if ((state == LESSON_IDLE) || ((uint8_t)(keyHead - keyTail) >= LESSON_KEY_QUEUE))
+    {
+        return;
+    }
+    keys[keyHead & KEY_MASK] = (LessonKey_t){.note = note, .octave = octave, .finger = finger, .time_ms = time_ms};
+    keyHead++;
+}
+
+static void Prompt(uint32_t now_ms)
+{
+    const LessonStep_t *current = &lesson->steps[step];
+    const char *note = GetNoteString((Note_t)current->note);
+    char name[3];
+    char bar[11];
+
+    LcdGlyphs_FormatNote(name, note);
+    LcdGlyphs_ProgressBar(bar, 10, step, lesson->numSteps);
+    Display_PrintLine(0, "%s %2d/%d", bar, step, lesson->numSteps);
+    // "finger" no longer fits the 16 columns once the octave is shown
+    Display_PrintLine(1, "Play %-2s%d with %c", name, current->octave,
+                      LcdGlyphs_Finger(FINGERING[current->finger - B_Thumb]));
+    SET_FINGER_LED((Finger_t)current->finger);
+    LOG_INFO(LOG_LESSON, "Play the next note: %s%d\n", note, current->octave);
+
+    // Notes ring for their written length
+    SOUND_DURATION = Lesson_StepMs(lesson, current);
+
+    keyTail = keyHead;
+    wrongShown = 0;
+    stepStart_ms = now_ms;
+}
+
+static void Listen(uint32_t now_ms)
+{
+    const LessonStep_t *current = &lesson->steps[step];
+    while (keyTail != keyHead)
+    {
+        LessonKey_t key = keys[keyTail & KEY_MASK];
+        keyTail++;
+
+        // The right key in the wrong octave still needs a twist first
+        if ((key.note != current->note) || (key.octave != current->octave))
+        {
+            if (!wrongShown)
+            {
+                LOG_INFO(LOG_LESSON, "Wrong note! You played: %s%d, expected: %s%d\n", GetNoteString((Note_t)key.note),
+                         key.octave, GetNoteString((Note_t)current->note), current->octave);
+                wrongShown = 1;
+            }
+            continue;
+        }
+
+        TRACE(TRACE_LESSON_STEP, step, key.time_ms - stepStart_ms);
+        step++;
+        if (step < lesson->numSteps)
+        {
+            state = LESSON_PROMPT;
+            return;
+        }
+
+        LOG_INFO(LOG_LESSON, "Congratulations! You played the entire song!\n");
+        Display_PrintLine(0, "Congratulations!");
+        Display_PrintLine(1, "You finished the song!");
+        SOUND_DURATION = soundDuration;
+        doneSince_ms = now_ms;
+        state = LESSON_DONE;
+        return;
+    }
+}
+
+void LessonEngine_Service(uint32_t now_ms)
+{
+    switch (state)
+    {
+    case LESSON_PROMPT:
+        Prompt(now_ms);
+        state = LESSON_LISTEN;
+        break;
+
+    case LESSON_LISTEN:
+        Listen(now_ms);
+        break;
+
+    case LESSON_DONE:
+        if ((now_ms - doneSince_ms) >= LESSON_DONE_HOLD_MS)
+        {
+            LessonEngine_Start(lesson);
+        }
+        break;
+
+    case LESSON_IDLE:
+    default:
+        break;
+    }
+}
@@ -0,0 +1,82 @@
+/**
+ * @file    Lessons.c
+ *
+ * Built-in lesson library. Each song is a step table and one LESSONS[]
+ * entry; lesson_tool/midi2lesson.py prints both for a MIDI file.
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    11 Mar 2025
+ */
+
+// INCLUDES ***************************************************************************************
+#include <Lesson.h>
+
+// LOOKUP TABLES **********************************************************************************
+// Repeated notes are played once, so every step is a half note
+static const LessonStep_t TWINKLE_TWINKLE[] = {
+    {Note_C, 4, Thumb, 8},
+    {Note_G, 4, Pinky, 8},
+    {Note_A, 4, A_Pinky, 8},
+    {Note_G, 4, Pinky, 8},
+    {Note_F, 4, Ring, 8},
+    {Note_E, 4, Middle, 8},
+    {Note_D, 4, Index, 8},
+    {Note_C, 4, Thumb, 8},
+    {Note_G, 4, Pinky, 8},
+    {Note_F, 4, Ring, 8},
+    {Note_E, 4, Middle, 8},
+    {Note_D, 4, Index, 8},
+    {Note_G, 4, Pinky, 8},
+    {Note_F, 4, Ring, 8},
+    {Note_E, 4, Middle, 8},
+    {Note_D, 4, Index, 8},
+    {Note_C, 4, Thumb, 8},
+    {Note_G, 4, Pinky, 8},
+    {Note_A, 4, A_Pinky, 8},
+    {Note_G, 4, Pinky, 8},
+    {Note_F, 4, Ring, 8},
+    {Note_E, 4, Middle, 8},
+    {Note_D, 4, Index, 8},
+    {Note_C, 4, Thumb, 8},
+};
+
+// Every white and black key of the right hand
+static const LessonStep_t NOTE_TEST[] = {
+    {Note_C, 4, Thumb, 4},
+    {Note_D, 4, Index, 4},
+    {Note_E, 4, Middle, 4},
+    {Note_F, 4, Ring, 4},
+    {Note_G, 4, Pinky, 4},
+    {Note_Cs, 4, Thumb, 4},
+    {Note_Ds, 4, Index, 4},
+    {Note_Fs, 4, Ring, 4},
+    {Note_Gs, 4, Pinky, 4},
+};
+
+// C to G, each note three times
+static const LessonStep_t NOTE_TEST_THREES[] = {
+    {Note_C, 4, Thumb, 4},
+    {Note_C, 4, Thumb, 4},
+    {Note_C, 4, Thumb, 4},
+    {Note_D, 4, Index, 4},
+    {Note_D, 4, Index, 4},
+    {Note_D, 4, Index, 4},
+    {Note_E, 4, Middle, 4},
+    {Note_E, 4, Middle, 4},
+    {Note_E, 4, Middle, 4},
+    {Note_F, 4, Ring, 4},
+    {Note_F, 4, Ring, 4},
+    {Note_F, 4, Ring, 4},
+    {Note_G, 4, Pinky, 4},
+    {Note_G, 4, Pinky, 4},
+    {Note_G, 4, Pinky, 4},
+};
+
+const Lesson_t LESSONS[] = {
+    {"Twinkle Twinkle", 100, sizeof(TWINKLE_TWINKLE) / sizeof(LessonStep_t), TWINKLE_TWINKLE},
+    {"Note test", 80, sizeof(NOTE_TEST) / sizeof(LessonStep_t), NOTE_TEST},
+    {"Note threes", 80, sizeof(NOTE_TEST_THREES) / sizeof(LessonStep_t), NOTE_TEST_THREES},
+};
+
+const uint8_t NUM_LESSONS = sizeof(LESSONS) / sizeof(LESSONS[0]);
@@ -0,0 +1,45 @@
+/**
+ * @file    Log.c
+ *
+ * Runtime levels for the logging macros in Log.h.
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    11 Mar 2025
+ */
+
+// INCLUDES ***************************************************************************************
+#include <Log.h>
+
+// GLOBAL VARIABLES *******************************************************************************
+static const uint8_t COMPILED_LEVEL[LOG_NUM_MODULES] = {
+    [LOG_MAIN] = LOG_MAIN_LEVEL,
+    [LOG_PIEZO] = LOG_PIEZO_LEVEL,
+    [LOG_OCTAVE] = LOG_OCTAVE_LEVEL,
+    [LOG_IMU] = LOG_IMU_LEVEL,
+    [LOG_I2C] = LOG_I2C_LEVEL,
+    [LOG_LESSON] = LOG_LESSON_LEVEL,
+    [LOG_TELEPLOT] = LOG_TELEPLOT_LEVEL,
+};
+
+uint8_t logLevel[LOG_NUM_MODULES] = {
+    [LOG_MAIN] = LOG_MAIN_LEVEL,
+    [LOG_PIEZO] = LOG_PIEZO_LEVEL,
+    [LOG_OCTAVE] = LOG_OCTAVE_LEVEL,
+    [LOG_IMU] = LOG_IMU_LEVEL,
+    [LOG_I2C] = LOG_I2C_LEVEL,
+    [LOG_LESSON] = LOG_LESSON_LEVEL,
+    [LOG_TELEPLOT] = LOG_TELEPLOT_LEVEL,
+};
+
+// FUNCTIONS **************************************************************************************
+uint8_t Log_SetLevel(LogModule_t module, uint8_t level)
+{
+    if (module >= LOG_NUM_MODULES)
+    {
+        return LOG_LEVEL_NONE;
+    }
+    // Calls above the compiled level are gone, raising past it would be a lie
+    logLevel[module] = (level < COMPILED_LEVEL[module]) ? level : COMPILED_LEVEL[module];
+    return logLevel[module];
+}
@@ -2,67 +2,104 @@
 #include <stdio.h> // For printf
 #include "stm32f4xx_hal.h"
 #include <BNO055_2.h>
+#include <timers.h>
+#include <Board_2.h> // SUCCESS / ERROR
+#include <Trace.h>
+#include <Log.h>
+
+// Per-hand state; the classifier starts from all zeros
+ImuHand_t imuHands[NUM_IMU_HANDS] = {
+    {.address = BNO055_ADDRESS_A, .octave = STARTING_OCTAVE, .gesture = {.octave = STARTING_OCTAVE}},
+    {.address = BNO055_ADDRESS_B, .octave = STARTING_OCTAVE, .gesture = {.octave = STARTING_OCTAVE}},
+};
 
 // Initialize current octave
 int currentOctave = STARTING_OCTAVE;
-float angleXA = 0;
-float prevXA = 0;
-float gyroX_samples[SAMPLE_SIZE] = {0};
-float gyroX = 0;
-// Store previous readings
-int sample_index = 0;
-int lastOctaveChangeTime = 0; // Store last change timestamp
+int sustainHeld = 0;
+PlayMode_t currentMode = PLAY_MODE_FREE;
 
-// Trapezoidal filter to smooth gyro data
-float trapezoidal_average(float *samples, float new_value)
+static int octaveChanged(ImuHand_t *hand, int8_t octave)
 {
-    samples[sample_index] = new_value;
-    float avg = (samples[(sample_index - 1 + SAMPLE_SIZE) % SAMPLE_SIZE] + new_value) * 0.5;
-    sample_index = (sample_index + 1) % SAMPLE_SIZE;
-    return avg;
+    if (octave != hand->octave)
+    {
+        LOG_INFO(LOG_OCTAVE, "Hand %c Octave %s! Current Octave: %d\n", (hand == &imuHands[IMU_HAND_A]) ? 'A' : 'B',
+                 (octave > hand->octave) ? "Up" : "Down", octave);
+        TRACE(TRACE_OCTAVE, hand - imuHands, octave);
+    }
+    hand->octave = octave;
+    if (hand == &imuHands[IMU_HAND_A])
+    {
+        currentOctave = octave;
+    }
+    return hand->octave;
 }
 
 // Octave change function
 
-int updateOctave(int address)
+int updateOctave(ImuHand_t *hand)
 {
-    float rawGyroXA = (BNO055_ReadGyroX_2(address) - 18.19) / 2.98;
-    float accelX = BNO055_ReadAccelX_2(address);
-    float filteredXA = trapezoidal_average(gyroX_samples, rawGyroXA) - DRIFT_CORRECTIONX * HAL_GetTick();
-    gyroX += ((filteredXA + prevXA) * 0.5 * DT);
-    prevXA = filteredXA;
+#ifdef OCTAVE_FUSION
+    BNO055_Fusion_t fusion;
+    if (BNO055_ReadFusion_2(hand->address, &fusion) != SUCCESS)
+    {
+        return hand->octave;
+    }
+    return updateOctaveFromFusion(hand, &fusion, TIMERS_GetMicroSeconds());
+#else
+    // One burst read instead of two register-pair reads per axis
+    BNO055_Sample_t sample;
+    if (BNO055_ReadSample_2(hand->address, &sample) != SUCCESS)
+    {
+        return hand->octave;
+    }
+    return updateOctaveFromSample(hand, &sample, TIMERS_GetMicroSeconds());
+#endif // OCTAVE_FUSION
+}
 
-    uint32_t currentTime = HAL_GetTick();
-    bool moveRight = (gyroX > OCTAVE_THRESHOLD_GYRO) || (accelX > OCTAVE_THRESHOLD_ACCEL);
-    bool moveLeft = (gyroX < -OCTAVE_THRESHOLD_GYRO) || (accelX < -OCTAVE_THRESHOLD_ACCEL);
+void Octave_ResetReference(ImuHand_t *hand)
+{
+    ImuGesture_ResetReference(&hand->gesture);
+}
 
-    if (currentTime - lastOctaveChangeTime > OCTAVE_CHANGE_COOLDOWN)
-    {
-        if (moveRight && !moveLeft && currentOctave > OCTAVE_MIN)
-        {
-            currentOctave--;
-#ifdef PRINT_OCTAVE_CHANGE
-            printf("Octave Down! Current Octave: %d\n", currentOctave);
-#endif
-            lastOctaveChangeTime = currentTime;
-            return currentOctave;
-        }
-        else if (moveLeft && !moveRight && currentOctave < OCTAVE_MAX)
-        {
-            currentOctave++;
+int updateOctaveFromFusion(ImuHand_t *hand, const BNO055_Fusion_t *fusion, uint32_t timestamp_us)
+{
+    const int16_t quat[4] = {fusion->quatW, fusion->quatX, fusion->quatY, fusion->quatZ};
+    return octaveChanged(hand, ImuGesture_UpdateFusion(&hand->gesture, quat, fusion->linAccelX, timestamp_us));
+}
 
-#ifdef PRINT_OCTAVE_CHANGE
-            printf("Octave Up! Current Octave: %d\n", currentOctave);
-#endif
+int updateOctaveFromSample(ImuHand_t *hand, const BNO055_Sample_t *sample, uint32_t timestamp_us)
+{
+#ifdef GESTURE_CLASSIFIER
+    const int16_t gyro[3] = {sample->gyroX, sample->gyroY, sample->gyroZ};
+    const int16_t accel[3] = {sample->accelX, sample->accelY, sample->accelZ};
+    int octave = hand->octave;
 
-            lastOctaveChangeTime = currentTime;
-            return currentOctave;
-        }
-        // else
-        // {
-        //     currentOctave = STARTING_OCTAVE;
-        //     return currentOctave;
-        // }
+    Gesture_t gesture = GestureClassifier_Update(&hand->classifier, gyro, accel, timestamp_us);
+    if (gesture != GESTURE_NONE)
+    {
+        TRACE(TRACE_GESTURE, hand - imuHands, gesture);
     }
-    return currentOctave;
+    switch (gesture)
+    {
+    case GESTURE_OCTAVE_UP:
+        octave = (octave < OCTAVE_MAX) ? octave + 1 : octave;
+        break;
+    case GESTURE_OCTAVE_DOWN:
+        octave = (octave > OCTAVE_MIN) ? octave - 1 : octave;
+        break;
+    case GESTURE_MODE_TOGGLE:
+        currentMode = (PlayMode_t)((currentMode + 1) % NUM_PLAY_MODES);
+        LOG_INFO(LOG_OCTAVE, "Mode %d\n", currentMode);
+        break;
+    default:
+        break;
+    }
+
+    // One sustain for both hands, like a single pedal
+    hand->sustain = GestureClassifier_Sustained(&hand->classifier);
+    sustainHeld = imuHands[IMU_HAND_A].sustain || imuHands[IMU_HAND_B].sustain;
+    return octaveChanged(hand, (int8_t)octave);
+#else
+    return octaveChanged(hand, ImuGesture_UpdateRaw(&hand->gesture, sample->gyroX, sample->accelX, timestamp_us));
+#endif // GESTURE_CLASSIFIER
 }
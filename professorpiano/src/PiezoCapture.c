@@ -0,0 +1,94 @@
+/**
+ * @file    PiezoCapture.c
+ *
+ * Binary capture of raw piezo ADC frames over UART2 (DMA). Frames are
+ * collected in one half of a double buffer while the other half is being
+ * shifted out by DMA1 Stream6, so sampling never waits on the UART.
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    6 Mar 2025
+ */
+
+// INCLUDES ***************************************************************************************
+#include <stddef.h>
+#include <string.h>
+#include <PiezoCapture.h>
+#include <Board_2.h>
+#include <SerialLog.h>
+
+// GLOBAL VARIABLES *******************************************************************************
+static PiezoCaptureFrame_t captureBuffer[2][PIEZO_CAPTURE_BATCH_FRAMES];
+static uint8_t fillIndex = 0;         // Buffer currently being filled
+static uint16_t fillCount = 0;        // Frames in the fill buffer
+static uint16_t sequence = 0;
+static uint32_t droppedFrames = 0;
+
+// FUNCTIONS **************************************************************************************
+// Sum of every byte before the checksum field.
+static uint16_t PiezoCapture_Checksum(const PiezoCaptureFrame_t *frame)
+{
+    const uint8_t *bytes = (const uint8_t *)frame;
+    uint16_t sum = 0;
+    for (uint32_t i = 0; i < offsetof(PiezoCaptureFrame_t, checksum); i++)
+    {
+        sum += bytes[i];
+    }
+    return sum;
+}
+
+void PiezoCapture_Init(void)
+{
+    fillIndex = 0;
+    fillCount = 0;
+    sequence = 0;
+    droppedFrames = 0;
+
+    // Let the boot messages out before the baud rate changes under them
+    SerialLog_Flush();
+    BOARD_SetBaudrate_2(PIEZO_CAPTURE_BAUDRATE);
+}
+
+void PiezoCapture_Push(const uint16_t *adc, uint32_t timestamp_us)
+{
+    if (fillCount >= PIEZO_CAPTURE_BATCH_FRAMES)
+    {
+        // Both halves are busy, keep the sequence running so the gap is visible
+        PiezoCapture_Service();
+        if (fillCount >= PIEZO_CAPTURE_BATCH_FRAMES)
+        {
+            sequence++;
+            droppedFrames++;
+            return;
+        }
+    }
+
+    PiezoCaptureFrame_t *frame = &captureBuffer[fillIndex][fillCount];
+    frame->sync = PIEZO_CAPTURE_SYNC;
+    frame->sequence = sequence++;
+    frame->timestamp_us = timestamp_us;
+    memcpy(frame->adc, adc, sizeof(frame->adc));
+    frame->checksum = PiezoCapture_Checksum(frame);
+    fillCount++;
+}
+
+void PiezoCapture_Service(void)
+{
+    if ((fillCount == 0) || BOARD_SerialBusy_2())
+    {
+        return;
+    }
+
+    if (BOARD_SerialWriteDMA_2((const uint8_t *)captureBuffer[fillIndex],
+                               fillCount * sizeof(PiezoCaptureFrame_t)) == SUCCESS)
+    {
+        // DMA owns this half now, start filling the other one
+        fillIndex ^= 1;
+        fillCount = 0;
+    }
+}
+
+uint32_t PiezoCapture_GetDropped(void)
+{
+    return droppedFrames;
+}
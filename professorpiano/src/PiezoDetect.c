@@ -0,0 +1,116 @@
+/**
+ * @file    PiezoDetect.c
+ *
+ * HAL-free core of the piezo key-press detector. Split out of Piezo_File.c so
+ * captured ADC traces can be replayed through the exact firmware logic on the
+ * host.
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    6 Mar 2025
+ */
+
+// INCLUDES ***************************************************************************************
+#include <PiezoDetect.h>
+
+// GLOBAL VARIABLES *******************************************************************************
+// Hardcoded thresholds; Piezo_Init() overwrites them when PIEZO_CALIBRATE is used.
+// Unvalidated: they were tuned on single ADC_Read_2() samples of the old 20 ms
+// loop, not on the CIC-filtered ADC_FRAME_RATE_HZ frames the detector sees now,
+// and no labelled board capture has checked them yet (piezo_trace/traces only
+// holds synthetic ones). Recalibrate with PIEZO_CALIBRATE until one does.
+PiezoThreshold_t PiezoThresholds[PIEZO_NUM_FINGERS] =
+    {
+        /* BLACK_KEY  WHITE_KEY      FINGER */
+        [Unknown] = {0, 0},
+        [B_Thumb] = {50, 110},
+        [Thumb] = {60, 130},
+        [Index] = {50, 60},
+        [Middle] = {70, 300},
+        [Ring] = {50, 170},
+        [Pinky] = {55, 80},
+        [A_Pinky] = {55, 100}};
+
+static uint16_t lastAdcValue[PIEZO_NUM_FINGERS] = {0};
+static uint16_t maxPeak[PIEZO_NUM_FINGERS] = {0};
+static uint8_t isRising[PIEZO_NUM_FINGERS] = {0};
+static uint8_t holdoff[PIEZO_NUM_FINGERS] = {0};
+static uint32_t holdoffEnd_us[PIEZO_NUM_FINGERS] = {0};
+
+// FUNCTIONS **************************************************************************************
+void PiezoDetect_Reset(void)
+{
+    for (int i = 0; i < PIEZO_NUM_FINGERS; i++)
+    {
+        lastAdcValue[i] = 0;
+        maxPeak[i] = 0;
+        isRising[i] = 0;
+        holdoff[i] = 0;
+    }
+}
+
+uint16_t PiezoDetect_Update(uint16_t Piezo_Read, Finger_t finger, uint32_t sampleTime_us)
+{
+    // Let the ringing of the last press die out
+    if (holdoff[finger])
+    {
+        if ((int32_t)(sampleTime_us - holdoffEnd_us[finger]) < 0)
+        {
+            lastAdcValue[finger] = Piezo_Read;
+            return 0;
+        }
+        holdoff[finger] = 0;
+    }
+
+    // Noise filter
+    if (Piezo_Read < NOISE_THRESHOLD)
+    {
+        return 0;
+    }
+
+    // Check if the signal is rising or falling
+    if (Piezo_Read > lastAdcValue[finger])
+    {
+        // Signal is rising, update the peak
+        maxPeak[finger] = Piezo_Read;
+        isRising[finger] = 1;
+    }
+    // Signal is falling
+    else if (isRising[finger] && Piezo_Read < lastAdcValue[finger])
+    {
+        // Signal started dropping, finalize the peak
+        uint16_t finalPeak = maxPeak[finger];
+        maxPeak[finger] = 0;
+        isRising[finger] = 0;
+        holdoff[finger] = 1;
+        holdoffEnd_us[finger] = sampleTime_us + PIEZO_HOLDOFF_US;
+        lastAdcValue[finger] = Piezo_Read;
+        return finalPeak;
+    }
+    lastAdcValue[finger] = Piezo_Read;
+    return 0;
+}
+
+KeyType_t PiezoDetect_Classify(int PiezoPeak, Finger_t finger)
+{
+    if (finger <= Unknown || finger > A_Pinky)
+    {
+        // Invalid finger
+        return INVALID_KEY;
+    }
+
+    uint16_t blackKeyThreshold = PiezoThresholds[finger].blackKey;
+    uint16_t whiteKeyThreshold = PiezoThresholds[finger].whiteKey;
+
+    // Check if the peak corresponds to a white or black key
+    if (PiezoPeak > whiteKeyThreshold)
+    {
+        return WHITE_KEY;
+    }
+    else if ((PiezoPeak > blackKeyThreshold) && (PiezoPeak < whiteKeyThreshold))
+    {
+        return BLACK_KEY;
+    }
+    // Piezo reading is too small or invalid
+    return INVALID_KEY;
+}
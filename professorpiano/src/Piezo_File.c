@@ -37,6 +37,11 @@ Alternatively, I might just use a function for the song instead of a state machi
 #include <Octave.h>
 #include <BNO055_2.h>
 #include <DFRobot_LCD.h>
+#include <Display.h>
+#include <LcdGlyphs.h>
+#include <Trace.h>
+#include <Log.h>
+#include <LessonEngine.h>
 
 // DEFINE TESTS ***********************************************************************************
 
@@ -51,42 +56,19 @@ Alternatively, I might just use a function for the song instead of a state machi
 // volatile uint16_t adcBufferIndex = 0;           // Index for circular buffer
 volatile uint16_t PiezoPeak = 0;                                                                                         // Current peak value for peak detection or moving average
 static uint32_t lastPressTime[7] = {UINT32_MAX, UINT32_MAX, UINT32_MAX, UINT32_MAX, UINT32_MAX, UINT32_MAX, UINT32_MAX}; // Last press time for each finger
-static int validPeakDetected = 0;                                                                                        // Flag to indicate a valid peak
 
 volatile float frequency = 0.0f; // Frequency of the note being played
 
-// Global variables to store calibrated finger thresholds
+// Calibrated finger thresholds live in PiezoThresholds (PiezoDetect.c)
 #ifndef HARDCODED
-static uint16_t Calibrate_B_Thumb_BlackKey = 0;
-static uint16_t Calibrate_B_Thumb_WhiteKey = 0;
-static uint16_t Calibrate_Thumb_BlackKey = 0;
-static uint16_t Calibrate_Thumb_WhiteKey = 0;
-static uint16_t Calibrate_Index_BlackKey = 0;
-static uint16_t Calibrate_Index_WhiteKey = 0;
-static uint16_t Calibrate_Middle_BlackKey = 0;
-static uint16_t Calibrate_Middle_WhiteKey = 0;
-static uint16_t Calibrate_Ring_BlackKey = 0;
-static uint16_t Calibrate_Ring_WhiteKey = 0;
-static uint16_t Calibrate_Pinky_BlackKey = 0;
-static uint16_t Calibrate_Pinky_WhiteKey = 0;
-static uint16_t Calibrate_A_Pinky_BlackKey = 0;
-static uint16_t Calibrate_A_Pinky_WhiteKey = 0;
-#endif // HARDCODED
-#ifdef HARDCODED
-static uint16_t Calibrate_B_Thumb_BlackKey = 50;
-static uint16_t Calibrate_B_Thumb_WhiteKey = 110;
-static uint16_t Calibrate_Thumb_BlackKey = 60;
-static uint16_t Calibrate_Thumb_WhiteKey = 130;
-static uint16_t Calibrate_Index_BlackKey = 50;
-static uint16_t Calibrate_Index_WhiteKey = 60;
-static uint16_t Calibrate_Middle_BlackKey = 70;
-static uint16_t Calibrate_Middle_WhiteKey = 300;
-static uint16_t Calibrate_Ring_BlackKey = 50;
-static uint16_t Calibrate_Ring_WhiteKey = 170;
-static uint16_t Calibrate_Pinky_BlackKey = 55;
-static uint16_t Calibrate_Pinky_WhiteKey = 80;
-static uint16_t Calibrate_A_Pinky_BlackKey = 55;
-static uint16_t Calibrate_A_Pinky_WhiteKey = 100;
+static void ClearThresholds(void)
+{
+    for (int i = 0; i < PIEZO_NUM_FINGERS; i++)
+    {
+        PiezoThresholds[i].blackKey = 0;
+        PiezoThresholds[i].whiteKey = 0;
+    }
+}
 #endif // HARDCODED
 
 int isVoiceActive[MAX_VOICES] = {0};       // Array to track active voices
@@ -109,62 +91,8 @@ const Note_t NOTE_MAP[7][2] =
         {Note_A, Note_As}  /* A_Pinky */
 };
 
-const char *TWINKLETWINKLE[] =
-    {
-        "C",
-        "G",
-        "A",
-        "G",
-        "F",
-        "E",
-        "D",
-        "C",
-        "G",
-        "F",
-        "E",
-        "D",
-        "G",
-        "F",
-        "E",
-        "D",
-        "C",
-        "G",
-        "A",
-        "G",
-        "F",
-        "E",
-        "D",
-        "C"};
-
-const char *SONG_TEST[] =
-    {
-        "C",
-        "D",
-        "E",
-        "F",
-        "G",
-        "C#",
-        "D#",
-        "F#",
-        "G#"};
-
-const char *SONG_TEST2[] =
-    {
-        "C",
-        "C",
-        "C",
-        "D",
-        "D",
-        "D",
-        "E",
-        "E",
-        "E",
-        "F",
-        "F",
-        "F",
-        "G",
-        "G",
-        "G"};
+// Piano fingering (1 = thumb, 5 = pinky) of each NOTE_MAP row
+const uint8_t FINGERING[7] = {1, 1, 2, 3, 4, 5, 5};
 
 const char *GetNoteString(Note_t note)
 {
@@ -331,6 +259,39 @@ static float GetNoteFrequency(Note_t note, uint8_t octave, KeyType_t keyType)
     return NOTE_FREQUENCIES[octave][index];
 }
 
+// Feeds every decimated frame of the finger to the detector until it reports a
+// peak, sleeping between blocks; nothing else reads the blocks before the
+// scheduler starts
+static uint16_t WaitForPeak(Finger_t finger, uint32_t currentTime)
+{
+    const uint16_t *block;
+    uint32_t firstFrame;
+
+    // Frames from before the prompt would count an earlier press
+    while (ADC_GetBlock_2(&block, &firstFrame))
+    {
+    }
+
+    while (1)
+    {
+        while (!ADC_GetBlock_2(&block, &firstFrame))
+        {
+            __WFI();
+        }
+        for (int f = 0; f < ADC_BLOCK_FRAMES; f++)
+        {
+            // The scan sequence is in finger order from B_Thumb
+            uint16_t adcValue = block[(f * ADC_NUM_CHANNELS) + (finger - B_Thumb)];
+            uint32_t frameTime_us = (firstFrame + f) * ADC_FRAME_PERIOD_US;
+            uint16_t peak = PiezoMovingPeakDetector(adcValue, finger, frameTime_us, currentTime);
+            if (peak != 0)
+            {
+                return peak;
+            }
+        }
+    }
+}
+
 // Function to measure key press thresholds for a specific finger
 void MeasureKeyPressThresholds(Finger_t finger, uint16_t *blackKeyThreshold, uint16_t *whiteKeyThreshold)
 {
@@ -347,13 +308,7 @@ void MeasureKeyPressThresholds(Finger_t finger, uint16_t *blackKeyThreshold, uin
     {
         printf("Press finger %d softly...\n", finger);
 
-        uint16_t peak = 0;
-        while (peak == 0) // Wait for a valid peak
-        {
-            uint16_t adcValue = ADC_Read_2(FINGER_PIN[finger]);
-            peak = PiezoMovingPeakDetector(adcValue, finger, currentTime);
-            HAL_Delay(10); // Small delay to avoid busy-waiting
-        }
+        uint16_t peak = WaitForPeak(finger, currentTime);
 
         softPressSum += peak;
         printf("Soft press %d: %d\n", i + 1, peak);
@@ -369,13 +324,7 @@ void MeasureKeyPressThresholds(Finger_t finger, uint16_t *blackKeyThreshold, uin
     {
         printf("Press finger %d firmly...\n", finger);
 
-        uint16_t peak = 0;
-        while (peak == 0) // Wait for a valid peak
-        {
-            uint16_t adcValue = ADC_Read_2(FINGER_PIN[finger]);
-            peak = PiezoMovingPeakDetector(adcValue, finger, currentTime);
-            HAL_Delay(10); // Small delay to avoid busy-waiting
-        }
+        uint16_t peak = WaitForPeak(finger, currentTime);
 
         hardPressSum += peak;
         printf("Hard press %d: %d\n", i + 1, peak);
@@ -391,56 +340,35 @@ void MeasureKeyPressThresholds(Finger_t finger, uint16_t *blackKeyThreshold, uin
 void Piezo_Init()
 {
     HAL_Delay(1000);
+#ifndef HARDCODED
+    ClearThresholds();
+#endif // HARDCODED
 
     // Calibrate thresholds for each finger
-    MeasureKeyPressThresholds(B_Thumb, &Calibrate_B_Thumb_BlackKey, &Calibrate_B_Thumb_WhiteKey);
-    MeasureKeyPressThresholds(Thumb, &Calibrate_Thumb_BlackKey, &Calibrate_Thumb_WhiteKey);
-    MeasureKeyPressThresholds(Index, &Calibrate_Index_BlackKey, &Calibrate_Index_WhiteKey);
-    MeasureKeyPressThresholds(Middle, &Calibrate_Middle_BlackKey, &Calibrate_Middle_WhiteKey);
-    MeasureKeyPressThresholds(Ring, &Calibrate_Ring_BlackKey, &Calibrate_Ring_WhiteKey);
-    MeasureKeyPressThresholds(Pinky, &Calibrate_Pinky_BlackKey, &Calibrate_Pinky_WhiteKey);
-    MeasureKeyPressThresholds(A_Pinky, &Calibrate_A_Pinky_BlackKey, &Calibrate_A_Pinky_WhiteKey);
+    for (int finger = B_Thumb; finger <= A_Pinky; finger++)
+    {
+        MeasureKeyPressThresholds((Finger_t)finger, &PiezoThresholds[finger].blackKey, &PiezoThresholds[finger].whiteKey);
+    }
 
     printf("Calibration complete!\n");
     printf("BlackKey Thresholds: B_Thumb = %d, Thumb = %d, Index = %d, Middle = %d, Ring = %d, Pinky = %d, A_Pinky = %d\n",
-           Calibrate_B_Thumb_BlackKey, Calibrate_Index_BlackKey, Calibrate_Middle_BlackKey, Calibrate_Ring_BlackKey, Calibrate_Pinky_BlackKey, Calibrate_A_Pinky_BlackKey);
+           PiezoThresholds[B_Thumb].blackKey, PiezoThresholds[Thumb].blackKey, PiezoThresholds[Index].blackKey, PiezoThresholds[Middle].blackKey,
+           PiezoThresholds[Ring].blackKey, PiezoThresholds[Pinky].blackKey, PiezoThresholds[A_Pinky].blackKey);
     printf("WhiteKey Thresholds: B_Thumb = %d, Thumb = %d, Index = %d, Middle = %d, Ring = %d, Pinky = %d, A_Pinky = %d\n",
-           Calibrate_B_Thumb_WhiteKey, Calibrate_Thumb_WhiteKey, Calibrate_Index_WhiteKey, Calibrate_Middle_WhiteKey, Calibrate_Ring_WhiteKey, Calibrate_Pinky_WhiteKey, Calibrate_A_Pinky_WhiteKey);
+           PiezoThresholds[B_Thumb].whiteKey, PiezoThresholds[Thumb].whiteKey, PiezoThresholds[Index].whiteKey, PiezoThresholds[Middle].whiteKey,
+           PiezoThresholds[Ring].whiteKey, PiezoThresholds[Pinky].whiteKey, PiezoThresholds[A_Pinky].whiteKey);
     printf("---------------------------------------------------------------\n");
     printf("---------------------------------------------------------------\n");
 }
 #endif // PIEZO_CALIBRATE
 
-uint16_t PiezoMovingPeakDetector(uint16_t Piezo_Read, Finger_t finger, uint32_t currentTime)
+uint16_t PiezoMovingPeakDetector(uint16_t Piezo_Read, Finger_t finger, uint32_t sampleTime_us, uint32_t currentTime)
 {
-    // Use arrays to track state for each finger
-    static uint16_t lastAdcValue[7] = {0};
-    static uint16_t maxPeak[7] = {0};
-    static uint8_t isRising[7] = {0};
-    // static bool isSoundPlaying = false;
-
-    // Noise filter
-    if (Piezo_Read < NOISE_THRESHOLD)
-    {
-        return 0;
-    }
+    // Peak tracking is done by the HAL-free core in PiezoDetect.c
+    uint16_t finalPeak = PiezoDetect_Update(Piezo_Read, finger, sampleTime_us);
 
-    // Check if the signal is rising or falling
-    if (Piezo_Read > lastAdcValue[finger])
+    if (finalPeak != 0)
     {
-        // Signal is rising, update the peak
-        maxPeak[finger] = Piezo_Read;
-        isRising[finger] = 1;
-    }
-    // Signal is falling
-    else if (isRising[finger] && Piezo_Read < lastAdcValue[finger])
-    {
-        // Signal started dropping, finalize the peak
-        uint16_t finalPeak = maxPeak[finger];
-        maxPeak[finger] = 0;
-        isRising[finger] = 0;
-        lastAdcValue[finger] = Piezo_Read;
-
         // Update last press time for this finger
         lastPressTime[finger] = currentTime;
 
@@ -448,18 +376,20 @@ uint16_t PiezoMovingPeakDetector(uint16_t Piezo_Read, Finger_t finger, uint32_t
         KeyType_t keyType = WhiteOrBlackKey(finalPeak, finger);
         if ((keyType == 0) || (keyType == 1))
         {
+            TRACE(TRACE_KEY_PRESS, finger | (keyType << 8) | (NOTE_MAP[finger][keyType] << 16), finalPeak);
             const char *note = GetNoteString(NOTE_MAP[finger][keyType]);
-            if (PRINT_FLAG)
+            LOG_INFO(LOG_PIEZO, "%s Key Pressed on %d finger (Peak: %d, Note: %s)\n",
+                     keyType == WHITE_KEY ? "White" : "Black", finger, finalPeak, note);
+
+            // Lessons listen to the same presses free play sounds; while
+            // one runs the display shows its prompt instead
+            LessonEngine_PushKey(NOTE_MAP[finger][keyType], (uint8_t)currentOctave, finger, currentTime);
+            if (!LessonEngine_Active())
             {
-                printf("%s Key Pressed on %d finger (Peak: %d, Note: %s)\n",
-                       keyType == WHITE_KEY ? "White" : "Black",
-                       finger, finalPeak, note);
-
-                char textBuf[20];
-                char NOTE = *note;
-                sprintf(textBuf, "Playing note %c", NOTE);
-                DFRobot_RGBLCD_SetCursor(&myLCD, 0, 10);
-                DFRobot_RGBLCD_Print(&myLCD, textBuf);
+                // Model only; the display task puts it on the LCD
+                char name[3];
+                LcdGlyphs_FormatNote(name, note);
+                Display_PrintLine(1, "Note %-2s finger %c", name, LcdGlyphs_Finger(FINGERING[finger]));
             }
             // #ifndef SOUND
             // Get the frequency of the played note
@@ -477,11 +407,28 @@ uint16_t PiezoMovingPeakDetector(uint16_t Piezo_Read, Finger_t finger, uint32_t
                     printf("frequency: %f\n", frequency);
                 }
             */
+            // Under sustain every voice may still be ringing; reuse the oldest
+            int oldest = 0;
+            for (int i = 1; i < MAX_VOICES; i++)
+            {
+                if (STARTSOUNDTIME[i] < STARTSOUNDTIME[oldest])
+                {
+                    oldest = i;
+                }
+            }
+            if (sustainHeld && isVoiceActive[oldest])
+            {
+                TRACE(TRACE_VOICE_STOP, oldest, TIMERS_GetMilliSeconds() - STARTSOUNDTIME[oldest]);
+                stopVoice(oldest);
+                isVoiceActive[oldest] = 0;
+            }
+
             for (int i = 0; i < MAX_VOICES; i++)
             {
                 if (!isVoiceActive[i])
                 {
                     startVoice(i, frequency, 0.1f); // Start the voice with the calculated frequency
+                    TRACE(TRACE_VOICE_START, i, noteEnum | (currentOctave << 8));
                     STARTSOUNDTIME[i] = TIMERS_GetMilliSeconds();
                     voiceFrequency[i] = frequency;
                     isVoiceActive[i] = 1; // Mark this voice as active
@@ -493,14 +440,6 @@ uint16_t PiezoMovingPeakDetector(uint16_t Piezo_Read, Finger_t finger, uint32_t
         StopTheVoicesInYourHead();
         return finalPeak;
     }
-    /*
-        if ((TIMERS_GetMilliSeconds() - STARTSOUNDTIME) > SOUND_DURATION)
-        {
-            stopVoice(0); // Stop the voice if the duration is exceeded
-            // printf("STOPPING NOTE\n");
-        }
-     */
-    lastAdcValue[finger] = Piezo_Read;
     return 0;
 }
 
@@ -509,12 +448,19 @@ void StopTheVoicesInYourHead()
 {
     uint32_t currentTime = TIMERS_GetMilliSeconds();
 
+    // Sustain gesture: everything rings until the hand comes back up
+    if (sustainHeld)
+    {
+        return;
+    }
+
     for (int i = 0; i < MAX_VOICES; i++)
     {
         if (isVoiceActive[i] && (currentTime - STARTSOUNDTIME[i] > SOUND_DURATION))
         {
             stopVoice(i); // Stop the voice
             isVoiceActive[i] = 0;
+            TRACE(TRACE_VOICE_STOP, i, currentTime - STARTSOUNDTIME[i]);
             // printf("Voice %d stopped\n", i);
         }
     }
@@ -522,64 +468,7 @@ void StopTheVoicesInYourHead()
 
 int WhiteOrBlackKey(int PiezoPeak, Finger_t finger)
 {
-    // Define thresholds for each finger
-    uint16_t blackKeyThreshold = 0;
-    uint16_t whiteKeyThreshold = 0;
-
-    // Set thresholds based on the finger
-    switch (finger)
-    {
-    case B_Thumb:
-        blackKeyThreshold = Calibrate_B_Thumb_BlackKey;
-        whiteKeyThreshold = Calibrate_B_Thumb_WhiteKey;
-        break;
-    case Thumb:
-        blackKeyThreshold = Calibrate_Thumb_BlackKey;
-        whiteKeyThreshold = Calibrate_Thumb_WhiteKey;
-        break;
-    case Index:
-        blackKeyThreshold = Calibrate_Index_BlackKey;
-        whiteKeyThreshold = Calibrate_Index_WhiteKey;
-        break;
-    case Middle:
-        blackKeyThreshold = Calibrate_Middle_BlackKey;
-        whiteKeyThreshold = Calibrate_Middle_WhiteKey;
-        break;
-    case Ring:
-        blackKeyThreshold = Calibrate_Ring_BlackKey;
-        whiteKeyThreshold = Calibrate_Ring_WhiteKey;
-        break;
-    case Pinky:
-        blackKeyThreshold = Calibrate_Pinky_BlackKey;
-        whiteKeyThreshold = Calibrate_Pinky_WhiteKey;
-        break;
-    case A_Pinky:
-        blackKeyThreshold = Calibrate_A_Pinky_BlackKey;
-        whiteKeyThreshold = Calibrate_A_Pinky_WhiteKey;
-        break;
-    default:
-        // Invalid finger, return INVALID_KEY
-        validPeakDetected = 0;
-        return INVALID_KEY;
-    }
-
-    // Check if the peak corresponds to a white or black key
-    if (PiezoPeak > whiteKeyThreshold)
-    {
-        validPeakDetected = 1;
-        return WHITE_KEY;
-    }
-    else if ((PiezoPeak > blackKeyThreshold) && (PiezoPeak < whiteKeyThreshold))
-    {
-        validPeakDetected = 1;
-        return BLACK_KEY;
-    }
-    else
-    {
-        // Piezo reading is too small or invalid
-        validPeakDetected = 0;
-        return INVALID_KEY;
-    }
+    return PiezoDetect_Classify(PiezoPeak, finger);
 }
 
 void OFF_LEDS()
@@ -593,6 +482,15 @@ void OFF_LEDS()
     GPIO_WritePin_2(LED_A_PINKY_PIN, LOW);
 }
 
+void SET_FINGER_LED(Finger_t finger)
+{
+    OFF_LEDS();
+    if ((finger >= B_Thumb) && (finger <= A_Pinky))
+    {
+        GPIO_WritePin_2(LED_PIN[finger], HIGH);
+    }
+}
+
 void SET_LEDS(const char *note)
 {
     // Determine which finger corresponds to the note
@@ -616,152 +514,7 @@ void SET_LEDS(const char *note)
         }
     }
 
-    // Turn off all LEDs first
-    GPIO_WritePin_2(LED_B_THUMB_PIN, LOW);
-    GPIO_WritePin_2(LED_THUMB_PIN, LOW);
-    GPIO_WritePin_2(LED_INDEX_PIN, LOW);
-    GPIO_WritePin_2(LED_MIDDLE_PIN, LOW);
-    GPIO_WritePin_2(LED_RING_PIN, LOW);
-    GPIO_WritePin_2(LED_PINKY_PIN, LOW);
-    GPIO_WritePin_2(LED_A_PINKY_PIN, LOW);
-
-    // Set the LED for the corresponding finger
-    if (finger != Unknown)
-    {
-        switch (finger)
-        {
-        case B_Thumb:
-            OFF_LEDS();
-            GPIO_WritePin_2(LED_B_THUMB_PIN, HIGH);
-            break;
-        case Thumb:
-            OFF_LEDS();
-            GPIO_WritePin_2(LED_THUMB_PIN, HIGH);
-            break;
-        case Index:
-            OFF_LEDS();
-            GPIO_WritePin_2(LED_INDEX_PIN, HIGH);
-            break;
-        case Middle:
-            OFF_LEDS();
-            GPIO_WritePin_2(LED_MIDDLE_PIN, HIGH);
-            break;
-        case Ring:
-            OFF_LEDS();
-            GPIO_WritePin_2(LED_RING_PIN, HIGH);
-            break;
-        case Pinky:
-            OFF_LEDS();
-            GPIO_WritePin_2(LED_PINKY_PIN, HIGH);
-            break;
-        case A_Pinky:
-            OFF_LEDS();
-            GPIO_WritePin_2(LED_A_PINKY_PIN, HIGH);
-            break;
-        default:
-            // Invalid finger, do nothing
-            break;
-        }
-    }
-}
-
-int TwinkleTwinkle()
-{
-    // HAL_Delay(500);
-    HAL_Delay(100);
-    printf("Welcome to the song! Please press any note\n");
-    const int Song_Length = sizeof(TWINKLETWINKLE) / sizeof(TWINKLETWINKLE[0]);
-    // const int Song_Length = sizeof(SONG_TEST2) / sizeof(SONG_TEST2[0]);
-
-    int current_note_index = 0;
-    GPIO_WritePin_2(LED_B_THUMB_PIN, HIGH);
-    GPIO_WritePin_2(LED_THUMB_PIN, HIGH);
-    GPIO_WritePin_2(LED_INDEX_PIN, HIGH);
-    GPIO_WritePin_2(LED_MIDDLE_PIN, HIGH);
-    GPIO_WritePin_2(LED_RING_PIN, HIGH);
-    GPIO_WritePin_2(LED_PINKY_PIN, HIGH);
-    GPIO_WritePin_2(LED_A_PINKY_PIN, HIGH);
-
-    while (current_note_index < Song_Length)
-    {
-        const char *expected_note = TWINKLETWINKLE[current_note_index];
-        // const char *expected_note = SONG_TEST2[current_note_index];
-
-        printf("Play the next note: %s\n", expected_note);
-        char textBuf[20];
-        char NOTE = *expected_note;
-        sprintf(textBuf, "Play note: %c", NOTE);
-        DFRobot_RGBLCD_SetCursor(&myLCD, 0, 10);
-        DFRobot_RGBLCD_Print(&myLCD, textBuf);
-
-        SET_LEDS(expected_note); // Set the LED for the current note
-
-        // Wait for the correct note to be played
-        int correct_note_played = 0;
-        int wrong_note_debounce_flag = 0;
-
-        while (!correct_note_played)
-        {
-            uint32_t currentTime = TIMERS_GetMilliSeconds();
-            // Read all fingers
-            uint16_t Piezo_Read_Index[7] =
-                {
-                    ADC_Read_2(B_THUMB_PIN),
-                    ADC_Read_2(THUMB_PIN),
-                    ADC_Read_2(INDEX_PIN),
-                    ADC_Read_2(MIDDLE_PIN),
-                    ADC_Read_2(RING_PIN),
-                    ADC_Read_2(PINKY_PIN),
-                    ADC_Read_2(A_PINKY_PIN)};
-
-            // Process all fingers
-            for (int i = 0; i < 7; i++)
-            {
-                validPeakDetected = 0;
-                uint16_t peak = PiezoMovingPeakDetector(Piezo_Read_Index[i], (Finger_t)i, currentTime);
-                // if ((peak > NOISE_THRESHOLD) && (validPeakDetected == 1))
-                if (validPeakDetected == 1)
-                {
-                    // Check if the played note matches the expected note
-                    KeyType_t keyType = WhiteOrBlackKey(peak, (Finger_t)i);
-                    if ((keyType == 0) || (keyType == 1))
-                    {
-                        const char *played_note = GetNoteString(NOTE_MAP[i][keyType]);
-                        if (strcmp(played_note, expected_note) == 0)
-                        {
-                            correct_note_played = 1;
-                            wrong_note_debounce_flag = 0;
-                        }
-                        else
-                        {
-                            if (!wrong_note_debounce_flag)
-                            {
-                                printf("Wrong note! You played: %s, expected: %s\n", played_note, expected_note);
-                                wrong_note_debounce_flag = 1;
-                            }
-                        }
-                        // Reset valid peak flag
-                        validPeakDetected = 0;
-                    }
-                }
-            }
-            // StopTheVoicesInYourHead();
-        }
-        // StopTheVoicesInYourHead();
-        current_note_index++;
-    }
-    printf("Congratulations! You played the entire song!\n");
-
-    char textBuf[25];
-    DFRobot_RGBLCD_SetCursor(&myLCD, 0, 0);
-    sprintf(textBuf, "Congratulations!");
-    DFRobot_RGBLCD_Print(&myLCD, textBuf);
-
-    DFRobot_RGBLCD_SetCursor(&myLCD, 0, 10);
-    sprintf(textBuf, "You finished the song!");
-    DFRobot_RGBLCD_Print(&myLCD, textBuf);
-
-    return 0;
+    SET_FINGER_LED(finger);
 }
 
 #ifdef EXCLUDE_MAIN
@@ -788,24 +541,29 @@ int main(void)
         // Process all fingers
         for (int i = 1; i < 8; i++)
         {
-            uint16_t peak = PiezoMovingPeakDetector(FINGER_PIN[i], (Finger_t)i, currentTime);
+            uint16_t peak = PiezoMovingPeakDetector(FINGER_PIN[i], (Finger_t)i, currentTime * 1000, currentTime);
             // printf("Finger %d Peak: %d\n", i, peak);
         }
 #endif // PIEZO_FREEPLAY
 
-#ifdef PIEZO_TELEPLOT
-        printf(">B_Thumb:%d\n", ADC_Read_2(B_THUMB_PIN));
-        printf(">Thumb:%d\n", ADC_Read_2(THUMB_PIN));
-        printf(">Index:%d\n", ADC_Read_2(INDEX_PIN));
-        printf(">Middle:%d\n", ADC_Read_2(MIDDLE_PIN));
-        printf(">Ring:%d\n", ADC_Read_2(RING_PIN));
-        printf(">Pinky:%d\n", ADC_Read_2(PINKY_PIN));
-        printf(">A_Pinky:%d\n", ADC_Read_2(A_PINKY_PIN));
-#endif // PIEZO_TELEPLOT
-
-#if defined(SONG_TEST_SONG) || defined(TWINKLETWINKLE_SONG)
-        TwinkleTwinkle();
-#endif // SONG_TEST_SONG || TWINKLETWINKLE_SONG
+        if (LOG_ENABLED(LOG_TELEPLOT, LOG_LEVEL_DEBUG))
+        {
+            printf(">B_Thumb:%d\n", ADC_Read_2(B_THUMB_PIN));
+            printf(">Thumb:%d\n", ADC_Read_2(THUMB_PIN));
+            printf(">Index:%d\n", ADC_Read_2(INDEX_PIN));
+            printf(">Middle:%d\n", ADC_Read_2(MIDDLE_PIN));
+            printf(">Ring:%d\n", ADC_Read_2(RING_PIN));
+            printf(">Pinky:%d\n", ADC_Read_2(PINKY_PIN));
+            printf(">A_Pinky:%d\n", ADC_Read_2(A_PINKY_PIN));
+        }
+
+#ifdef LESSON_SONG
+        if (!LessonEngine_Active())
+        {
+            LessonEngine_Start(&LESSONS[LESSON_SELECTED]);
+        }
+        LessonEngine_Service(TIMERS_GetMilliSeconds());
+#endif // LESSON_SONG
 
         HAL_Delay(20);
         // i++;
@@ -0,0 +1,255 @@
+/**
+ * @file    Scheduler.c
+ *
+ * Small cooperative run-to-completion scheduler for the main loop.
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    8 Mar 2025
+ */
+
+// INCLUDES ***************************************************************************************
+#include <stdio.h>
+#include <stddef.h>
+#include <Scheduler.h>
+#include <timers.h>
+#include <Trace.h>
+
+// GLOBAL VARIABLES *******************************************************************************
+static SchedulerTask_t tasks[SCHEDULER_MAX_TASKS];
+static uint8_t numTasks = 0;
+static uint32_t statsStart_us = 0;
+
+// Sleep accounting
+static uint8_t wokeUp = 0;              // Set after a sleep until something runs
+static uint32_t sleepTime_us = 0;
+static uint32_t sleeps = 0;
+static uint32_t idleWakeups = 0;        // Woke up but nothing was ready
+
+// FUNCTIONS **************************************************************************************
+static int8_t Scheduler_Add(const char *name, SchedulerFunc_t run, uint32_t period_us, uint32_t deadline_us)
+{
+    if (numTasks >= SCHEDULER_MAX_TASKS)
+    {
+        return SCHEDULER_NO_TASK;
+    }
+
+    SchedulerTask_t *task = &tasks[numTasks];
+    task->name = name;
+    task->run = run;
+    task->period_us = period_us;
+    task->deadline_us = deadline_us;
+    task->nextRelease_us = TIMERS_GetMicroSeconds() + period_us;
+    task->pending = 0;
+    return (int8_t)numTasks++;
+}
+
+static void Scheduler_ClearStats(void)
+{
+    for (uint8_t i = 0; i < numTasks; i++)
+    {
+        tasks[i].runs = 0;
+        tasks[i].wakeups = 0;
+        tasks[i].misses = 0;
+        tasks[i].coalesced = 0;
+        tasks[i].worstLatency_us = 0;
+        tasks[i].worstRuntime_us = 0;
+        tasks[i].totalRuntime_us = 0;
+    }
+    sleepTime_us = 0;
+    sleeps = 0;
+    idleWakeups = 0;
+    statsStart_us = TIMERS_GetMicroSeconds();
+}
+
+void Scheduler_Init(void)
+{
+    numTasks = 0;
+    statsStart_us = TIMERS_GetMicroSeconds();
+}
+
+int8_t Scheduler_AddPeriodic(const char *name, SchedulerFunc_t run, uint32_t period_us, uint32_t deadline_us)
+{
+    if (period_us == 0)
+    {
+        return SCHEDULER_NO_TASK;
+    }
+    return Scheduler_Add(name, run, period_us, deadline_us);
+}
+
+int8_t Scheduler_AddEvent(const char *name, SchedulerFunc_t run, uint32_t deadline_us)
+{
+    return Scheduler_Add(name, run, 0, deadline_us);
+}
+
+void Scheduler_Signal(int8_t task)
+{
+    if ((task < 0) || (task >= numTasks))
+    {
+        return;
+    }
+    if (tasks[task].pending)
+    {
+        tasks[task].coalesced++;
+        return;
+    }
+    tasks[task].release_us = TIMERS_GetMicroSeconds();
+    tasks[task].pending = 1;
+}
+
+// Marks periodic tasks whose release time has passed as ready.
+static void Scheduler_ReleasePeriodic(uint32_t now)
+{
+    for (uint8_t i = 0; i < numTasks; i++)
+    {
+        SchedulerTask_t *task = &tasks[i];
+        if ((task->period_us == 0) || ((int32_t)(now - task->nextRelease_us) < 0))
+        {
+            continue;
+        }
+
+        if (task->pending)
+        {
+            task->coalesced++;
+        }
+        else
+        {
+            task->release_us = task->nextRelease_us;
+            task->pending = 1;
+        }
+
+        task->nextRelease_us += task->period_us;
+        if ((int32_t)(now - task->nextRelease_us) >= 0)
+        {
+            // Fell more than a period behind, skip ahead instead of bursting
+            task->coalesced += (now - task->nextRelease_us) / task->period_us + 1;
+            task->nextRelease_us = now + task->period_us;
+        }
+    }
+}
+
+uint8_t Scheduler_RunOnce(void)
+{
+    Scheduler_ReleasePeriodic(TIMERS_GetMicroSeconds());
+
+    for (uint8_t i = 0; i < numTasks; i++)
+    {
+        SchedulerTask_t *task = &tasks[i];
+        if (!task->pending)
+        {
+            continue;
+        }
+
+        // Clear first so a signal raised while running releases it again
+        task->pending = 0;
+        uint32_t release = task->release_us;
+
+        uint32_t start = TIMERS_GetMicroSeconds();
+        task->run();
+        uint32_t end = TIMERS_GetMicroSeconds();
+
+        uint32_t runtime = end - start;
+        uint32_t latency = end - release;
+        task->runs++;
+        if (wokeUp)
+        {
+            task->wakeups++;
+            wokeUp = 0;
+        }
+        task->totalRuntime_us += runtime;
+        if (runtime > task->worstRuntime_us)
+        {
+            task->worstRuntime_us = runtime;
+        }
+        if (latency > task->worstLatency_us)
+        {
+            task->worstLatency_us = latency;
+        }
+        if ((task->deadline_us != 0) && (latency > task->deadline_us))
+        {
+            task->misses++;
+            TRACE(TRACE_DEADLINE_MISS, i, latency);
+        }
+        return 1;
+    }
+
+    if (wokeUp)
+    {
+        idleWakeups++;
+        wokeUp = 0;
+    }
+    return 0;
+}
+
+static uint8_t Scheduler_AnyPending(void)
+{
+    for (uint8_t i = 0; i < numTasks; i++)
+    {
+        if (tasks[i].pending)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void Scheduler_Idle(void)
+{
+    uint32_t start = TIMERS_GetMicroSeconds();
+
+    // With interrupts masked a pending IRQ still ends WFI, it just runs after
+    // __enable_irq(), so a Scheduler_Signal() cannot slip in before the sleep.
+    __disable_irq();
+    if (Scheduler_AnyPending())
+    {
+        __enable_irq();
+        return;
+    }
+    __WFI();
+    __enable_irq();
+
+    sleepTime_us += TIMERS_GetMicroSeconds() - start;
+    sleeps++;
+    wokeUp = 1;
+}
+
+void Scheduler_Run(void)
+{
+    while (1)
+    {
+        if (!Scheduler_RunOnce())
+        {
+            Scheduler_Idle();
+        }
+    }
+}
+
+const SchedulerTask_t *Scheduler_GetTask(int8_t task)
+{
+    if ((task < 0) || (task >= numTasks))
+    {
+        return NULL;
+    }
+    return &tasks[task];
+}
+
+void Scheduler_PrintStats(void)
+{
+    uint32_t window_us = TIMERS_GetMicroSeconds() - statsStart_us;
+    printf("task        runs  wake  miss  coal  worst_lat_us  worst_run_us  load_%%\n");
+    for (uint8_t i = 0; i < numTasks; i++)
+    {
+        const SchedulerTask_t *task = &tasks[i];
+        uint32_t loadPermille = window_us ? (uint32_t)(((uint64_t)task->totalRuntime_us * 1000) / window_us) : 0;
+        printf("%-10s %5lu %5lu %5lu %5lu %13lu %13lu  %3lu.%lu\n", task->name,
+               (unsigned long)task->runs, (unsigned long)task->wakeups,
+               (unsigned long)task->misses, (unsigned long)task->coalesced,
+               (unsigned long)task->worstLatency_us, (unsigned long)task->worstRuntime_us,
+               (unsigned long)(loadPermille / 10), (unsigned long)(loadPermille % 10));
+    }
+    uint32_t sleepPermille = window_us ? (uint32_t)(((uint64_t)sleepTime_us * 1000) / window_us) : 0;
+    printf("asleep %lu.%lu%% over %lu sleeps, %lu wakeups ran nothing\n",
+           (unsigned long)(sleepPermille / 10), (unsigned long)(sleepPermille % 10),
+           (unsigned long)sleeps, (unsigned long)idleWakeups);
+    Scheduler_ClearStats();
+}
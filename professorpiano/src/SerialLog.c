@@ -0,0 +1,163 @@
+/**
+ * @file    SerialLog.c
+ *
+ * Console ring buffer drained by UART2 TX DMA.
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    11 Mar 2025
+ */
+
+// INCLUDES ***************************************************************************************
+#include <stdio.h>
+#include <string.h>
+#include <SerialLog.h>
+#include <Board_2.h>
+
+// DEFINES ****************************************************************************************
+#define LOG_MASK (SERIAL_LOG_SIZE - 1)
+
+// GLOBAL VARIABLES *******************************************************************************
+extern UART_HandleTypeDef huart2;
+
+static uint8_t logBuffer[SERIAL_LOG_SIZE];
+static volatile uint32_t head = 0;          // Free-running, only the producer writes it
+static volatile uint32_t tail = 0;          // Free-running, only the DMA completion advances it
+static volatile uint32_t inFlight = 0;      // Bytes of the transfer on the wire
+static volatile uint8_t dmaActive = 0;      // The transfer on the wire is ours
+
+static SerialLogStats_t stats;
+
+// FUNCTIONS **************************************************************************************
+// Starts a transfer of the oldest contiguous chunk if the UART is idle. Runs
+// from thread context and from the completion interrupt, so the check and
+// the start must not be split.
+static void SerialLog_Kick(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (!dmaActive && (head != tail) && !BOARD_SerialBusy_2())
+    {
+        uint32_t start = tail & LOG_MASK;
+        uint32_t count = head - tail;
+        if (count > SERIAL_LOG_SIZE - start)
+        {
+            count = SERIAL_LOG_SIZE - start;
+        }
+        if (BOARD_SerialWriteDMA_2(&logBuffer[start], (uint16_t)count) == SUCCESS)
+        {
+            inFlight = count;
+            dmaActive = 1;
+            stats.transfers++;
+        }
+    }
+    __set_PRIMASK(primask);
+}
+
+uint32_t SerialLog_Write(const uint8_t *data, uint32_t length)
+{
+    if (__get_IPSR() != 0)
+    {
+        stats.isrWrites++;
+        stats.droppedBytes += length;
+        return 0;
+    }
+
+    uint32_t used = head - tail;
+    if (length > SERIAL_LOG_SIZE - used)
+    {
+        stats.droppedWrites++;
+        stats.droppedBytes += length;
+        SerialLog_Kick();
+        return 0;
+    }
+
+    uint32_t start = head & LOG_MASK;
+    uint32_t first = SERIAL_LOG_SIZE - start;
+    if (first > length)
+    {
+        first = length;
+    }
+    memcpy(&logBuffer[start], data, first);
+    memcpy(logBuffer, data + first, length - first);
+
+    // The bytes must be in memory before the DMA can see the new head
+    __DMB();
+    head += length;
+
+    stats.written += length;
+    if (used + length > stats.highWater)
+    {
+        stats.highWater = used + length;
+    }
+    SerialLog_Kick();
+    return length;
+}
+
+uint32_t SerialLog_Space(void)
+{
+    return SERIAL_LOG_SIZE - (head - tail);
+}
+
+void SerialLog_Flush(void)
+{
+    uint32_t start = HAL_GetTick();
+    while (((head != tail) || dmaActive) && ((HAL_GetTick() - start) < SERIAL_LOG_FLUSH_TIMEOUT_MS))
+    {
+        SerialLog_Kick();
+    }
+}
+
+void SerialLog_GetStats(SerialLogStats_t *out)
+{
+    *out = stats;
+}
+
+void SerialLog_PrintStats(void)
+{
+    SerialLogStats_t s = stats;
+    printf("log: %lu B written, %lu B dropped (%lu full, %lu from ISRs), %lu B peak, %lu transfers\n",
+           (unsigned long)s.written, (unsigned long)s.droppedBytes, (unsigned long)s.droppedWrites,
+           (unsigned long)s.isrWrites, (unsigned long)s.highWater, (unsigned long)s.transfers);
+}
+
+// newlib's console hook (weak in syscalls.c); replaces the blocking
+// character-by-character __io_putchar path
+int _write(int file, char *ptr, int len)
+{
+    (void)file;
+    SerialLog_Write((const uint8_t *)ptr, (uint32_t)len);
+    return len;
+}
+
+// UART2 finished a transfer, the log's or PiezoCapture's
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    if (huart->Instance != USART2)
+    {
+        return;
+    }
+    if (dmaActive)
+    {
+        tail += inFlight;
+        dmaActive = 0;
+    }
+    SerialLog_Kick();
+}
+
+// A failed transfer is not retried; losing the chunk beats stalling the log.
+// Receive errors leave the transmitter running and are ignored here.
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+    if (huart->Instance != USART2)
+    {
+        return;
+    }
+    if (dmaActive && !BOARD_SerialBusy_2())
+    {
+        stats.droppedBytes += inFlight;
+        tail += inFlight;
+        dmaActive = 0;
+    }
+    SerialLog_Kick();
+}
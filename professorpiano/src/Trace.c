@@ -0,0 +1,83 @@
+/**
+ * @file    Trace.c
+ *
+ * Binary event trace: record ring and its drain into the console stream as
+ * hex lines.
+ *
+ * @author  Cole Schreiner
+ *
+ * @date    11 Mar 2025
+ */
+
+// INCLUDES ***************************************************************************************
+#include <Trace.h>
+#include <SerialLog.h>
+#include <timers.h>
+#include "stm32f4xx_hal.h"
+
+// DEFINES ****************************************************************************************
+#define TRACE_MASK (TRACE_RING_RECORDS - 1)
+
+// GLOBAL VARIABLES *******************************************************************************
+static TraceRecord_t ring[TRACE_RING_RECORDS];
+static volatile uint32_t head = 0;          // Free-running, advanced with interrupts masked
+static volatile uint32_t tail = 0;          // Free-running, only Trace_Service() advances it
+static uint8_t sequence = 0;
+static volatile uint32_t dropped = 0;
+static const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+// FUNCTIONS **************************************************************************************
+void Trace_Emit(uint8_t event, int32_t arg0, int32_t arg1)
+{
+    // Producers can be anywhere, so the slot is claimed and filled in one
+    // go; a record is never visible half-written
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint8_t seq = sequence++;
+    if ((head - tail) >= TRACE_RING_RECORDS)
+    {
+        dropped++;
+        __set_PRIMASK(primask);
+        return;
+    }
+    uint32_t now_us = TIMERS_GetMicroSeconds();
+    TraceRecord_t *record = &ring[head & TRACE_MASK];
+    record->sync = TRACE_SYNC;
+    record->event = event;
+    record->sequence = seq;
+    record->check = TraceRecord_Check(event, seq, now_us, arg0, arg1);
+    record->timestamp_us = now_us;
+    record->arg[0] = arg0;
+    record->arg[1] = arg1;
+    head++;
+    __set_PRIMASK(primask);
+}
+
+void Trace_Service(void)
+{
+    // Whole lines only, so a record is never split by text; what does not
+    // fit waits for the next call
+    char line[TRACE_LINE_BYTES];
+    while ((tail != head) && (SerialLog_Space() >= TRACE_LINE_BYTES))
+    {
+        const uint8_t *record = (const uint8_t *)&ring[tail & TRACE_MASK];
+        char *out = line;
+        for (const char *p = TRACE_LINE_PREFIX; *p != '\0'; p++)
+        {
+            *out++ = *p;
+        }
+        for (uint8_t i = 0; i < sizeof(TraceRecord_t); i++)
+        {
+            *out++ = HEX_DIGITS[record[i] >> 4];
+            *out++ = HEX_DIGITS[record[i] & 0x0F];
+        }
+        *out = '\n';
+        SerialLog_Write((const uint8_t *)line, TRACE_LINE_BYTES);
+        tail++;
+    }
+}
+
+uint32_t Trace_GetDropped(void)
+{
+    return dropped;
+}
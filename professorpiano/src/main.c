@@ -13,7 +13,15 @@
 #include <Piezo_File.h>
 #include <math.h>
 #include <DFRobot_LCD.h>
+#include <Display.h>
+#include <LcdGlyphs.h>
 #include <Octave.h>
+#include <PiezoCapture.h>
+#include <Scheduler.h>
+#include <SerialLog.h>
+#include <Trace.h>
+#include <Log.h>
+#include <LessonEngine.h>
 
 // PINOUTS ******************************************************************************
 // #define INDEX_PIN ADC_1 // Pin 37 - Piezo Sensor (ADC_1)
@@ -31,15 +39,313 @@
 // // #define EXCLUDE_MAIN
  // #define PIEZO
 // #define PIEZO_CALIBRATE
-// // #define PIEZO_TELEPLOT
+// // #define PIEZO_CAPTURE
+// // #define PIEZO_CAPTURE_RAW
 // // #define PIEZO_FREEPLAY
 
 // #define HARDCODED
 
 // #define SOUND
-// #define SONG_TEST_SONG
+// #define LESSON_SONG
+
+#define IMU_MOTION_INTERRUPT    // Read the IMU on BNO055 motion interrupts instead of polling
+#define IMU_DUAL_HAND           // Second BNO055 at BNO055_ADDRESS_B for the other hand, polled
+
+// #define IMU_TRACE           // Print every IMU sample with its octave decision for imu_trace/
+
+// #define SCHEDULER_REPORT    // Print per-task and per-I2C-device accounting every SCHEDULER_REPORT_MS
+
+// TASK RATES ***************************************************************************
+#define IMU_PERIOD_US           20000   // Polled sample rate (hand B, or both without IMU_MOTION_INTERRUPT)
+#define IMU_WATCHDOG_PERIOD_US  100000  // With IMU_MOTION_INTERRUPT: re-check a latched INT pin
+#define VOICES_PERIOD_US        10000
+#define LESSON_PERIOD_US        10000   // Key to next prompt within a display refresh
+#define DISPLAY_PERIOD_US       DISPLAY_REFRESH_US
+#define TELEMETRY_PERIOD_US     20000
+#define I2C_SERVICE_PERIOD_US   5000    // Bus watchdog, see I2C_Service_2()
+#define SCHEDULER_REPORT_MS     5000
+
+// ADC blocks arrive every ADC_BLOCK_FRAMES / ADC_FRAME_RATE_HZ (4 ms)
+#define ADC_BLOCK_PERIOD_US     ((ADC_BLOCK_FRAMES * 1000000UL) / ADC_FRAME_RATE_HZ)
+
+// What the IMU task reads depends on where the gestures come from
+#ifdef OCTAVE_FUSION
+typedef BNO055_Fusion_t ImuData_t;
+#define IMU_READ_ASYNC          BNO055_ReadFusionAsync_2
+#define IMU_UPDATE_OCTAVE       updateOctaveFromFusion
+#else
+typedef BNO055_Sample_t ImuData_t;
+#define IMU_READ_ASYNC          BNO055_ReadSampleAsync_2
+#define IMU_UPDATE_OCTAVE       updateOctaveFromSample
+#endif // OCTAVE_FUSION
 
 // Global Variables *********************************************************************
+static int8_t adcTask = SCHEDULER_NO_TASK;
+static int8_t octaveTask = SCHEDULER_NO_TASK;
+
+// Bus side of one hand's IMU; the gesture side is imuHands[] in Octave.c
+typedef struct
+{
+    ImuHand_t *hand;
+    I2C_Transaction_t read;
+    I2C_Transaction_t clear;
+    ImuData_t sample;                   // Filled by the I2C interrupt
+    ImuData_t latest;                   // Last complete sample
+    uint32_t latest_us;                 // When it arrived
+    volatile uint8_t fresh;             // latest not processed yet
+} ImuChannel_t;
+
+static ImuChannel_t imuChannels[NUM_IMU_HANDS];
+
+// TASKS ********************************************************************************
+#ifdef PIEZO
+// Runs from the ADC DMA interrupt
+static void AdcBlockReady(void)
+{
+    Scheduler_Signal(adcTask);
+}
+
+// Every decimated frame of a block goes through the detectors
+static void AdcProcessBlock(const uint16_t *Piezo_Block, uint32_t firstFrame)
+{
+    uint32_t currentTime = TIMERS_GetMilliSeconds();
+
+    for (int f = 0; f < ADC_BLOCK_FRAMES; f++)
+    {
+        const uint16_t *Piezo_Read_Index = &Piezo_Block[f * ADC_NUM_CHANNELS];
+        uint32_t frameTime_us = (firstFrame + f) * ADC_FRAME_PERIOD_US;
+
+#ifdef PIEZO_FREEPLAY
+        // Process all fingers
+        for (int i = 0; i < 7; i++)
+        {
+            uint16_t peak = PiezoMovingPeakDetector(Piezo_Read_Index[i], (Finger_t)i, frameTime_us, currentTime);
+            if (peak > NOISE_THRESHOLD)
+            {
+                // Check if the played note matches the expected note
+                KeyType_t keyType = WhiteOrBlackKey(peak, (Finger_t)i);
+                if ((keyType == 0) || (keyType == 1))
+                {
+                    const char *played_note = GetNoteString(NOTE_MAP[i][keyType]);
+                    // A lesson lights the finger of the next step instead
+                    if (!LessonEngine_Active())
+                    {
+                        SET_LEDS(played_note);
+                    }
+                    LOG_INFO(LOG_PIEZO, "Finger %d played note: %s\n", i, played_note);
+                }
+            }
+        }
+#else
+        (void)Piezo_Read_Index;
+        (void)frameTime_us;
+        (void)currentTime;
+#endif // PIEZO_FREEPLAY
+    }
+}
+
+// Every pending block, so a late run catches up instead of skipping blocks;
+// releases coalesce while the task is behind
+static void AdcTask(void)
+{
+    const uint16_t *Piezo_Block;
+    uint32_t firstFrame;
+    while (ADC_GetBlock_2(&Piezo_Block, &firstFrame))
+    {
+        AdcProcessBlock(Piezo_Block, firstFrame);
+    }
+}
+
+// Runs from the I2C interrupt
+static void ImuReadDone(I2C_Transaction_t *transaction)
+{
+    ImuChannel_t *channel = (ImuChannel_t *)transaction->context;
+    if (transaction->status == I2C_DONE)
+    {
+        // Copy out so the next read cannot tear the sample OctaveTask uses
+        channel->latest = channel->sample;
+        channel->latest_us = TIMERS_GetMicroSeconds();
+        channel->fresh = 1;
+        Scheduler_Signal(octaveTask);
+    }
+}
+
+// One burst read per sample; the I2C driver rejects a descriptor that is
+// still queued
+static void ImuStartRead(ImuChannel_t *channel)
+{
+    IMU_READ_ASYNC(&channel->read, channel->hand->address, &channel->sample, ImuReadDone);
+}
+
+#ifdef IMU_MOTION_INTERRUPT
+// Hand A's INT pin (EXTI) or the watchdog below: read and release the latch
+static void ImuMotion(void)
+{
+    if (!imuHands[IMU_HAND_A].present)
+    {
+        return;
+    }
+    ImuStartRead(&imuChannels[IMU_HAND_A]);
+    BNO055_ClearInterruptAsync_2(&imuChannels[IMU_HAND_A].clear, BNO055_ADDRESS_A);
+}
+#endif // IMU_MOTION_INTERRUPT
+
+// Only queues the reads; both hands' bursts go out back to back and overlap
+// the other tasks, so a second hand does not add a second wait
+static void ImuTask(void)
+{
+    for (uint8_t h = 0; h < NUM_IMU_HANDS; h++)
+    {
+        ImuChannel_t *channel = &imuChannels[h];
+        if (!channel->hand->present)
+        {
+            continue;
+        }
+#ifdef IMU_MOTION_INTERRUPT
+        if (h == IMU_HAND_A)
+        {
+            // EXTI does the work; this only catches an edge lost while the
+            // latch was being cleared, which would leave INT high forever
+            if (BNO055_InterruptPending_2())
+            {
+                ImuMotion();
+            }
+            continue;
+        }
+#endif // IMU_MOTION_INTERRUPT
+        ImuStartRead(channel);
+    }
+}
+
+static void ImuUpdate(ImuChannel_t *channel, const ImuData_t *sample, uint32_t timestamp_us)
+{
+#ifdef IMU_TRACE
+    if (channel->hand != &imuHands[IMU_HAND_A])
+    {
+        // Traces have no hand column
+        IMU_UPDATE_OCTAVE(channel->hand, sample, timestamp_us);
+        return;
+    }
+    uint32_t startCycles = DWT->CYCCNT;
+    int octave = IMU_UPDATE_OCTAVE(channel->hand, sample, timestamp_us);
+    uint32_t cycles = DWT->CYCCNT - startCycles;
+#if defined(GESTURE_CLASSIFIER)
+    // Same format as imu_trace/traces, the class column can be relabelled by hand
+    printf("G,%lu,%d,%d,%d,%d,%d,%d,%c,%lu\n", (unsigned long)timestamp_us, sample->gyroX, sample->gyroY,
+           sample->gyroZ, sample->accelX, sample->accelY, sample->accelZ,
+           GESTURE_LABELS[channel->hand->classifier.lastClass], (unsigned long)cycles);
+    (void)octave;
+#elif defined(OCTAVE_FUSION)
+    printf("F,%lu,%d,%d,%d,%d,%d,%d,%lu\n", (unsigned long)timestamp_us, sample->quatW, sample->quatX,
+           sample->quatY, sample->quatZ, sample->linAccelX, octave, (unsigned long)cycles);
+#else
+    printf("R,%lu,%d,%d,%d,%lu\n", (unsigned long)timestamp_us, sample->gyroX, sample->accelX, octave,
+           (unsigned long)cycles);
+#endif // GESTURE_CLASSIFIER
+#else
+    IMU_UPDATE_OCTAVE(channel->hand, sample, timestamp_us);
+#endif // IMU_TRACE
+}
+
+// Every hand with a new sample, in one run
+static void OctaveTask(void)
+{
+    for (uint8_t h = 0; h < NUM_IMU_HANDS; h++)
+    {
+        ImuChannel_t *channel = &imuChannels[h];
+        ImuData_t sample;
+        uint32_t timestamp_us;
+
+        __disable_irq();
+        uint8_t fresh = channel->fresh;
+        sample = channel->latest;
+        timestamp_us = channel->latest_us;
+        channel->fresh = 0;
+        __enable_irq();
+
+        if (fresh)
+        {
+            ImuUpdate(channel, &sample, timestamp_us);
+        }
+    }
+}
+
+static void I2CServiceTask(void)
+{
+    I2C_Service_2();
+}
+
+static void VoicesTask(void)
+{
+    StopTheVoicesInYourHead();
+}
+
+static void DisplayTask(void)
+{
+    Display_Service();
+}
+
+// The mode gesture (GESTURE_CLASSIFIER) switches between free play and the
+// guided lesson
+static void LessonTask(void)
+{
+    uint8_t guided = (currentMode == PLAY_MODE_GUIDED);
+    if (guided && !LessonEngine_Active())
+    {
+        if (LessonEngine_Start(&LESSONS[LESSON_SELECTED]) != SUCCESS)
+        {
+            currentMode = PLAY_MODE_FREE;
+        }
+    }
+    else if (!guided && LessonEngine_Active())
+    {
+        LessonEngine_Stop();
+    }
+    LessonEngine_Service(TIMERS_GetMilliSeconds());
+}
+
+static void TelemetryTask(void)
+{
+    Trace_Service();
+
+    if (LOG_ENABLED(LOG_TELEPLOT, LOG_LEVEL_DEBUG))
+    {
+        printf(">B_Thumb:%d\n", ADC_Read_2(B_THUMB_PIN));
+        printf(">Thumb:%d\n", ADC_Read_2(THUMB_PIN));
+        printf(">Index:%d\n", ADC_Read_2(INDEX_PIN));
+        printf(">Middle:%d\n", ADC_Read_2(MIDDLE_PIN));
+        printf(">Ring:%d\n", ADC_Read_2(RING_PIN));
+        printf(">Pinky:%d\n", ADC_Read_2(PINKY_PIN));
+        printf(">A_Pinky:%d\n", ADC_Read_2(A_PINKY_PIN));
+    }
+
+#ifdef SCHEDULER_REPORT
+    static uint32_t lastReport = 0;
+    if ((TIMERS_GetMilliSeconds() - lastReport) >= SCHEDULER_REPORT_MS)
+    {
+        lastReport = TIMERS_GetMilliSeconds();
+        Scheduler_PrintStats();
+        I2C_PrintStats_2();
+        SerialLog_PrintStats();
+#ifdef PIEZO
+        printf("adc dropped blocks %lu\n", (unsigned long)ADC_GetDroppedBlocks_2());
+#endif // PIEZO
+    }
+#endif // SCHEDULER_REPORT
+}
+
+// A task that did not fit would just never run; stop at boot instead
+static int8_t RequireTask(int8_t task)
+{
+    if (task == SCHEDULER_NO_TASK)
+    {
+        LOG_ERROR(LOG_MAIN, "Scheduler full, raise SCHEDULER_MAX_TASKS\n");
+        SerialLog_Flush();
+        Error_Handler_3();
+    }
+    return task;
+}
+#endif // PIEZO
 
 // **************************************************************************************
 
@@ -51,18 +357,40 @@ int main(void)
     ADC_Init_2();
     TIMER_Init();
     I2S_Init();
-    BNO055_Init_2(BNO055_ADDRESS_A);
-    // BNO055_Init_2(BNO055_ADDRESS_B);
+    for (uint8_t h = 0; h < NUM_IMU_HANDS; h++)
+    {
+        ImuHand_t *hand = &imuHands[h];
+        imuChannels[h].hand = hand;
+        imuChannels[h].read.context = &imuChannels[h];
+#ifndef IMU_DUAL_HAND
+        if (h != IMU_HAND_A)
+        {
+            continue;
+        }
+#endif // IMU_DUAL_HAND
+        hand->present = (BNO055_Init_2(hand->address) == SUCCESS);
+#ifdef OCTAVE_FUSION
+        // The raw paths read AMG samples and keep the mode of init
+        if (hand->present)
+        {
+            BNO055_EnableFusion_2(hand->address);
+        }
+#endif // OCTAVE_FUSION
+    }
     InitSineTable();
     if (HAL_I2S_Transmit_DMA(&hi2s1, (uint16_t *)i2sTxBuffer, AUDIO_BUFFER_SIZE) != HAL_OK)
     {
         Error_Handler_3();
     }
     DFRobot_RGBLCD_Init(&myLCD, 16, 2, LCD_ADDRESS, RGB_ADDRESS);
+    LcdGlyphs_Init(&myLCD);
     DFRobot_RGBLCD_Clear(&myLCD);
     DFRobot_RGBLCD_SetCursor(&myLCD, 0, 0);
     DFRobot_RGBLCD_Print(&myLCD, "PIANO PROFESSOR!");
     DFRobot_RGBLCD_SetColor(&myLCD, BLUE);
+    // Every device on I2C2 is configured now; try 400 kHz for all of them
+    unsigned long i2cSpeed = I2C_ProbeFastMode_2();
+    LOG_INFO(LOG_MAIN, "I2C2 running at %lu Hz\n", i2cSpeed);
     OFF_LEDS();
 
 #ifdef I2S_TEST
@@ -114,9 +442,11 @@ int main(void)
 #ifdef OCTAVE_TEST
     while (TRUE)
     {
-        updateOctave(BNO055_ADDRESS_A);
+        updateOctave(&imuHands[IMU_HAND_A]);
         printf("Octave: %d\n", currentOctave);
-        // updateOctave(BNO055_ADDRESS_B);
+#ifdef IMU_DUAL_HAND
+        printf("Octave B: %d\n", updateOctave(&imuHands[IMU_HAND_B]));
+#endif // IMU_DUAL_HAND
     }
 
 #endif // OCTAVE_TEST
@@ -126,71 +456,81 @@ int main(void)
     Piezo_Init();
 #endif // PIEZO_CALIBRATE
 
+#ifdef PIEZO_CAPTURE
+    // Stream raw frames for piezo_trace/ instead of running the detectors
+    PiezoCapture_Init();
+#ifdef PIEZO_CAPTURE_RAW
+    // Undecimated scans for piezo_trace/decimate_bench; the UART cannot keep up
+    // with ADC_SCAN_RATE_HZ, so the capture comes out as bursts of whole blocks
+#define CAPTURE_GET_BLOCK   ADC_GetRawBlock_2
+#define CAPTURE_BLOCK       ADC_BLOCK_SCANS
+#define CAPTURE_RATE_HZ     ADC_SCAN_RATE_HZ
+#else
+#define CAPTURE_GET_BLOCK   ADC_GetBlock_2
+#define CAPTURE_BLOCK       ADC_BLOCK_FRAMES
+#define CAPTURE_RATE_HZ     ADC_FRAME_RATE_HZ
+#endif // PIEZO_CAPTURE_RAW
     while (1)
     {
-
-#ifdef PIEZO_FREEPLAY
-
-        uint32_t currentTime = TIMERS_GetMilliSeconds();
-
-        uint16_t Piezo_Read_Index[7] =
-            {
-                ADC_Read_2(B_THUMB_PIN),
-                ADC_Read_2(THUMB_PIN),
-                ADC_Read_2(INDEX_PIN),
-                ADC_Read_2(MIDDLE_PIN),
-                ADC_Read_2(RING_PIN),
-                ADC_Read_2(PINKY_PIN),
-                ADC_Read_2(A_PINKY_PIN)};
-
-        updateOctave(BNO055_ADDRESS_A);
-        // printf("Octave: %d\n", currentOctave);
-
-        // Process all fingers
-        for (int i = 0; i < 7; i++)
+        // The scan sequence is in finger order, so DMA frames go out as-is
+        const uint16_t *Piezo_Block;
+        uint32_t firstFrame;
+        if (CAPTURE_GET_BLOCK(&Piezo_Block, &firstFrame))
         {
-            uint16_t peak = PiezoMovingPeakDetector(Piezo_Read_Index[i], (Finger_t)i, currentTime);
-            if (peak > NOISE_THRESHOLD)
-            // if (validPeakDetected == 1)
+            for (uint32_t f = 0; f < CAPTURE_BLOCK; f++)
             {
-                // Check if the played note matches the expected note
-                KeyType_t keyType = WhiteOrBlackKey(peak, (Finger_t)i);
-                if ((keyType == 0) || (keyType == 1))
-                {
-                    const char *played_note = GetNoteString(NOTE_MAP[i][keyType]);
-                    SET_LEDS(played_note);
-                    printf("Finger %d played note: %s\n", i, played_note);
-                }
+                uint32_t captureTime = ((firstFrame + f) * 1000000ULL) / CAPTURE_RATE_HZ;
+                PiezoCapture_Push(&Piezo_Block[f * ADC_NUM_CHANNELS], captureTime);
             }
         }
-        /*
-            if ((TIMERS_GetMilliSeconds() - STARTSOUNDTIME) > SOUND_DURATION)
-            {
-                stopVoice(0); // Stop the voice if the duration is exceeded
-                // printf("STOPPING NOTE\n");
-            }
-        */
-#endif // PIEZO_FREEPLAY
-
-#ifdef PIEZO_TELEPLOT
-        printf(">B_Thumb:%d\n", ADC_Read_2(B_THUMB_PIN));
-        printf(">Thumb:%d\n", ADC_Read_2(THUMB_PIN));
-        printf(">Index:%d\n", ADC_Read_2(INDEX_PIN));
-        printf(">Middle:%d\n", ADC_Read_2(MIDDLE_PIN));
-        printf(">Ring:%d\n", ADC_Read_2(RING_PIN));
-        printf(">Pinky:%d\n", ADC_Read_2(PINKY_PIN));
-        printf(">A_Pinky:%d\n", ADC_Read_2(A_PINKY_PIN));
-#endif // PIEZO_TELEPLOT
-
-#if defined(SONG_TEST_SONG) || defined(TWINKLETWINKLE_SONG)
-        TwinkleTwinkle();
-#endif // SONG_TEST_SONG || TWINKLETWINKLE_SONG
+        PiezoCapture_Service();
+    }
+#endif // PIEZO_CAPTURE
 
-        StopTheVoicesInYourHead();
+#ifdef LESSON_SONG
+    // Boot into the lesson; with GESTURE_CLASSIFIER the mode gesture still
+    // switches to free play
+    currentMode = PLAY_MODE_GUIDED;
+#endif // LESSON_SONG
 
-        HAL_Delay(20);
-        // i++;
+    // Registration order is priority order
+    Scheduler_Init();
+    adcTask = RequireTask(Scheduler_AddEvent("adc", AdcTask, ADC_BLOCK_PERIOD_US));
+    octaveTask = RequireTask(Scheduler_AddEvent("octave", OctaveTask, IMU_PERIOD_US));
+#ifdef IMU_TRACE
+    // Cycle counter for the per-update cost in the trace
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif // IMU_TRACE
+#ifdef IMU_MOTION_INTERRUPT
+    // Hand B has no INT line and sets the pace when it is there
+    if (imuHands[IMU_HAND_B].present)
+    {
+        RequireTask(Scheduler_AddPeriodic("imu", ImuTask, IMU_PERIOD_US, IMU_PERIOD_US));
     }
+    else
+    {
+        RequireTask(Scheduler_AddPeriodic("imu", ImuTask, IMU_WATCHDOG_PERIOD_US, 0));
+    }
+    // A missing hand A would leave the INT line floating into the EXTI
+    if (imuHands[IMU_HAND_A].present)
+    {
+        BNO055_EnableMotionInterrupt_2(BNO055_ADDRESS_A, BNO055_ACC_AM_THRESHOLD, BNO055_GYR_AM_THRESHOLD);
+        BNO055_InitInterruptPin_2(ImuMotion);
+    }
+#else
+    RequireTask(Scheduler_AddPeriodic("imu", ImuTask, IMU_PERIOD_US, IMU_PERIOD_US));
+#endif // IMU_MOTION_INTERRUPT
+    RequireTask(Scheduler_AddPeriodic("i2c", I2CServiceTask, I2C_SERVICE_PERIOD_US, I2C_SERVICE_PERIOD_US));
+    RequireTask(Scheduler_AddPeriodic("voices", VoicesTask, VOICES_PERIOD_US, VOICES_PERIOD_US));
+    RequireTask(Scheduler_AddPeriodic("lesson", LessonTask, LESSON_PERIOD_US, LESSON_PERIOD_US));
+    RequireTask(Scheduler_AddPeriodic("display", DisplayTask, DISPLAY_PERIOD_US, DISPLAY_PERIOD_US));
+    RequireTask(Scheduler_AddPeriodic("telemetry", TelemetryTask, TELEMETRY_PERIOD_US, TELEMETRY_PERIOD_US));
+    ADC_SetBlockCallback_2(AdcBlockReady);
+
+    TRACE(TRACE_BOOT, TRACE_RING_RECORDS, sizeof(TraceRecord_t));
+    Scheduler_Run();
 #endif // PIEZO
 }
 #endif // EXCLUDE_MAIN
\ No newline at end of file